@@ -0,0 +1,266 @@
+#include "bvh.hh"
+
+#include "parallel.hh"
+
+#include <atomic>
+#include <cmath>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+
+namespace cherry_blazer {
+
+namespace {
+
+constexpr std::size_t bin_count = 16;
+constexpr std::uint32_t max_leaf_size = 4;
+// Subtrees of fewer objects are built on the thread which reached them.
+constexpr std::uint32_t parallel_threshold = 4096;
+// From this depth on, nodes are split in the middle instead of by the surface area heuristic. This
+// bounds the depth to about max_sah_depth + log2(object count), which the traversal stack needs.
+constexpr unsigned max_sah_depth = 48;
+// Bounds and centres are computed in chunks of this many objects.
+constexpr std::size_t grain = 4096;
+
+using Centre = std::array<double, 3>;
+
+void grow(Aabb& box, Aabb const& other) noexcept {
+    for (std::size_t axis = 0; axis < 3; ++axis) {
+        box.min[axis] = std::min(box.min[axis], other.min[axis]);
+        box.max[axis] = std::max(box.max[axis], other.max[axis]);
+    }
+}
+
+void grow(Aabb& box, Centre const& point) noexcept {
+    for (std::size_t axis = 0; axis < 3; ++axis) {
+        box.min[axis] = std::min(box.min[axis], point[axis]);
+        box.max[axis] = std::max(box.max[axis], point[axis]);
+    }
+}
+
+// Half the surface area, which is all the heuristic needs. 0 for an empty box.
+double half_area(Aabb const& box) noexcept {
+    if (box.min[0] > box.max[0])
+        return 0.;
+    auto const x = box.max[0] - box.min[0];
+    auto const y = box.max[1] - box.min[1];
+    auto const z = box.max[2] - box.min[2];
+    return x * y + y * z + z * x;
+}
+
+class Builder {
+  public:
+    Builder(std::span<Aabb const> boxes, std::span<Centre const> centres,
+            std::span<std::uint32_t> objects, std::span<detail::BvhNode> nodes)
+        : boxes_{boxes}, centres_{centres}, objects_{objects}, nodes_{nodes} {
+        // Enough parallel levels for a couple of subtrees per thread.
+        while ((std::size_t{1} << parallel_depth_) < 2 * std::size_t{worker_count()})
+            ++parallel_depth_;
+    }
+
+    // Number of nodes used.
+    std::uint32_t build() {
+        build(0, 0, static_cast<std::uint32_t>(objects_.size()), 0);
+        return node_count_.load();
+    }
+
+  private:
+    std::span<Aabb const> boxes_;
+    std::span<Centre const> centres_;
+    std::span<std::uint32_t> objects_;
+    std::span<detail::BvhNode> nodes_;
+    // The root is node 0, children are allocated in pairs after it.
+    std::atomic<std::uint32_t> node_count_{1};
+    unsigned parallel_depth_{0};
+
+    void build(std::uint32_t node, std::uint32_t begin, std::uint32_t end, unsigned depth) {
+        Aabb box;
+        Aabb centre_box;
+        for (auto i = begin; i < end; ++i) {
+            grow(box, boxes_[objects_[i]]);
+            grow(centre_box, centres_[objects_[i]]);
+        }
+        nodes_[node] = {box, begin, end - begin};
+        if (end - begin <= max_leaf_size)
+            return;
+
+        auto const middle = split(begin, end, centre_box, depth);
+
+        auto const left = node_count_.fetch_add(2, std::memory_order_relaxed);
+        nodes_[node].first = left;
+        nodes_[node].count = 0;
+
+        if (end - begin >= parallel_threshold && depth < parallel_depth_) {
+            parallel_invoke([&] { build(left, begin, middle, depth + 1); },
+                            [&] { build(left + 1, middle, end, depth + 1); });
+        } else {
+            build(left, begin, middle, depth + 1);
+            build(left + 1, middle, end, depth + 1);
+        }
+    }
+
+    // Reorders objects_[begin;end) so that the two halves of the split are [begin;middle) and
+    // [middle;end), both non-empty, and returns middle.
+    std::uint32_t split(std::uint32_t begin, std::uint32_t end, Aabb const& centre_box,
+                        unsigned depth) {
+        auto const first = objects_.begin() + begin;
+        auto const last = objects_.begin() + end;
+
+        if (depth < max_sah_depth) {
+            if (auto const best = best_split(begin, end, centre_box)) {
+                auto const [axis, bin] = *best;
+                auto const middle = std::partition(first, last, [&](std::uint32_t object) {
+                    return bin_of(centres_[object][axis], centre_box, axis) <= bin;
+                });
+                if (middle != first && middle != last)
+                    return static_cast<std::uint32_t>(middle - objects_.begin());
+            }
+        }
+
+        // In the middle of the widest axis. Also for objects with the same centre, which no bins
+        // can tell apart.
+        std::size_t axis = 0;
+        for (std::size_t a = 1; a < 3; ++a) {
+            if (centre_box.max[a] - centre_box.min[a] > centre_box.max[axis] - centre_box.min[axis])
+                axis = a;
+        }
+        auto const middle = begin + (end - begin) / 2;
+        std::nth_element(first, objects_.begin() + middle, last,
+                         [&](std::uint32_t lhs, std::uint32_t rhs) {
+                             return centres_[lhs][axis] < centres_[rhs][axis];
+                         });
+        return middle;
+    }
+
+    [[nodiscard]] static std::size_t bin_of(double centre, Aabb const& centre_box,
+                                            std::size_t axis) noexcept {
+        auto const extent = centre_box.max[axis] - centre_box.min[axis];
+        auto const bin = static_cast<std::size_t>((centre - centre_box.min[axis]) / extent *
+                                                  static_cast<double>(bin_count));
+        return std::min(bin, bin_count - 1);
+    }
+
+    // Axis and last bin of the left half of the cheapest split, if any axis can be split.
+    [[nodiscard]] std::optional<std::pair<std::size_t, std::size_t>>
+    best_split(std::uint32_t begin, std::uint32_t end, Aabb const& centre_box) const {
+        std::optional<std::pair<std::size_t, std::size_t>> best;
+        auto best_cost = std::numeric_limits<double>::infinity();
+
+        for (std::size_t axis = 0; axis < 3; ++axis) {
+            if (!(centre_box.max[axis] > centre_box.min[axis]))
+                continue;
+
+            std::array<Aabb, bin_count> bin_boxes;
+            std::array<std::uint32_t, bin_count> bin_counts{};
+            for (auto i = begin; i < end; ++i) {
+                auto const object = objects_[i];
+                auto const bin = bin_of(centres_[object][axis], centre_box, axis);
+                grow(bin_boxes[bin], boxes_[object]);
+                ++bin_counts[bin];
+            }
+
+            // Cost of the right halves, from the right.
+            std::array<double, bin_count> right_costs{};
+            Aabb right_box;
+            std::uint32_t right_count = 0;
+            for (auto bin = bin_count - 1; bin > 0; --bin) {
+                grow(right_box, bin_boxes[bin]);
+                right_count += bin_counts[bin];
+                right_costs[bin - 1] = right_count * half_area(right_box);
+            }
+
+            Aabb left_box;
+            std::uint32_t left_count = 0;
+            for (std::size_t bin = 0; bin + 1 < bin_count; ++bin) {
+                grow(left_box, bin_boxes[bin]);
+                left_count += bin_counts[bin];
+                auto const cost = left_count * half_area(left_box) + right_costs[bin];
+                if (left_count != 0 && left_count != end - begin && cost < best_cost) {
+                    best_cost = cost;
+                    best = {axis, bin};
+                }
+            }
+        }
+        return best;
+    }
+};
+
+} // namespace
+
+Aabb bounds(Sphere const& sphere) noexcept {
+    // The unit sphere goes through mat's upper 3x3 part and is moved by its last column. Along each
+    // axis, the extent of the result is the length of the corresponding row of that 3x3 part.
+    auto const& mat = sphere.transformation.mat;
+    Aabb box;
+    for (std::size_t row = 0; row < 3; ++row) {
+        auto const extent = std::sqrt(mat(row, 0) * mat(row, 0) + mat(row, 1) * mat(row, 1) +
+                                      mat(row, 2) * mat(row, 2));
+        box.min[row] = mat(row, 3) - extent;
+        box.max[row] = mat(row, 3) + extent;
+    }
+    return box;
+}
+
+Aabb bounds(Aabb const& box, Mat4d const& transform) noexcept {
+    if (box.min[0] > box.max[0])
+        return box; // empty
+    // The centre goes through the transform, and each axis of the result gets the absolute
+    // contributions of the half extents along all the axes (J. Arvo, Graphics Gems, 1990).
+    Aabb result;
+    for (std::size_t row = 0; row < 3; ++row) {
+        auto centre = transform(row, 3);
+        auto extent = 0.;
+        for (std::size_t col = 0; col < 3; ++col) {
+            centre += transform(row, col) * (box.min[col] + box.max[col]) * .5;
+            extent += std::abs(transform(row, col)) * (box.max[col] - box.min[col]) * .5;
+        }
+        result.min[row] = centre - extent;
+        result.max[row] = centre + extent;
+    }
+    return result;
+}
+
+namespace {
+
+std::vector<Aabb> bounds_of(std::span<Sphere const> objects) {
+    std::vector<Aabb> boxes(objects.size());
+    parallel_for(objects.size(), grain, [&](std::size_t begin, std::size_t end) {
+        for (auto i = begin; i < end; ++i)
+            boxes[i] = bounds(objects[i]);
+    });
+    return boxes;
+}
+
+} // namespace
+
+Bvh::Bvh(std::span<Sphere const> objects) : Bvh{std::span<Aabb const>{bounds_of(objects)}} {}
+
+Bvh::Bvh(std::span<Aabb const> boxes) {
+    if (boxes.empty())
+        return;
+    if (boxes.size() > std::numeric_limits<std::uint32_t>::max() / 2)
+        throw std::logic_error{"Bvh: too many objects"};
+
+    std::vector<Centre> centres(boxes.size());
+    std::vector<std::uint32_t> object_order(boxes.size());
+    parallel_for(boxes.size(), grain, [&](std::size_t begin, std::size_t end) {
+        for (auto i = begin; i < end; ++i) {
+            for (std::size_t axis = 0; axis < 3; ++axis)
+                centres[i][axis] = (boxes[i].min[axis] + boxes[i].max[axis]) * .5;
+            object_order[i] = static_cast<std::uint32_t>(i);
+        }
+    });
+
+    // A binary tree with non-empty leaves has at most 2n - 1 nodes.
+    std::vector<detail::BvhNode> nodes(2 * boxes.size() - 1);
+    Builder builder{boxes, centres, object_order, nodes};
+    nodes.resize(builder.build());
+
+    nodes_ = detail::OwnedOrViewed{std::move(nodes)};
+    objects_ = detail::OwnedOrViewed{std::move(object_order)};
+}
+
+Bvh::Bvh(std::span<detail::BvhNode> nodes, std::span<std::uint32_t> object_order)
+    : nodes_{nodes}, objects_{object_order} {}
+
+} // namespace cherry_blazer
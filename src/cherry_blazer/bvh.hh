@@ -0,0 +1,169 @@
+#pragma once
+
+#include "detail/owned_or_viewed.hh"
+#include "ray.hh"
+#include "sphere.hh"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace cherry_blazer {
+
+// Axis-aligned bounding box. The default one is empty: it contains nothing, not even a point.
+struct Aabb {
+    std::array<double, 3> min{std::numeric_limits<double>::infinity(),
+                              std::numeric_limits<double>::infinity(),
+                              std::numeric_limits<double>::infinity()};
+    std::array<double, 3> max{-std::numeric_limits<double>::infinity(),
+                              -std::numeric_limits<double>::infinity(),
+                              -std::numeric_limits<double>::infinity()};
+};
+
+// Smallest box around the transformed sphere.
+[[nodiscard]] Aabb bounds(Sphere const& sphere) noexcept;
+
+// Smallest box around the box after an affine transform.
+[[nodiscard]] Aabb bounds(Aabb const& box, Mat4d const& transform) noexcept;
+
+namespace detail {
+
+struct BvhNode {
+    Aabb box;
+    // Inner nodes: index of the left child, the right one follows it. Leaves: index of the first
+    // object in the Bvh's object order.
+    std::uint32_t first;
+    // Number of objects of a leaf, 0 for inner nodes.
+    std::uint32_t count;
+};
+
+// Ray parameter at which the ray enters the box, if it does so in [0;max_t]; infinity otherwise.
+[[nodiscard]] inline double box_entry(Aabb const& box, std::array<double, 3> const& origin,
+                                      std::array<double, 3> const& inverse_direction,
+                                      double max_t) noexcept {
+    auto enter = 0.;
+    auto leave = max_t;
+    for (std::size_t axis = 0; axis < 3; ++axis) {
+        auto near = (box.min[axis] - origin[axis]) * inverse_direction[axis];
+        auto far = (box.max[axis] - origin[axis]) * inverse_direction[axis];
+        if (inverse_direction[axis] < 0.)
+            std::swap(near, far);
+        // A ray in the plane of a face gives 0 * infinity = NaN, which std::max/min ignore here.
+        enter = std::max(enter, near);
+        leave = std::min(leave, far);
+    }
+    return enter <= leave ? enter : std::numeric_limits<double>::infinity();
+}
+
+} // namespace detail
+
+// Bounding volume hierarchy over spheres, or anything else with bounding boxes, so that a ray only
+// tests the objects whose boxes it goes through. Built top-down: each node's objects are split
+// where the surface area heuristic, evaluated over 16 bins of the object centres, estimates the
+// cheapest traversal. The bounds are computed and the subtrees built in parallel (see
+// parallel_for()).
+class Bvh {
+  public:
+    Bvh() = default;
+    // Refers to the objects by index: it stays valid as long as their transformations don't change.
+    // Throws std::logic_error if there are more objects than 32-bit indices can address.
+    explicit Bvh(std::span<Sphere const> objects);
+    // Over objects with the given boxes, e.g. instances (see World).
+    explicit Bvh(std::span<Aabb const> boxes);
+    // Refers to a Bvh stored elsewhere, e.g. in a SceneFile, as given by nodes() and
+    // object_order() of the original. The memory must outlive this Bvh and its copies.
+    Bvh(std::span<detail::BvhNode> nodes, std::span<std::uint32_t> object_order);
+
+    // Levels of inner nodes traverse() can go through: its stack holds one far child per level.
+    // The build stays well below it; a stored Bvh must be checked against it (see SceneFile).
+    static constexpr std::size_t max_depth = 96;
+
+    [[nodiscard]] std::size_t node_count() const noexcept { return nodes_.span().size(); }
+
+    // Box around all the objects.
+    [[nodiscard]] Aabb root_bounds() const noexcept {
+        return nodes_.span().empty() ? Aabb{} : nodes_.span()[0].box;
+    }
+
+    // The representation, for storing the Bvh: the nodes, root first, and the objects of the
+    // leaves, which refer to consecutive runs of object_order().
+    [[nodiscard]] std::span<detail::BvhNode const> nodes() const noexcept { return nodes_.span(); }
+    [[nodiscard]] std::span<std::uint32_t const> object_order() const noexcept {
+        return objects_.span();
+    }
+
+    // Calls intersect(object, max_t) for the objects (indices into the spheres or boxes the Bvh
+    // was built from) whose box the ray goes through within [0;max_t], nearer boxes first.
+    // intersect may lower max_t, e.g. to the nearest hit found so far, to skip all the boxes
+    // beyond it, and returns true to stop the traversal.
+    template <typename Intersect>
+    void traverse(Ray const& ray, double max_t, Intersect const& intersect) const;
+
+  private:
+    detail::OwnedOrViewed<detail::BvhNode> nodes_;
+    detail::OwnedOrViewed<std::uint32_t> objects_;
+};
+
+template <typename Intersect>
+void Bvh::traverse(Ray const& ray, double max_t, Intersect const& intersect) const {
+    auto const nodes = nodes_.span();
+    auto const objects = objects_.span();
+    if (nodes.empty())
+        return;
+
+    std::array<double, 3> const origin{ray.origin[0], ray.origin[1], ray.origin[2]};
+    // Division by 0 gives infinity, which is what the slab test needs.
+    std::array<double, 3> const inverse_direction{1. / ray.direction[0], 1. / ray.direction[1],
+                                                  1. / ray.direction[2]};
+    constexpr auto miss = std::numeric_limits<double>::infinity();
+
+    if (detail::box_entry(nodes[0].box, origin, inverse_direction, max_t) == miss)
+        return;
+
+    // Far children to come back to, with their entry parameter, at most one per level.
+    std::array<std::pair<std::uint32_t, double>, max_depth> stack; // NOLINT(*-member-init)
+    std::size_t stack_size = 0;
+    std::uint32_t node = 0;
+    for (;;) {
+        auto const& current = nodes[node];
+        if (current.count != 0) {
+            for (auto i = current.first; i < current.first + current.count; ++i) {
+                if (intersect(objects[i], max_t))
+                    return;
+            }
+        } else {
+            auto near = current.first;
+            auto far = current.first + 1;
+            auto near_t = detail::box_entry(nodes[near].box, origin, inverse_direction, max_t);
+            auto far_t = detail::box_entry(nodes[far].box, origin, inverse_direction, max_t);
+            if (far_t < near_t) {
+                std::swap(near, far);
+                std::swap(near_t, far_t);
+            }
+            if (near_t != miss) {
+                if (far_t != miss)
+                    stack[stack_size++] = {far, far_t};
+                node = near;
+                continue;
+            }
+        }
+
+        // Pop the next far child, unless intersect has lowered max_t below its entry since.
+        for (;;) {
+            if (stack_size == 0)
+                return;
+            auto const [next, entry] = stack[--stack_size];
+            if (entry <= max_t) {
+                node = next;
+                break;
+            }
+        }
+    }
+}
+
+} // namespace cherry_blazer
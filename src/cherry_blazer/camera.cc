@@ -0,0 +1,99 @@
+#include "camera.hh"
+
+#include "matrix_operations.hh"
+#include "point_operations.hh"
+#include "vector_operations.hh"
+
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <numbers>
+#include <stdexcept>
+
+namespace cherry_blazer {
+
+Mat4d view_transform(Point3d const& from, Point3d const& to, Vec3d const& up) {
+    auto const forward = normalize(to - from);
+    auto const left = cross(forward, normalize(up));
+    auto const true_up = cross(left, forward);
+
+    Mat4d const orientation{{left[0], left[1], left[2], 0.},
+                            {true_up[0], true_up[1], true_up[2], 0.},
+                            {-forward[0], -forward[1], -forward[2], 0.},
+                            {0., 0., 0., 1.}};
+    return orientation * Mat4d::translation(Vec3d{-from[0], -from[1], -from[2]});
+}
+
+Camera::Camera(unsigned hsize, unsigned vsize, double field_of_view, Mat4d const& transform)
+    : hsize_{hsize}, vsize_{vsize}, field_of_view_{field_of_view}, transform_{transform},
+      pixel_size_{}, half_width_{}, half_height_{} {
+    if (hsize == 0 || vsize == 0)
+        throw std::logic_error{"Camera: image must not be empty"};
+    if (!(field_of_view > 0. && field_of_view < std::numbers::pi))
+        throw std::logic_error{"Camera: field of view must be in (0;pi)"};
+
+    // Half of the image plane along its longer side, the shorter side follows the aspect ratio.
+    auto const half_view = std::tan(field_of_view / 2.);
+    auto const aspect = double(hsize) / double(vsize);
+    half_width_ = aspect >= 1. ? half_view : half_view * aspect;
+    half_height_ = aspect >= 1. ? half_view / aspect : half_view;
+    pixel_size_ = half_width_ * 2. / double(hsize);
+
+    // Camera space looks along -Z, with +X to the left, so the image's X grows towards -X.
+    auto const inv = inverse(transform); // throws if not invertible
+    origin_ = inv * Point3d{0., 0., 0.};
+    top_left_ =
+        inv * Point3d{half_width_ - pixel_size_ / 2., half_height_ - pixel_size_ / 2., -1.};
+    right_ = inv * Vec3d{-pixel_size_, 0., 0.};
+    down_ = inv * Vec3d{0., -pixel_size_, 0.};
+}
+
+unsigned Camera::hsize() const { return hsize_; }
+
+unsigned Camera::vsize() const { return vsize_; }
+
+double Camera::field_of_view() const { return field_of_view_; }
+
+Mat4d const& Camera::transform() const { return transform_; }
+
+double Camera::pixel_size() const { return pixel_size_; }
+
+Ray Camera::ray_for_pixel(unsigned x, unsigned y) const { return ray_for_pixel(x, y, 0., 0.); }
+
+Ray Camera::ray_for_pixel(unsigned x, unsigned y, double offset_x, double offset_y) const {
+    auto const pixel = top_left_ + right_ * (double(x) + offset_x) + down_ * (double(y) + offset_y);
+    return {origin_, normalize(pixel - origin_)};
+}
+
+ImagePlane Camera::image_plane() const { return {origin_, top_left_, right_, down_}; }
+
+std::optional<Point2d> Camera::project(Point3d const& point) const {
+    auto const in_camera = transform_ * point;
+    auto const depth = -in_camera[2];
+    if (depth <= std::numeric_limits<double>::epsilon())
+        return std::nullopt;
+
+    // onto the image plane at depth 1, then from there to pixels (see the constructor)
+    auto const u = in_camera[0] / depth;
+    auto const v = in_camera[1] / depth;
+    return Point2d{(half_width_ - u) / pixel_size_ - .5, (half_height_ - v) / pixel_size_ - .5};
+}
+
+void Camera::rays_for_tile(Tile const& tile, std::span<Ray> out) const {
+    if (tile.x + tile.width > hsize_ || tile.y + tile.height > vsize_)
+        throw std::logic_error{"Camera: tile exceeds the image"};
+    if (out.size() < std::size_t{tile.width} * tile.height)
+        throw std::logic_error{"Camera: not enough room for the rays of the tile"};
+
+    auto ray = out.begin();
+    for (auto row{0U}; row < tile.height; ++row) {
+        auto direction =
+            top_left_ + right_ * double(tile.x) + down_ * double(tile.y + row) - origin_;
+        for (auto column{0U}; column < tile.width; ++column) {
+            *ray++ = {origin_, direction};
+            direction += right_;
+        }
+    }
+}
+
+} // namespace cherry_blazer
@@ -0,0 +1,83 @@
+#pragma once
+
+#include "point.hh"
+#include "ray.hh"
+#include "square_matrix.hh"
+#include "tile.hh"
+#include "vector.hh"
+
+#include <optional>
+#include <span>
+
+namespace cherry_blazer {
+
+// Orients the world relative to an eye at from, looking towards to, with up pointing (roughly)
+// upwards.
+Mat4d view_transform(Point3d const& from, Point3d const& to, Vec3d const& up);
+
+// What Camera builds the rays of pixels from: the ray of pixel (x, y) starts at eye and goes
+// through top_left + right * x + down * y, the center of the pixel.
+struct ImagePlane {
+    Point3d eye;
+    Point3d top_left;
+    Vec3d right;
+    Vec3d down;
+};
+
+// Camera maps the pixels of an hsize x vsize image to rays. In camera space, the eye is at the
+// origin and looks along -Z at an image plane one unit away, field_of_view wide (in radians)
+// along the longer side of the image. transform (see view_transform()) places the camera in the
+// world.
+//
+// Everything which does not depend on the pixel is computed on construction: the eye in world
+// space, the world space center of the top left pixel, and the world space steps to the next pixel
+// in a row and to the next row. So a ray costs a few additions, not a matrix multiplication.
+class Camera {
+  public:
+    // Throws std::logic_error if the image is empty, field_of_view is not in (0;pi), or transform
+    // is not invertible.
+    Camera(unsigned hsize, unsigned vsize, double field_of_view,
+           Mat4d const& transform = Mat4d::identity());
+
+    [[nodiscard]] unsigned hsize() const;
+    [[nodiscard]] unsigned vsize() const;
+    [[nodiscard]] double field_of_view() const;
+    [[nodiscard]] Mat4d const& transform() const;
+    // Size of a pixel on the image plane.
+    [[nodiscard]] double pixel_size() const;
+
+    // Ray from the eye through the center of pixel (x, y), with a normalized direction.
+    [[nodiscard]] Ray ray_for_pixel(unsigned x, unsigned y) const;
+    // Same, but through a point offset from the center, in pixels (so +-.5 are the pixel edges).
+    [[nodiscard]] Ray ray_for_pixel(unsigned x, unsigned y, double offset_x,
+                                    double offset_y) const;
+
+    // Rays through all the pixels of tile, row by row, into out. The directions are built by
+    // repeated additions along each row and are NOT normalized (they end on the image plane), so
+    // the t of a hit is not a distance; normalize where unit length matters, e.g. for the eye
+    // vector. Throws std::logic_error if tile does not fit the image or out is too small.
+    void rays_for_tile(Tile const& tile, std::span<Ray> out) const;
+
+    // The geometry ray_for_pixel() builds rays from.
+    [[nodiscard]] ImagePlane image_plane() const;
+
+    // Where a world point appears on the image, in pixels: pixel (x, y) is centered at (x, y).
+    // Nothing for points not in front of the eye. Points outside the image are projected too.
+    [[nodiscard]] std::optional<Point2d> project(Point3d const& point) const;
+
+  private:
+    unsigned hsize_;
+    unsigned vsize_;
+    double field_of_view_;
+    Mat4d transform_;
+    double pixel_size_;
+    double half_width_;
+    double half_height_;
+
+    Point3d origin_;
+    Point3d top_left_;
+    Vec3d right_;
+    Vec3d down_;
+};
+
+} // namespace cherry_blazer
@@ -5,7 +5,6 @@
 #include "util.hh"
 
 #include <boost/assert.hpp>
-#include <boost/pfr/core.hpp>
 
 #include <algorithm>
 #include <cassert>
@@ -14,8 +13,11 @@
 #include <cstdint>
 #include <exception>
 #include <fstream>
+#include <initializer_list>
 #include <iomanip>
+#include <ostream>
 #include <sstream>
+#include <stdexcept>
 #include <string>
 #include <utility>
 
@@ -31,6 +33,56 @@ constexpr double scale(double value, Point2d const& source_range, Point2d const&
                       Point2d{source_range[1], target_range[1]});
 }
 
+// PPM layout. Every color component is printed in a fixed width, so each color occupies the same
+// amount of text, and its position in the text follows from its position in the canvas.
+
+// Max length of line in PPM file.
+constexpr auto ppm_line_length = 70;
+// How much text space one color component (r, g, or b) occupies?
+constexpr auto component_width = 4;
+// How many primary colors does one color have?
+constexpr auto component_count = 3;
+// How much text space one color (r, g, and b) occupies?
+constexpr auto color_width = component_width * component_count;
+// How many colors fully fit into one line?
+constexpr auto batch_size = ppm_line_length / color_width;
+
+// Range of canvas color components' values.
+constexpr Point component_range{0.0, 1.0};
+// Range of PPM color values.
+constexpr Point ppm_range{0.0, 255.0};
+
+void write_ppm_color(std::ostream& os, Color const& color) {
+    for (auto const component : {color.r, color.g, color.b}) {
+        // Clamp color components to the source range, then scale them to the target range.
+        auto const clamped = std::clamp(component, component_range[0], component_range[1]);
+        auto const scaled = scale(clamped, component_range, ppm_range);
+        auto const rounded = std::round(scaled);
+        os << std::setw(component_width) << rounded;
+    }
+}
+
+std::string ppm_header(std::size_t width, std::size_t height) {
+    return ppm::generate_header(width, height, std::size_t(std::round(ppm_range[1])));
+}
+
+// Whether two regions overlap or share an edge or corner.
+bool touching(Tile const& lhs, Tile const& rhs) {
+    return lhs.x <= rhs.x + rhs.width && rhs.x <= lhs.x + lhs.width &&
+           lhs.y <= rhs.y + rhs.height && rhs.y <= lhs.y + lhs.height;
+}
+
+Tile bounding(Tile const& lhs, Tile const& rhs) {
+    auto const left = std::min(lhs.x, rhs.x);
+    auto const top = std::min(lhs.y, rhs.y);
+    auto const right = std::max(lhs.x + lhs.width, rhs.x + rhs.width);
+    auto const bottom = std::max(lhs.y + lhs.height, rhs.y + rhs.height);
+    return {left, top, right - left, bottom - top};
+}
+
+// More regions than this are merged into one.
+constexpr std::size_t max_dirty_regions = 16;
+
 } // namespace
 
 Canvas::Canvas(std::size_t width, std::size_t height) {
@@ -73,6 +125,21 @@ Color& Canvas::operator()(double x, double y) {
     return this->operator()(std::size_t(std::round(x)), std::size_t(std::round(y)));
 }
 
+void Canvas::set(std::size_t x, std::size_t y, Color const& color) {
+    this->operator()(x, y) = color;
+    mark_dirty({unsigned(x), unsigned(y), 1, 1});
+}
+
+void Canvas::set(unsigned x, unsigned y, Color const& color) {
+    set(std::size_t(x), std::size_t(y), color);
+}
+
+void Canvas::set(int x, int y, Color const& color) { set(std::size_t(x), std::size_t(y), color); }
+
+void Canvas::set(double x, double y, Color const& color) {
+    set(std::size_t(std::round(x)), std::size_t(std::round(y)), color);
+}
+
 Color const& Canvas::operator()(std::size_t x, std::size_t y) const {
     BOOST_VERIFY(x < width_);
     BOOST_VERIFY(y < height_);
@@ -93,56 +160,74 @@ Color const& Canvas::operator()(double x, double y) const {
 
 std::size_t Canvas::size() const { return width_ * height_; }
 
-void Canvas::fill(Color const& color) { std::fill(canvas_.get(), canvas_.get() + size(), color); }
+void Canvas::fill(Color const& color) {
+    std::fill(canvas_.get(), canvas_.get() + size(), color);
+    dirty_.assign(1, {0, 0, width(), height()});
+}
+
+std::span<Tile const> Canvas::dirty() const { return dirty_; }
+
+void Canvas::mark_dirty(Tile const& region) {
+    // Most writes continue the last region (e.g. the next pixel in a row), so try it first.
+    for (auto it = dirty_.rbegin(); it != dirty_.rend(); ++it) {
+        if (touching(*it, region)) {
+            *it = bounding(*it, region);
+            return;
+        }
+    }
+
+    if (dirty_.size() == max_dirty_regions) {
+        auto merged = region;
+        for (auto const& dirty : dirty_)
+            merged = bounding(merged, dirty);
+        dirty_.assign(1, merged);
+        return;
+    }
+
+    dirty_.push_back(region);
+}
+
+void Canvas::clear_dirty() { dirty_.clear(); }
+
+void Canvas::update_ppm(std::string& ppm) const {
+    auto const header_size = ppm_header(width_, height_).size();
+    // every full batch of colors, and the leftover one, takes a line
+    auto const lines = (size() + batch_size - 1) / batch_size;
+    if (ppm.size() != header_size + size() * color_width + lines)
+        throw std::logic_error{"Canvas: PPM does not match the canvas size."};
+
+    std::stringstream ss;
+    for (auto const& region : dirty_) {
+        for (auto y{region.y}; y < region.y + region.height; ++y) {
+            for (auto x{region.x}; x < region.x + region.width; ++x) {
+                auto const i = y * width_ + x;
+                ss.str({});
+                write_ppm_color(ss, canvas_[i]);
+                auto const offset = header_size + i * color_width + i / batch_size;
+                ppm.replace(offset, color_width, ss.str());
+            }
+        }
+    }
+}
 
 std::string Canvas::as_ppm() const {
-    // Max length of line in PPM file.
-    constexpr auto ppm_line_length = 70;
-    // How much text space one color component (r, g, or b) occupies?
-    constexpr auto component_width = 4;
-    // How many primary colors does one color have?
-    constexpr auto component_count = 3;
-    // How much text space one color (r, g, and b) occupies?
-    constexpr auto color_width = component_width * component_count;
-    // How many colors fully fit into one line?
-    constexpr auto batch_size = ppm_line_length / color_width;
     // How many full batches of colors are there to print?
     const auto batch_count = size() / batch_size;
 
-    // Range of canvas color components' values.
-    constexpr Point component_range{0.0, 1.0};
-    // Range of PPM color values.
-    constexpr Point ppm_range{0.0, 255.0};
-
     std::stringstream ss;
-    ss << ppm::generate_header(width_, height_, std::size_t(std::round(ppm_range[1])));
+    ss << ppm_header(width_, height_);
 
     // Print out batch_count batches of batch_size amount of colors each, one batch per line.
     for (auto nth_batch{0U}; nth_batch < batch_count; ++nth_batch) {
-        for (auto nth_color{0U}; nth_color < batch_size; ++nth_color) {
-            // Clamp color components to the source range, then scale them to the target range.
-            boost::pfr::for_each_field(
-                canvas_[nth_batch * batch_size + nth_color], [&](auto const& component) {
-                    auto const clamped =
-                        std::clamp(component, component_range[0], component_range[1]);
-                    auto const scaled = scale(clamped, component_range, ppm_range);
-                    auto const rounded = std::round(scaled);
-                    ss << std::setw(component_width) << rounded;
-                });
-        }
+        for (auto nth_color{0U}; nth_color < batch_size; ++nth_color)
+            write_ppm_color(ss, canvas_[nth_batch * batch_size + nth_color]);
         ss << "\n";
     }
 
     if ((size() - batch_count * batch_size) != 0) { // Any colors remaining to be processed?
         auto already_processed = batch_count * batch_size;
-        for (auto leftover{already_processed}; leftover < size(); ++leftover) {
-            boost::pfr::for_each_field(canvas_[leftover], [&](auto const& component) {
-                auto const clamped = std::clamp(component, component_range[0], component_range[1]);
-                auto const scaled = scale(clamped, component_range, ppm_range);
-                auto const rounded = std::round(scaled);
-                ss << std::setw(component_width) << rounded;
-            });
-        }
+        for (auto leftover{already_processed}; leftover < size(); ++leftover)
+            write_ppm_color(ss, canvas_[leftover]);
         ss << "\n";
     }
 
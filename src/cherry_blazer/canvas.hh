@@ -1,16 +1,24 @@
 #pragma once
 
 #include "color.hh"
+#include "tile.hh"
 
 #include <fstream>
 #include <memory>
+#include <span>
 #include <string>
+#include <vector>
 
 namespace cherry_blazer {
 
 // Canvas is a 2D buffer to write colors into, either one color at a time via "canvas(x, y) =
 // color" or one color in bulk via fill(). Canvas coordinate system: X grows from left to right,
 // Y grows from up to down.
+//
+// Canvas keeps track of the regions written to since the last clear_dirty(), so that consumers can
+// process only what changed between two frames. Writes through set() and fill() are tracked;
+// writes through the non-const accessors are not, so that renderers can write pixels from several
+// threads without bookkeeping per pixel, and mark what they wrote with mark_dirty() once.
 class Canvas {
   public:
     Canvas(std::size_t width, std::size_t height);
@@ -31,11 +39,29 @@ class Canvas {
     Color& operator()(int x, int y);
     Color& operator()(double x, double y);
 
+    // Write one color and mark its pixel dirty.
+    void set(std::size_t x, std::size_t y, Color const& color);
+    void set(unsigned x, unsigned y, Color const& color);
+    void set(int x, int y, Color const& color);
+    void set(double x, double y, Color const& color);
+
     // Fill whole canvas with a single color.
     void fill(Color const& color);
 
     [[nodiscard]] std::string as_ppm() const;
 
+    // Regions written to since the last clear_dirty(). They may overlap. Writes which touch an
+    // existing region grow it; past a handful of regions, they are merged into one.
+    [[nodiscard]] std::span<Tile const> dirty() const;
+    // Records a region as written to, e.g. after writing its pixels through operator().
+    void mark_dirty(Tile const& region);
+    void clear_dirty();
+
+    // Re-encode only the dirty regions into ppm, which must come from as_ppm() of a canvas of the
+    // same size. Costs time proportional to the dirty area, not to the canvas. Throws
+    // std::logic_error if ppm does not have the size as_ppm() would produce.
+    void update_ppm(std::string& ppm) const;
+
     friend bool operator==(Canvas const& lhs, Canvas const& rhs);
     friend bool operator!=(Canvas const& lhs, Canvas const& rhs);
 
@@ -45,6 +71,7 @@ class Canvas {
     std::unique_ptr<Color[]> canvas_; // 2D, but in 1D array
     std::size_t width_;
     std::size_t height_;
+    std::vector<Tile> dirty_;
 
     [[nodiscard]] std::size_t size() const;
 };
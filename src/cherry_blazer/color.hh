@@ -1,49 +1,221 @@
 #pragma once
 
+#include "detail/detail.hh"
+
 #include <ostream>
+#include <type_traits>
+#include <utility>
 
 namespace cherry_blazer {
 
-struct Color {
+// Color is laid out as one 4-lane SIMD register: r, g, b, and an always-zero padding lane. All the
+// arithmetic works on the whole register at once (see detail::simd4d below), while r, g and b stay
+// plain members, so "c.r" and "Color{r, g, b}" work as before.
+struct alignas(32) Color {
     double r;
     double g;
     double b;
+    double pad{0.}; // NOLINT(misc-non-private-member-variables-in-classes)
+};
+
+namespace detail {
+
+// GCC/Clang vector extension. Without AVX it is lowered to two SSE registers.
+using simd4d = double __attribute__((vector_size(4 * sizeof(double))));
+
+static_assert(sizeof(Color) == sizeof(simd4d) && alignof(Color) % alignof(simd4d) == 0);
+
+// simd4d is never passed or returned by value, but through references: without AVX, GCC warns that
+// by-value 256-bit vectors change the calling convention (-Wpsabi).
+
+// std::bit_cast is not available in libc++ 12, but the builtin is, in both GCC and Clang.
+inline void load(Color const& c, simd4d& out) noexcept { out = __builtin_bit_cast(simd4d, c); }
+
+[[nodiscard]] inline Color store(simd4d& v) noexcept {
+    // Scalar lanes can hold anything in the padding lane (e.g. 0/0 after division), so reset it.
+    v[3] = 0.;
+    return __builtin_bit_cast(Color, v);
+}
+
+struct Add {
+    static void apply(simd4d const& lhs, simd4d const& rhs, simd4d& out) noexcept {
+        out = lhs + rhs;
+    }
+};
+
+struct Subtract {
+    static void apply(simd4d const& lhs, simd4d const& rhs, simd4d& out) noexcept {
+        out = lhs - rhs;
+    }
+};
+
+struct Multiply {
+    static void apply(simd4d const& lhs, simd4d const& rhs, simd4d& out) noexcept {
+        out = lhs * rhs;
+    }
+};
+
+struct Divide {
+    static void apply(simd4d const& lhs, simd4d const& rhs, simd4d& out) noexcept {
+        out = lhs / rhs;
+    }
+};
+
+// Color arithmetic is lazy: every operator returns a lightweight expression node instead of a
+// Color. Nothing is computed until the expression is converted to a Color, at which point the whole
+// tree is evaluated register-wide in one pass. So "a + b * c + d" does not materialize the
+// intermediate Colors.
+
+struct ColorExpressionTag {};
+
+template <typename T>
+inline constexpr bool is_color_expression_v =
+    std::is_base_of_v<ColorExpressionTag, std::remove_cvref_t<T>>;
+
+template <typename T>
+inline constexpr bool is_color_operand_v =
+    std::is_same_v<std::remove_cvref_t<T>, Color> || is_color_expression_v<T>;
+
+// Named Colors (lvalues) are captured by reference. Temporaries and sub-expressions are captured by
+// value, so that an expression never refers to an object which died at the end of the full
+// expression that created it.
+template <typename T>
+using color_operand_t =
+    std::conditional_t<std::is_lvalue_reference_v<T> &&
+                           std::is_same_v<std::remove_cvref_t<T>, Color>,
+                       Color const&, std::remove_cvref_t<T>>;
+
+template <typename Operand> inline void evaluate(Operand const& operand, simd4d& out) noexcept {
+    if constexpr (std::is_arithmetic_v<Operand>)
+        out = simd4d{} + static_cast<double>(operand); // broadcast
+    else if constexpr (std::is_same_v<Operand, Color>)
+        load(operand, out);
+    else
+        operand.evaluate(out);
+}
+
+template <typename Operation, typename Lhs, typename Rhs>
+struct ColorExpression : ColorExpressionTag {
+    Lhs lhs;
+    Rhs rhs;
+
+    void evaluate(simd4d& out) const noexcept {
+        simd4d lhs_value;
+        simd4d rhs_value;
+        detail::evaluate(lhs, lhs_value);
+        detail::evaluate(rhs, rhs_value);
+        Operation::apply(lhs_value, rhs_value, out);
+    }
+
+    // Evaluate the whole expression tree.
+    // NOLINTNEXTLINE(google-explicit-constructor)
+    operator Color() const noexcept {
+        simd4d result;
+        evaluate(result);
+        return store(result);
+    }
 };
 
+template <typename Operation, typename Lhs, typename Rhs>
+[[nodiscard]] constexpr auto make_color_expression(Lhs&& lhs, Rhs&& rhs) noexcept {
+    return ColorExpression<Operation, color_operand_t<Lhs&&>, color_operand_t<Rhs&&>>{
+        {}, std::forward<Lhs>(lhs), std::forward<Rhs>(rhs)};
+}
+
+template <typename Lhs, typename Rhs>
+using enable_if_colors_t =
+    std::enable_if_t<is_color_operand_v<Lhs> && is_color_operand_v<Rhs>, bool>;
+
+template <typename T> using enable_if_color_t = std::enable_if_t<is_color_operand_v<T>, bool>;
+
+} // namespace detail
+
 // Color*scalar
-Color operator*(Color const& c, double scalar);
+template <typename C, detail::enable_if_color_t<C> = true>
+[[nodiscard]] constexpr auto operator*(C&& c, double scalar) noexcept {
+    return detail::make_color_expression<detail::Multiply>(std::forward<C>(c), scalar);
+}
 
 // scalar*Color
-Color operator*(double scalar, Color const& c);
+template <typename C, detail::enable_if_color_t<C> = true>
+[[nodiscard]] constexpr auto operator*(double scalar, C&& c) noexcept {
+    return detail::make_color_expression<detail::Multiply>(scalar, std::forward<C>(c));
+}
 
 // Color/scalar
-Color operator/(Color const& c, double scalar);
+template <typename C, detail::enable_if_color_t<C> = true>
+[[nodiscard]] constexpr auto operator/(C&& c, double scalar) noexcept {
+    return detail::make_color_expression<detail::Divide>(std::forward<C>(c), scalar);
+}
 
 // scalar/Color (= ERROR)
 
-// Color += Color (= Color)
-Color& operator+=(Color& lhs, Color const& rhs);
-
-// Color -= Color (= Color)
-Color& operator-=(Color& lhs, Color const& rhs);
-
-// Color *= Color (= Color)
-Color& operator*=(Color& lhs, Color const& rhs);
-
 // Color + Color = Color
-Color operator+(Color lhs, Color const& rhs);
+template <typename Lhs, typename Rhs, detail::enable_if_colors_t<Lhs, Rhs> = true>
+[[nodiscard]] constexpr auto operator+(Lhs&& lhs, Rhs&& rhs) noexcept {
+    return detail::make_color_expression<detail::Add>(std::forward<Lhs>(lhs),
+                                                      std::forward<Rhs>(rhs));
+}
 
 // Color - Color = Color
-Color operator-(Color lhs, Color const& rhs);
+template <typename Lhs, typename Rhs, detail::enable_if_colors_t<Lhs, Rhs> = true>
+[[nodiscard]] constexpr auto operator-(Lhs&& lhs, Rhs&& rhs) noexcept {
+    return detail::make_color_expression<detail::Subtract>(std::forward<Lhs>(lhs),
+                                                           std::forward<Rhs>(rhs));
+}
 
 // Color * Color = Color
-Color operator*(Color lhs, Color const& rhs);
+template <typename Lhs, typename Rhs, detail::enable_if_colors_t<Lhs, Rhs> = true>
+[[nodiscard]] constexpr auto operator*(Lhs&& lhs, Rhs&& rhs) noexcept {
+    return detail::make_color_expression<detail::Multiply>(std::forward<Lhs>(lhs),
+                                                           std::forward<Rhs>(rhs));
+}
+
+// Compound assignments evaluate the right-hand side straight into lhs. This is safe even if rhs
+// refers to lhs, because rhs is evaluated completely before lhs is written.
+
+// Color += Color (= Color)
+template <typename Rhs, detail::enable_if_color_t<Rhs> = true>
+Color& operator+=(Color& lhs, Rhs const& rhs) noexcept {
+    detail::simd4d lhs_value;
+    detail::simd4d rhs_value;
+    detail::load(lhs, lhs_value);
+    detail::evaluate(rhs, rhs_value);
+    detail::Add::apply(lhs_value, rhs_value, lhs_value);
+    return lhs = detail::store(lhs_value);
+}
+
+// Color -= Color (= Color)
+template <typename Rhs, detail::enable_if_color_t<Rhs> = true>
+Color& operator-=(Color& lhs, Rhs const& rhs) noexcept {
+    detail::simd4d lhs_value;
+    detail::simd4d rhs_value;
+    detail::load(lhs, lhs_value);
+    detail::evaluate(rhs, rhs_value);
+    detail::Subtract::apply(lhs_value, rhs_value, lhs_value);
+    return lhs = detail::store(lhs_value);
+}
 
-// Colors can be compared for equality.
-bool operator==(Color const& lhs, Color const& rhs);
+// Color *= Color (= Color)
+template <typename Rhs, detail::enable_if_color_t<Rhs> = true>
+Color& operator*=(Color& lhs, Rhs const& rhs) noexcept {
+    detail::simd4d lhs_value;
+    detail::simd4d rhs_value;
+    detail::load(lhs, lhs_value);
+    detail::evaluate(rhs, rhs_value);
+    detail::Multiply::apply(lhs_value, rhs_value, lhs_value);
+    return lhs = detail::store(lhs_value);
+}
+
+// Colors can be compared for equality. The padding lane does not take part.
+inline bool operator==(Color const& lhs, Color const& rhs) {
+    // floating-point comparison through epsilon
+    return detail::almost_equal(lhs.r, rhs.r) && detail::almost_equal(lhs.g, rhs.g) &&
+           detail::almost_equal(lhs.b, rhs.b);
+}
 
 // Colors can be compared for inequality.
-bool operator!=(Color const& lhs, Color const& rhs);
+inline bool operator!=(Color const& lhs, Color const& rhs) { return !(lhs == rhs); }
 
 std::ostream& operator<<(std::ostream& os, Color const& c);
 
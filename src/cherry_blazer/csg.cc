@@ -0,0 +1,270 @@
+#include "csg.hh"
+
+#include "intersection.hh"
+#include "normal.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+namespace cherry_blazer {
+
+namespace {
+
+constexpr auto infinity = std::numeric_limits<double>::infinity();
+
+// Whether an object space point is strictly inside the solid.
+bool contains(Sphere const& /*sphere*/, Point3d const& p) noexcept {
+    return p[0] * p[0] + p[1] * p[1] + p[2] * p[2] < 1.;
+}
+
+bool contains(Plane const& /*plane*/, Point3d const& p) noexcept { return p[1] < 0.; }
+
+bool contains(Cube const& /*cube*/, Point3d const& p) noexcept {
+    return std::abs(p[0]) < 1. && std::abs(p[1]) < 1. && std::abs(p[2]) < 1.;
+}
+
+bool contains(Cylinder const& cylinder, Point3d const& p) noexcept {
+    return p[0] * p[0] + p[2] * p[2] < 1. && cylinder.minimum < p[1] && p[1] < cylinder.maximum;
+}
+
+bool contains(Cone const& cone, Point3d const& p) noexcept {
+    return p[0] * p[0] + p[2] * p[2] < p[1] * p[1] && cone.minimum < p[1] && p[1] < cone.maximum;
+}
+
+Crossings crossings(Sphere const& sphere, Ray const& ray) noexcept {
+    Crossings out;
+    if (auto const interval = intersect_interval(sphere, ray)) {
+        out.push_back(interval->first);
+        out.push_back(interval->second);
+    }
+    return out;
+}
+
+Aabb overlap(Aabb const& lhs, Aabb const& rhs) noexcept {
+    Aabb box;
+    for (std::size_t axis = 0; axis < 3; ++axis) {
+        box.min[axis] = std::max(lhs.min[axis], rhs.min[axis]);
+        box.max[axis] = std::min(lhs.max[axis], rhs.max[axis]);
+    }
+    return box;
+}
+
+Aabb merge(Aabb const& lhs, Aabb const& rhs) noexcept {
+    Aabb box;
+    for (std::size_t axis = 0; axis < 3; ++axis) {
+        box.min[axis] = std::min(lhs.min[axis], rhs.min[axis]);
+        box.max[axis] = std::max(lhs.max[axis], rhs.max[axis]);
+    }
+    return box;
+}
+
+} // namespace
+
+Csg::Csg(CsgShape shape) {
+    auto const open = [](auto const* cut) {
+        return cut != nullptr && !cut->closed &&
+               (std::isfinite(cut->minimum) || std::isfinite(cut->maximum));
+    };
+    if (open(std::get_if<Cylinder>(&shape)) || open(std::get_if<Cone>(&shape)))
+        throw std::logic_error{"Csg: cut cylinders and cones must be closed to be solid"};
+
+    auto const box =
+        std::visit([](auto const& leaf) { return cherry_blazer::bounds(leaf); }, shape);
+    nodes_.push_back({box, 0, true, CsgOperation::Union});
+    leaves_.push_back({std::move(shape), false});
+}
+
+Csg::Csg(CsgOperation operation, Csg left, Csg right) {
+    if (left.leaves_.size() + right.leaves_.size() > max_leaves)
+        throw std::logic_error{"Csg: too many leaves"};
+
+    auto box = left.bounds();
+    if (operation == CsgOperation::Union)
+        box = merge(box, right.bounds());
+    else if (operation == CsgOperation::Intersection)
+        box = overlap(box, right.bounds());
+
+    auto const right_node = static_cast<std::uint16_t>(1 + left.nodes_.size());
+    auto const right_leaf = static_cast<std::uint16_t>(left.leaves_.size());
+    nodes_.reserve(1 + left.nodes_.size() + right.nodes_.size());
+    nodes_.push_back({box, right_node, false, operation});
+    for (auto node : left.nodes_) {
+        if (!node.is_leaf)
+            node.index = static_cast<std::uint16_t>(node.index + 1);
+        nodes_.push_back(node);
+    }
+    for (auto node : right.nodes_) {
+        auto const offset = node.is_leaf ? right_leaf : right_node;
+        node.index = static_cast<std::uint16_t>(node.index + offset);
+        nodes_.push_back(node);
+    }
+
+    leaves_ = std::move(left.leaves_);
+    for (auto& leaf : right.leaves_) {
+        if (operation == CsgOperation::Difference)
+            leaf.flipped = !leaf.flipped;
+        leaves_.push_back(std::move(leaf));
+    }
+}
+
+std::size_t Csg::leaf_count() const noexcept { return leaves_.size(); }
+
+CsgShape const& Csg::leaf(std::uint16_t leaf) const noexcept { return leaves_[leaf].shape; }
+
+Aabb const& Csg::bounds() const noexcept { return nodes_.front().box; }
+
+template <typename F> bool Csg::any_boundary(Ray const& ray, double max_t, F const& f) const {
+    Trace const trace{ray,
+                      {ray.origin[0], ray.origin[1], ray.origin[2]},
+                      {1. / ray.direction[0], 1. / ray.direction[1], 1. / ray.direction[2]}};
+    Spans spans;
+    this->spans(0, trace, 0., max_t, spans);
+    for (auto const& [enter, leave] : spans) {
+        for (auto const& boundary : {enter, leave}) {
+            if (boundary.t >= max_t)
+                return false;
+            if (boundary.t >= 0. && f(boundary))
+                return true;
+        }
+    }
+    return false;
+}
+
+std::optional<CsgHit> Csg::closest_hit(Ray const& ray, double max_t) const {
+    std::optional<CsgHit> closest;
+    any_boundary(ray, max_t, [&closest](Boundary const& boundary) {
+        closest = CsgHit{boundary.t, boundary.leaf};
+        return true;
+    });
+    return closest;
+}
+
+bool Csg::occluded(Ray const& ray, double max_t) const {
+    return any_boundary(ray, max_t, [](Boundary const& boundary) { return boundary.t > 0.; });
+}
+
+Vec3d Csg::normal(std::uint16_t leaf, Point3d const& at_world_point) const {
+    auto const normal = std::visit(
+        [&at_world_point](auto const& shape) {
+            return cherry_blazer::normal(shape, at_world_point);
+        },
+        leaves_[leaf].shape);
+    return leaves_[leaf].flipped ? -normal : normal;
+}
+
+Material const& Csg::material(std::uint16_t leaf) const {
+    return std::visit([](auto const& shape) -> Material const& { return shape.material; },
+                      leaves_[leaf].shape);
+}
+
+void Csg::spans(std::uint16_t node_index, Trace const& trace, double min_t, double max_t,
+                Spans& out) const {
+    auto const& node = nodes_[node_index];
+    out.clear();
+    if (detail::box_entry(node.box, trace.origin, trace.inverse_direction, max_t) == infinity)
+        return;
+
+    if (node.is_leaf) {
+        // Between consecutive crossings the ray is either inside or outside; a point of each such
+        // piece tells which.
+        std::visit(
+            [&](auto const& shape) {
+                auto const ts = crossings(shape, trace.ray);
+                auto const local = to_object_space(trace.ray, shape.transformation);
+                auto const inside = [&](double t) { return contains(shape, local.position(t)); };
+                auto enter = Boundary{-infinity, node.index};
+                for (std::size_t i = 0; i <= ts.size(); ++i) {
+                    auto const leave = Boundary{i < ts.size() ? ts[i] : infinity, node.index};
+                    auto const sample = ts.empty()        ? 0.
+                                        : i == 0          ? ts.front() - 1.
+                                        : i == ts.size() ? ts.back() + 1.
+                                                          : (enter.t + leave.t) / 2.;
+                    if (inside(sample) && leave.t >= min_t && enter.t <= max_t) {
+                        if (!out.empty() && out.back().leave.t == enter.t)
+                            out.back().leave = leave; // past a point where it only touches
+                        else
+                            out.push_back({enter, leave});
+                    }
+                    enter = leave;
+                }
+            },
+            leaves_[node.index].shape);
+        return;
+    }
+
+    Spans left;
+    spans(static_cast<std::uint16_t>(node_index + 1), trace, min_t, max_t, left);
+    if (node.operation == CsgOperation::Union) {
+        // A span across the whole range leaves nothing for the right side to add.
+        for (auto const& span : left) {
+            if (span.enter.t <= min_t && span.leave.t >= max_t) {
+                out.push_back(span);
+                return;
+            }
+        }
+    } else if (left.empty()) {
+        return; // nothing to intersect with or carve out of
+    } else {
+        min_t = std::max(min_t, left.front().enter.t);
+        max_t = std::min(max_t, left.back().leave.t);
+    }
+    Spans right;
+    spans(node.index, trace, min_t, max_t, right);
+
+    // The spans of either side are sorted and disjoint, and so are the combined ones.
+    switch (node.operation) {
+    case CsgOperation::Union: {
+        std::size_t i = 0;
+        std::size_t j = 0;
+        while (i < left.size() || j < right.size()) {
+            auto const& next = j == right.size() || (i < left.size() &&
+                                                     left[i].enter.t <= right[j].enter.t)
+                                   ? left[i++]
+                                   : right[j++];
+            if (out.empty() || next.enter.t > out.back().leave.t)
+                out.push_back(next);
+            else if (next.leave.t > out.back().leave.t)
+                out.back().leave = next.leave;
+        }
+        break;
+    }
+    case CsgOperation::Intersection: {
+        std::size_t i = 0;
+        std::size_t j = 0;
+        while (i < left.size() && j < right.size()) {
+            auto const& enter =
+                left[i].enter.t >= right[j].enter.t ? left[i].enter : right[j].enter;
+            auto const& leave =
+                left[i].leave.t <= right[j].leave.t ? left[i].leave : right[j].leave;
+            if (enter.t < leave.t)
+                out.push_back({enter, leave});
+            if (left[i].leave.t < right[j].leave.t)
+                ++i;
+            else
+                ++j;
+        }
+        break;
+    }
+    case CsgOperation::Difference: {
+        std::size_t first = 0;
+        for (auto const& span : left) {
+            auto enter = span.enter;
+            while (first < right.size() && right[first].leave.t <= enter.t)
+                ++first;
+            for (auto j = first; j < right.size() && right[j].enter.t < span.leave.t; ++j) {
+                if (right[j].enter.t > enter.t)
+                    out.push_back({enter, right[j].enter});
+                enter = right[j].leave;
+            }
+            if (enter.t < span.leave.t)
+                out.push_back({enter, span.leave});
+        }
+        break;
+    }
+    }
+}
+
+} // namespace cherry_blazer
@@ -0,0 +1,125 @@
+#pragma once
+
+#include "bvh.hh"
+#include "material.hh"
+#include "point.hh"
+#include "ray.hh"
+#include "shapes.hh"
+#include "sphere.hh"
+#include "vector.hh"
+
+#include <boost/container/static_vector.hpp>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace cherry_blazer {
+
+// A leaf of a Csg: any solid shape, placed in the world by its own transformation.
+using CsgShape = std::variant<Sphere, Plane, Cube, Cylinder, Cone>;
+
+enum class CsgOperation : std::uint8_t { Union, Intersection, Difference };
+
+// The nearest crossing of a ray with the surface of a Csg, and the leaf that surface is on.
+struct CsgHit {
+    double t;
+    std::uint16_t leaf;
+};
+
+// Constructive solid geometry: a tree of unions, intersections and differences of shapes. Its
+// surface is made of pieces of the leaves' surfaces, each with the material of its leaf; a plane
+// counts as the half-space below it.
+//
+// A ray is traced as the spans of t over which it is inside each node, combined bottom-up in
+// lists of fixed capacity, so that tracing never allocates. A node is only evaluated over the
+// range of t where its result can still matter: the right side of an intersection or difference
+// is skipped if the left side is empty, and otherwise evaluated only where the left side is, and
+// a node whose box the ray misses in that range is empty without evaluating its leaves.
+class Csg {
+  public:
+    // Most leaves in a tree. Each leaf is inside along at most two spans of a ray, and combining
+    // two nodes gives at most as many spans as they have together, so this bounds the spans too.
+    static constexpr std::size_t max_leaves = 16;
+
+    // A tree of one shape. Throws std::logic_error for cylinders or cones that are cut but not
+    // closed: they are not solid.
+    explicit Csg(CsgShape shape);
+    template <typename Shape>
+        requires std::is_constructible_v<CsgShape, Shape>
+    Csg(Shape shape) // NOLINT(google-explicit-constructor)
+        : Csg{CsgShape{std::move(shape)}} {}
+    // Throws std::logic_error if the tree would have more than max_leaves leaves.
+    Csg(CsgOperation operation, Csg left, Csg right);
+
+    [[nodiscard]] std::size_t leaf_count() const noexcept;
+    [[nodiscard]] CsgShape const& leaf(std::uint16_t leaf) const noexcept;
+    [[nodiscard]] Aabb const& bounds() const noexcept;
+
+    // Nearest crossing of the surface in [0;max_t), if any.
+    [[nodiscard]] std::optional<CsgHit> closest_hit(Ray const& ray, double max_t) const;
+    // Whether the ray crosses the surface between its origin and ray.position(max_t).
+    [[nodiscard]] bool occluded(Ray const& ray, double max_t) const;
+
+    // Unit normal, in world space, at a point on the part of the surface from the given leaf.
+    // Where a difference carves a leaf out, its normal points into that leaf.
+    [[nodiscard]] Vec3d normal(std::uint16_t leaf, Point3d const& at_world_point) const;
+    [[nodiscard]] Material const& material(std::uint16_t leaf) const;
+
+  private:
+    struct Node {
+        Aabb box;
+        // Leaves: index into leaves_. Inner nodes: index of the right child in nodes_, the left
+        // one following the node itself.
+        std::uint16_t index;
+        bool is_leaf;
+        CsgOperation operation;
+    };
+
+    struct Leaf {
+        CsgShape shape;
+        // On the right of an odd number of differences: its surface faces into the Csg.
+        bool flipped;
+    };
+
+    struct Boundary {
+        double t;
+        std::uint16_t leaf;
+    };
+
+    struct Span {
+        Boundary enter;
+        Boundary leave;
+    };
+
+    using Spans = boost::container::static_vector<Span, 2 * max_leaves>;
+
+    // A ray, with what the box tests need of it computed once.
+    struct Trace {
+        Ray const& ray;
+        std::array<double, 3> origin;
+        std::array<double, 3> inverse_direction;
+    };
+
+    // Nodes in pre-order.
+    std::vector<Node> nodes_;
+    std::vector<Leaf> leaves_;
+
+    // The spans of the node's solid that overlap [min_t;max_t]; spans outside it may be left out.
+    void spans(std::uint16_t node, Trace const& trace, double min_t, double max_t,
+               Spans& out) const;
+    // Whether f(boundary) holds for any boundary of the spans in [0;max_t), tried in increasing
+    // order.
+    template <typename F> bool any_boundary(Ray const& ray, double max_t, F const& f) const;
+};
+
+// The smallest box around a Csg that its nodes' boxes give; infinite if it has unbounded leaves
+// outside of intersections.
+[[nodiscard]] inline Aabb bounds(Csg const& csg) noexcept { return csg.bounds(); }
+
+} // namespace cherry_blazer
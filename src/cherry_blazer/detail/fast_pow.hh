@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <numbers>
+
+namespace cherry_blazer::detail {
+
+// Exponentiation by squaring: O(log exponent) multiplications instead of a std::pow call.
+// https://en.wikipedia.org/wiki/Exponentiation_by_squaring
+[[nodiscard]] constexpr double ipow(double base, std::uint32_t exponent) noexcept {
+    double result = 1.;
+    while (exponent != 0) {
+        if ((exponent & 1U) != 0)
+            result *= base;
+        base *= base;
+        exponent >>= 1U;
+    }
+    return result;
+}
+
+// Whether ipow() can be used for the exponent.
+[[nodiscard]] inline bool is_small_integral(double exponent) noexcept {
+    constexpr double max_exponent = 1U << 16U;
+    return exponent >= 0. && exponent <= max_exponent && std::trunc(exponent) == exponent;
+}
+
+// log2 of a positive, finite, normal x. Absolute error is about 1e-9.
+// The exponent is read from the bits, the mantissa is brought to m in [sqrt(2)/2;sqrt(2)) and goes
+// through the series ln(m) = 2 * atanh((m-1)/(m+1)), truncated after the 9th power.
+[[nodiscard]] inline double approx_log2(double x) noexcept {
+    constexpr std::uint64_t mantissa_mask = (std::uint64_t{1} << 52U) - 1;
+    constexpr std::uint64_t exponent_of_one = std::uint64_t{1023} << 52U;
+
+    auto const bits = __builtin_bit_cast(std::uint64_t, x);
+    auto exponent = static_cast<double>(static_cast<std::int64_t>(bits >> 52U) - 1023);
+    auto mantissa = __builtin_bit_cast(double, (bits & mantissa_mask) | exponent_of_one);
+
+    // Conditional moves rather than branches.
+    auto const above = mantissa > std::numbers::sqrt2;
+    mantissa = above ? mantissa * .5 : mantissa;
+    exponent = above ? exponent + 1. : exponent;
+
+    auto const t = (mantissa - 1.) / (mantissa + 1.);
+    auto const t2 = t * t;
+    constexpr double two_over_ln2 = 2. / std::numbers::ln2;
+    auto const series =
+        t * (1. + t2 * (1. / 3. + t2 * (1. / 5. + t2 * (1. / 7. + t2 * (1. / 9.)))));
+    return exponent + two_over_ln2 * series;
+}
+
+// 2^x. Relative error is below 1e-8. Results below the smallest normal double flush to zero.
+// The nearest integer to x goes straight into the exponent bits, the remainder f in [-0.5;0.5]
+// through the Taylor series of e^(f*ln2), truncated after the 7th power.
+[[nodiscard]] inline double approx_exp2(double x) noexcept {
+    if (x < double(std::numeric_limits<double>::min_exponent - 1))
+        return 0.;
+    if (x > double(std::numeric_limits<double>::max_exponent - 1))
+        return std::numeric_limits<double>::infinity();
+
+    auto const integral = std::floor(x + .5);
+    auto const y = (x - integral) * std::numbers::ln2;
+    auto const series =
+        1. +
+        y * (1. +
+             y * (1. / 2. +
+                  y * (1. / 6. +
+                       y * (1. / 24. + y * (1. / 120. + y * (1. / 720. + y * (1. / 5040.)))))));
+
+    auto const biased_exponent =
+        static_cast<std::uint64_t>(static_cast<std::int64_t>(integral) + 1023);
+    return series * __builtin_bit_cast(double, biased_exponent << 52U);
+}
+
+// base^exponent for base in (0;1], which is the range of cosines the specular term works with.
+// Branch-free apart from the range checks, so a loop over it vectorises.
+[[nodiscard]] inline double approx_pow(double base, double exponent) noexcept {
+    return approx_exp2(exponent * approx_log2(base));
+}
+
+} // namespace cherry_blazer::detail
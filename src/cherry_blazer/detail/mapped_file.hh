@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <string_view>
+
+namespace cherry_blazer::detail {
+
+// A file mapped into memory, read-only, for parsing it in place.
+class MappedFile {
+  public:
+    // Throws std::system_error if the file cannot be opened or mapped.
+    explicit MappedFile(std::filesystem::path const& path);
+
+    MappedFile(MappedFile const&) = delete;
+    MappedFile& operator=(MappedFile const&) = delete;
+    ~MappedFile();
+
+    [[nodiscard]] std::string_view text() const noexcept { return {data_, size_}; }
+
+  private:
+    char const* data_{nullptr};
+    std::size_t size_{0};
+};
+
+} // namespace cherry_blazer::detail
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace cherry_blazer::detail {
+
+// Array which either owns its elements or refers to elements stored elsewhere, e.g. in a mapped
+// file. Either way, span() gives the elements. Copies of an owning array own a copy of the
+// elements; copies of a viewing array refer to the same elements.
+template <typename T> class OwnedOrViewed {
+  public:
+    OwnedOrViewed() = default;
+    explicit OwnedOrViewed(std::vector<T> elements)
+        : owned_{std::move(elements)}, view_{owned_}, owns_{true} {}
+    explicit OwnedOrViewed(std::span<T> elements) : view_{elements}, owns_{false} {}
+
+    OwnedOrViewed(OwnedOrViewed const& other)
+        : owned_{other.owned_}, view_{other.owns_ ? std::span<T>{owned_} : other.view_},
+          owns_{other.owns_} {}
+
+    // Moving a vector keeps its buffer, so the view stays valid.
+    OwnedOrViewed(OwnedOrViewed&& other) noexcept
+        : owned_{std::move(other.owned_)}, view_{std::exchange(other.view_, {})},
+          owns_{other.owns_} {}
+
+    OwnedOrViewed& operator=(OwnedOrViewed other) noexcept {
+        std::swap(owned_, other.owned_);
+        std::swap(view_, other.view_);
+        std::swap(owns_, other.owns_);
+        return *this;
+    }
+
+    ~OwnedOrViewed() = default;
+
+    [[nodiscard]] std::span<T const> span() const noexcept { return view_; }
+    [[nodiscard]] std::span<T> span() noexcept { return view_; }
+
+  private:
+    std::vector<T> owned_;
+    std::span<T> view_;
+    bool owns_{true};
+};
+
+} // namespace cherry_blazer::detail
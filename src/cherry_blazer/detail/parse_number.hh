@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cerrno>
+#include <charconv>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+
+namespace cherry_blazer::detail {
+
+// The number the whole word spells. Throws std::logic_error otherwise.
+[[nodiscard]] inline double to_double(std::string_view word) {
+    double value{};
+#if defined(__cpp_lib_to_chars)
+    auto const [end, error] = std::from_chars(word.data(), word.data() + word.size(), value);
+    if (error != std::errc{} || end != word.data() + word.size())
+        throw std::logic_error{"expected a number, got '" + std::string{word} + "'"};
+#else
+    // Standard libraries without floating-point std::from_chars (e.g. libc++ 12).
+    std::string const copy{word};
+    char* end = nullptr;
+    errno = 0;
+    value = std::strtod(copy.c_str(), &end);
+    if (errno != 0 || copy.empty() || end != copy.c_str() + copy.size())
+        throw std::logic_error{"expected a number, got '" + copy + "'"};
+#endif
+    return value;
+}
+
+// Same, for whole numbers.
+template <typename Integer> [[nodiscard]] Integer to_integer(std::string_view word) {
+    Integer value{};
+    auto const [end, error] = std::from_chars(word.data(), word.data() + word.size(), value);
+    if (error != std::errc{} || end != word.data() + word.size())
+        throw std::logic_error{"expected a whole number, got '" + std::string{word} + "'"};
+    return value;
+}
+
+} // namespace cherry_blazer::detail
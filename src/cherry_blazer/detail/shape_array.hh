@@ -0,0 +1,131 @@
+#pragma once
+
+#include "../bvh.hh"
+#include "../csg.hh"
+#include "../ray.hh"
+
+#include <cmath>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace cherry_blazer::detail {
+
+// The nearest crossing of a ray with a shape, the shape's index in a ShapeArray, and for shapes
+// made of parts (Csg), the part it is on.
+struct ShapeHit {
+    double t;
+    std::uint32_t shape;
+    std::uint16_t part;
+};
+
+// What ShapeArray needs of each shape: its nearest crossing in [0;max_t), with the part it is on,
+// and whether it crosses the ray in (0;max_t). Shapes made of parts overload them.
+template <typename Shape>
+[[nodiscard]] std::optional<std::pair<double, std::uint16_t>>
+first_crossing(Shape const& shape, Ray const& ray, double max_t) noexcept {
+    for (auto const t : crossings(shape, ray)) {
+        if (t < 0.)
+            continue;
+        if (t < max_t)
+            return std::pair{t, std::uint16_t{0}};
+        break;
+    }
+    return std::nullopt;
+}
+
+template <typename Shape>
+[[nodiscard]] bool crosses(Shape const& shape, Ray const& ray, double max_t) noexcept {
+    for (auto const t : crossings(shape, ray)) {
+        if (t > 0. && t < max_t)
+            return true;
+    }
+    return false;
+}
+
+[[nodiscard]] inline std::optional<std::pair<double, std::uint16_t>>
+first_crossing(Csg const& csg, Ray const& ray, double max_t) {
+    if (auto const hit = csg.closest_hit(ray, max_t))
+        return std::pair{hit->t, hit->leaf};
+    return std::nullopt;
+}
+
+[[nodiscard]] inline bool crosses(Csg const& csg, Ray const& ray, double max_t) {
+    return csg.occluded(ray, max_t);
+}
+
+// Shapes of one type, traced with that type's kernel only, so the loops over them
+// have no dispatch in them at all. The bounded shapes are in a Bvh; unbounded ones, e.g. planes,
+// are tested by every ray.
+template <typename Shape> class ShapeArray {
+  public:
+    ShapeArray() = default;
+    explicit ShapeArray(std::vector<Shape> shapes) : shapes_{std::move(shapes)} { rebuild(); }
+
+    [[nodiscard]] std::span<Shape const> shapes() const noexcept { return shapes_; }
+    [[nodiscard]] std::span<Shape> shapes() noexcept { return shapes_; }
+
+    void rebuild() {
+        bounded_.clear();
+        unbounded_.clear();
+        std::vector<Aabb> boxes;
+        for (std::uint32_t i = 0; i < shapes_.size(); ++i) {
+            auto const box = bounds(shapes_[i]);
+            if (std::isfinite(box.min[0]) && std::isfinite(box.min[1]) &&
+                std::isfinite(box.min[2]) && std::isfinite(box.max[0]) &&
+                std::isfinite(box.max[1]) && std::isfinite(box.max[2])) {
+                bounded_.push_back(i);
+                boxes.push_back(box);
+            } else {
+                unbounded_.push_back(i);
+            }
+        }
+        bvh_ = Bvh{std::span<Aabb const>{boxes}};
+    }
+
+    // Nearest crossing in front of the ray origin and before max_t.
+    [[nodiscard]] std::optional<ShapeHit> closest_hit(Ray const& ray, double max_t) const {
+        std::optional<ShapeHit> closest;
+        auto const test = [&](std::uint32_t shape, double& closest_t) {
+            if (auto const crossing = first_crossing(shapes_[shape], ray, closest_t)) {
+                closest_t = crossing->first;
+                closest = ShapeHit{crossing->first, shape, crossing->second};
+            }
+        };
+        for (auto const shape : unbounded_)
+            test(shape, max_t);
+        bvh_.traverse(ray, max_t, [&](std::uint32_t i, double& closest_t) {
+            test(bounded_[i], closest_t);
+            return false;
+        });
+        return closest;
+    }
+
+    // Whether a shape crosses the ray between its origin and ray.position(max_t).
+    [[nodiscard]] bool occluded(Ray const& ray, double max_t) const {
+        auto const blocks = [&](std::uint32_t shape) {
+            return crosses(shapes_[shape], ray, max_t);
+        };
+        for (auto const shape : unbounded_) {
+            if (blocks(shape))
+                return true;
+        }
+        auto found = false;
+        bvh_.traverse(ray, max_t, [&](std::uint32_t i, double& /*max_t*/) {
+            found = blocks(bounded_[i]);
+            return found;
+        });
+        return found;
+    }
+
+  private:
+    std::vector<Shape> shapes_;
+    // Indices of the bounded shapes, in the order the Bvh was built from.
+    std::vector<std::uint32_t> bounded_;
+    std::vector<std::uint32_t> unbounded_;
+    Bvh bvh_;
+};
+
+} // namespace cherry_blazer::detail
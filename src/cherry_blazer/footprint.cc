@@ -0,0 +1,86 @@
+#include "footprint.hh"
+
+#include "matrix_operations.hh"
+#include "point.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <initializer_list>
+#include <limits>
+
+namespace cherry_blazer {
+
+namespace {
+
+// Pixels whose rays may hit what lies within the 8 corners of a box, corner(x, y, z) for x, y, z
+// in {0, 1}. Under a perspective projection, the image of the box lies within the bounds of its
+// projected corners, as long as all of them are in front of the eye.
+template <typename Corner>
+std::optional<Tile> corners_footprint(Corner const& corner, Camera const& camera) {
+    Tile const image{0, 0, camera.hsize(), camera.vsize()};
+
+    auto min_x = std::numeric_limits<double>::infinity();
+    auto min_y = std::numeric_limits<double>::infinity();
+    auto max_x = -std::numeric_limits<double>::infinity();
+    auto max_y = -std::numeric_limits<double>::infinity();
+
+    auto corners_behind = 0;
+    for (auto const x : {0U, 1U}) {
+        for (auto const y : {0U, 1U}) {
+            for (auto const z : {0U, 1U}) {
+                auto const projected = camera.project(corner(x, y, z));
+                if (!projected) {
+                    ++corners_behind;
+                    continue;
+                }
+                min_x = std::min(min_x, (*projected)[0]);
+                max_x = std::max(max_x, (*projected)[0]);
+                min_y = std::min(min_y, (*projected)[1]);
+                max_y = std::max(max_y, (*projected)[1]);
+            }
+        }
+    }
+
+    if (corners_behind == 8)
+        return std::nullopt;
+    if (corners_behind != 0)
+        return image;
+
+    // Pixel (x, y) covers [x-.5;x+.5] x [y-.5;y+.5]. Round outwards, and clip to the image.
+    auto const width = double(camera.hsize());
+    auto const height = double(camera.vsize());
+    auto const left = std::max(std::floor(min_x), 0.);
+    auto const top = std::max(std::floor(min_y), 0.);
+    auto const right = std::min(std::ceil(max_x), width - 1.);
+    auto const bottom = std::min(std::ceil(max_y), height - 1.);
+    if (left > right || top > bottom)
+        return std::nullopt;
+
+    return Tile{unsigned(left), unsigned(top), unsigned(right - left) + 1,
+                unsigned(bottom - top) + 1};
+}
+
+} // namespace
+
+std::optional<Tile> screen_footprint(Sphere const& sphere, Camera const& camera) {
+    // The unit sphere fits the cube [-1;1]^3.
+    return corners_footprint(
+        [&sphere](unsigned x, unsigned y, unsigned z) {
+            return sphere.transformation.mat *
+                   Point3d{x != 0 ? 1. : -1., y != 0 ? 1. : -1., z != 0 ? 1. : -1.};
+        },
+        camera);
+}
+
+std::optional<Tile> screen_footprint(Aabb const& box, Camera const& camera) {
+    if (box.min[0] > box.max[0])
+        return std::nullopt; // empty
+    return corners_footprint(
+        [&box](unsigned x, unsigned y, unsigned z) {
+            return Point3d{x != 0 ? box.max[0] : box.min[0], y != 0 ? box.max[1] : box.min[1],
+                           z != 0 ? box.max[2] : box.min[2]};
+        },
+        camera);
+}
+
+} // namespace cherry_blazer
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "bvh.hh"
+#include "camera.hh"
+#include "sphere.hh"
+#include "tile.hh"
+
+#include <optional>
+
+namespace cherry_blazer {
+
+// Pixels whose rays may hit the sphere, as a rectangle clipped to the image: the projection of the
+// sphere's transformed bounding box, rounded outwards. Conservative, so rays outside of it surely
+// miss the sphere. Nothing if the sphere is entirely outside the image or behind the eye; the
+// whole image if only part of it is behind the eye.
+std::optional<Tile> screen_footprint(Sphere const& sphere, Camera const& camera);
+
+// Same for whatever lies within the box, e.g. an Instance (see bounds()).
+std::optional<Tile> screen_footprint(Aabb const& box, Camera const& camera);
+
+} // namespace cherry_blazer
@@ -0,0 +1,67 @@
+#include "g_buffer.hh"
+
+#include <boost/assert.hpp>
+
+#include <stdexcept>
+
+namespace cherry_blazer {
+
+GBuffer::GBuffer(World const& world, Camera const& camera)
+    : width_{camera.hsize()}, height_{camera.vsize()}, counts_{counts(world)},
+      surfaces_{std::make_unique<Surface[]>(width_ * height_)},
+      in_shadow_{std::make_unique<bool[]>(width_ * height_ * counts_.lights)} {
+    for (auto y{0U}; y < height_; ++y) {
+        for (auto x{0U}; x < width_; ++x) {
+            auto const ray = camera.ray_for_pixel(x, y);
+            auto& surface = surfaces_[index(x, y)];
+            auto const hit = world.closest_hit(ray);
+            if (!hit) {
+                surface.object = background;
+                continue;
+            }
+            surface = world.surface(ray, *hit);
+            world.shadows(surface.point, surface.normal_vector,
+                          {&in_shadow_[index(x, y) * counts_.lights], counts_.lights});
+        }
+    }
+}
+
+unsigned GBuffer::width() const { return unsigned(width_); }
+
+unsigned GBuffer::height() const { return unsigned(height_); }
+
+Surface const& GBuffer::surface(unsigned x, unsigned y) const { return surfaces_[index(x, y)]; }
+
+std::span<bool const> GBuffer::in_shadow(unsigned x, unsigned y) const {
+    return {&in_shadow_[index(x, y) * counts_.lights], counts_.lights};
+}
+
+Canvas GBuffer::shade(World const& world, SpecularQuality quality) const {
+    if (counts(world) != counts_)
+        throw std::logic_error{"GBuffer: world does not match the buffer"};
+
+    Canvas canvas{width_, height_};
+    for (auto y{0U}; y < height_; ++y) {
+        for (auto x{0U}; x < width_; ++x) {
+            auto const& surface = surfaces_[index(x, y)];
+            if (surface.object != background)
+                canvas(x, y) = world.shade(surface, in_shadow(x, y), quality);
+        }
+    }
+    canvas.mark_dirty({0, 0, canvas.width(), canvas.height()});
+    return canvas;
+}
+
+std::size_t GBuffer::index(unsigned x, unsigned y) const {
+    BOOST_VERIFY(x < width_);
+    BOOST_VERIFY(y < height_);
+    return y * width_ + x;
+}
+
+GBuffer::Counts GBuffer::counts(World const& world) {
+    return {world.objects().size(), world.instances().size(), world.meshes().size(),
+            world.planes().size(), world.cubes().size(), world.cylinders().size(),
+            world.cones().size(), world.csgs().size(), world.lights().size()};
+}
+
+} // namespace cherry_blazer
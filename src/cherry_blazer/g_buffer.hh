@@ -0,0 +1,71 @@
+#pragma once
+
+#include "camera.hh"
+#include "canvas.hh"
+#include "lighting.hh"
+#include "world.hh"
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <span>
+
+namespace cherry_blazer {
+
+// G-buffer: the result of tracing the camera rays through a world, before any lighting. For every
+// pixel, the surface it sees (hit point, normal, eye vector and object) and the shadow flags of the
+// lights there. shade() then turns it into an image by running lighting() only, so changes to
+// materials, and to light colors, cost no tracing at all. For the same reason it only has direct
+// light: no reflections or refraction.
+//
+// The buffer stays valid as long as the geometry, the camera, and the light positions and radii
+// don't change; otherwise build a new one.
+class GBuffer {
+  public:
+    // Object index of pixels which see nothing.
+    static constexpr std::uint32_t background = std::numeric_limits<std::uint32_t>::max();
+
+    GBuffer(World const& world, Camera const& camera);
+
+    [[nodiscard]] unsigned width() const;
+    [[nodiscard]] unsigned height() const;
+
+    // Surface seen through the pixel; object is background if there is none.
+    [[nodiscard]] Surface const& surface(unsigned x, unsigned y) const;
+    [[nodiscard]] std::span<bool const> in_shadow(unsigned x, unsigned y) const;
+
+    // Light the buffer with the current materials and lights of world, which must be the world the
+    // buffer was built from (possibly changed in place since). Throws std::logic_error if its
+    // number of lights, or of objects, instances, meshes or shapes of any type, differs.
+    [[nodiscard]] Canvas shade(World const& world,
+                               SpecularQuality quality = SpecularQuality::Exact) const;
+
+  private:
+    // How many of each the world has, to tell a world from the one the buffer was built from.
+    struct Counts {
+        std::size_t objects;
+        std::size_t instances;
+        std::size_t meshes;
+        std::size_t planes;
+        std::size_t cubes;
+        std::size_t cylinders;
+        std::size_t cones;
+        std::size_t csgs;
+        std::size_t lights;
+
+        bool operator==(Counts const&) const = default;
+    };
+
+    std::size_t width_;
+    std::size_t height_;
+    Counts counts_;
+    std::unique_ptr<Surface[]> surfaces_;
+    // counts_.lights flags per pixel
+    std::unique_ptr<bool[]> in_shadow_;
+
+    [[nodiscard]] std::size_t index(unsigned x, unsigned y) const;
+    [[nodiscard]] static Counts counts(World const& world);
+};
+
+} // namespace cherry_blazer
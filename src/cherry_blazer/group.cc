@@ -0,0 +1,17 @@
+#include "group.hh"
+
+#include <utility>
+
+namespace cherry_blazer {
+
+Group::Group(std::vector<Sphere> objects) : objects_{std::move(objects)}, bvh_{objects_} {}
+
+std::span<Sphere const> Group::objects() const { return objects_; }
+
+Bvh const& Group::bvh() const { return bvh_; }
+
+Aabb bounds(Instance const& instance) noexcept {
+    return bounds(instance.group->bvh().root_bounds(), instance.transformation.mat);
+}
+
+} // namespace cherry_blazer
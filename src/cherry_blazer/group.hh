@@ -0,0 +1,40 @@
+#pragma once
+
+#include "bvh.hh"
+#include "sphere.hh"
+#include "transformation.hh"
+
+#include <memory>
+#include <span>
+#include <vector>
+
+namespace cherry_blazer {
+
+// Objects defined once and placed any number of times by Instances, e.g. the tree of a forest. The
+// group's Bvh is the bottom level of a two-level hierarchy: the instances share it, and the World
+// only builds a Bvh over the instances on top of it. So memory grows with the objects of the
+// groups, not with the number of instances.
+class Group {
+  public:
+    explicit Group(std::vector<Sphere> objects);
+
+    // In the group's own space, which instances place in the world.
+    [[nodiscard]] std::span<Sphere const> objects() const;
+    [[nodiscard]] Bvh const& bvh() const;
+
+  private:
+    std::vector<Sphere> objects_;
+    Bvh bvh_;
+};
+
+// A placement of a group: its objects, seen through transformation. Instances of the same group
+// share its objects, and so their materials and ids.
+struct Instance {
+    std::shared_ptr<Group const> group;
+    Transformation transformation;
+};
+
+// Smallest box around the placed group.
+[[nodiscard]] Aabb bounds(Instance const& instance) noexcept;
+
+} // namespace cherry_blazer
@@ -15,6 +15,10 @@
 #include <limits>
 #endif
 
+#include <cmath>
+#include <optional>
+#include <utility>
+
 namespace cherry_blazer {
 
 Intersection::Intersection(double t, Sphere const& object) : t{t}, object{object} {}
@@ -22,9 +26,15 @@ Intersection::Intersection(double t, Sphere const& object) : t{t}, object{object
 bool operator<(Intersection const& lhs, Intersection const& rhs) { return lhs.t < rhs.t; }
 
 std::vector<Intersection> intersect(Sphere const& sphere, Ray const& ray) {
+    auto const interval = intersect_interval(sphere, ray);
+    if (!interval)
+        return {};
+    return {{interval->first, sphere}, {interval->second, sphere}};
+}
+
+std::optional<std::pair<double, double>> intersect_interval(Sphere const& sphere, Ray const& ray) {
     // Account for the transformations applied to sphere (so, apply the inverse of them to ray).
-    auto transformed_ray =
-        transform(ray, {inverse(sphere.transformation.mat), sphere.transformation.kind});
+    auto const transformed_ray = to_object_space(ray, sphere.transformation);
 
     // Create vector from the sphere center towards ray origin.
     auto const from_sphere_to_transformed_ray = Vector{Point{0., 0., 0.}, transformed_ray.origin};
@@ -37,16 +47,16 @@ std::vector<Intersection> intersect(Sphere const& sphere, Ray const& ray) {
     auto const two_a = 2. * a;
     if (detail::almost_equal(discriminant, 0.)) {
         auto const result = -b / two_a;
-        return {{result, sphere}, {result, sphere}};
+        return std::pair{result, result};
     }
 
     // Only now check for no solutions, since near zero result (above) can be negative as well.
     if (discriminant < 0.) {
-        return {};
+        return std::nullopt;
     }
 
     auto const sqrt_discriminant = std::sqrt(discriminant);
-    return {{(-b - sqrt_discriminant) / two_a, sphere}, {(-b + sqrt_discriminant) / two_a, sphere}};
+    return std::pair{(-b - sqrt_discriminant) / two_a, (-b + sqrt_discriminant) / two_a};
 }
 
 Intersection const* hit(std::vector<Intersection> const& intersections) {
@@ -2,6 +2,7 @@
 
 #include "sphere.hh"
 
+#include <optional>
 #include <utility>
 #include <vector>
 
@@ -20,6 +21,10 @@ bool operator<(Intersection const& lhs, Intersection const& rhs);
 
 std::vector<Intersection> intersect(Sphere const& sphere, Ray const& ray);
 
+// Values of t at which the ray enters and leaves the sphere (equal if the ray only touches it), or
+// nothing if the ray misses it. Unlike intersect(), it neither allocates nor copies the sphere.
+std::optional<std::pair<double, double>> intersect_interval(Sphere const& sphere, Ray const& ray);
+
 Intersection const* hit(std::vector<Intersection> const& intersections);
 
 } // namespace cherry_blazer
@@ -0,0 +1,143 @@
+#include "light_grid.hh"
+
+#include "point_operations.hh"
+#include "vector.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+namespace cherry_blazer {
+
+namespace {
+
+// Upper bound on the grid resolution, to keep memory in check when a few lights are far apart.
+constexpr std::size_t max_cells_per_axis = 128;
+
+double average_diameter(std::vector<PointLight> const& lights) {
+    double sum{};
+    std::size_t count{};
+    for (auto const& light : lights) {
+        if (std::isfinite(light.radius)) {
+            sum += 2. * light.radius;
+            ++count;
+        }
+    }
+    return count == 0 ? 1. : sum / double(count);
+}
+
+} // namespace
+
+LightGrid::LightGrid(std::vector<PointLight> lights)
+    : LightGrid(std::move(lights), std::numeric_limits<double>::quiet_NaN()) {}
+
+LightGrid::LightGrid(std::vector<PointLight> lights, double cell_size)
+    : lights_{std::move(lights)} {
+    if (lights_.size() > std::numeric_limits<std::uint32_t>::max())
+        throw std::logic_error{"LightGrid: too many lights."};
+    if (std::isnan(cell_size)) // delegated from the constructor without cell size
+        cell_size = average_diameter(lights_);
+    if (!(cell_size > 0.))
+        throw std::logic_error{"LightGrid: cell size must be positive."};
+
+    // Bounds of the finite lights' influence.
+    Point3d lower{std::numeric_limits<double>::max(), std::numeric_limits<double>::max(),
+                  std::numeric_limits<double>::max()};
+    Point3d upper{std::numeric_limits<double>::lowest(), std::numeric_limits<double>::lowest(),
+                  std::numeric_limits<double>::lowest()};
+    std::vector<std::uint32_t> bounded;
+    for (std::uint32_t i{}; i < lights_.size(); ++i) {
+        auto const& light = lights_[i];
+        if (!(light.radius >= 0.))
+            throw std::logic_error{"LightGrid: light radius must be non-negative."};
+        if (std::isinf(light.radius)) {
+            unbounded_.push_back(i);
+            continue;
+        }
+        bounded.push_back(i);
+        for (std::size_t axis{}; axis < 3; ++axis) {
+            lower[axis] = std::min(lower[axis], light.position[axis] - light.radius);
+            upper[axis] = std::max(upper[axis], light.position[axis] + light.radius);
+        }
+    }
+
+    if (bounded.empty()) {
+        // Single empty cell, every point maps to it.
+        cell_count_ = {1, 1, 1};
+        cell_offsets_ = {0, 0};
+        return;
+    }
+
+    double largest_extent{};
+    for (std::size_t axis{}; axis < 3; ++axis)
+        largest_extent = std::max(largest_extent, upper[axis] - lower[axis]);
+    cell_size = std::max(cell_size, largest_extent / double(max_cells_per_axis));
+
+    origin_ = lower;
+    inverse_cell_size_ = 1. / cell_size;
+    for (std::size_t axis{}; axis < 3; ++axis) {
+        auto const cells = std::ceil((upper[axis] - lower[axis]) * inverse_cell_size_);
+        cell_count_[axis] = std::clamp(std::size_t(cells), std::size_t{1}, max_cells_per_axis);
+    }
+
+    // Two passes over the lights: count the lights of every cell, then fill them in.
+    auto const total_cells = cell_count_[0] * cell_count_[1] * cell_count_[2];
+    cell_offsets_.assign(total_cells + 1, 0);
+
+    auto const for_each_cell = [this](PointLight const& light, auto&& function) {
+        auto const radius = Vector{light.radius, light.radius, light.radius};
+        auto const first = cell_of(light.position - radius);
+        auto const last = cell_of(light.position + radius);
+        for (auto z{first[2]}; z <= last[2]; ++z)
+            for (auto y{first[1]}; y <= last[1]; ++y)
+                for (auto x{first[0]}; x <= last[0]; ++x)
+                    function(cell_index({x, y, z}));
+    };
+
+    for (auto const i : bounded)
+        for_each_cell(lights_[i], [&](std::size_t cell) { ++cell_offsets_[cell + 1]; });
+    for (std::size_t cell{}; cell < total_cells; ++cell)
+        cell_offsets_[cell + 1] += cell_offsets_[cell];
+
+    cell_lights_.resize(cell_offsets_.back());
+    std::vector<std::uint32_t> fill(cell_offsets_.begin(), cell_offsets_.end() - 1);
+    for (auto const i : bounded)
+        for_each_cell(lights_[i], [&](std::size_t cell) { cell_lights_[fill[cell]++] = i; });
+}
+
+std::span<PointLight const> LightGrid::lights() const { return lights_; }
+
+std::span<std::uint32_t const> LightGrid::unbounded() const { return unbounded_; }
+
+std::span<std::uint32_t const> LightGrid::nearby(Point3d const& point) const {
+    // Points outside of the grid are out of reach of every finite light.
+    for (std::size_t axis{}; axis < 3; ++axis) {
+        auto const relative = (point[axis] - origin_[axis]) * inverse_cell_size_;
+        if (relative < 0. || relative >= double(cell_count_[axis]))
+            return {};
+    }
+    auto const cell = cell_index(cell_of(point));
+    return std::span{cell_lights_}.subspan(cell_offsets_[cell],
+                                           cell_offsets_[cell + 1] - cell_offsets_[cell]);
+}
+
+// Cell containing the point, clamped to the grid.
+std::array<std::size_t, 3> LightGrid::cell_of(Point3d const& point) const {
+    std::array<std::size_t, 3> cell{};
+    for (std::size_t axis{}; axis < 3; ++axis) {
+        auto const relative = std::floor((point[axis] - origin_[axis]) * inverse_cell_size_);
+        cell[axis] = std::size_t(std::clamp(relative, 0., double(cell_count_[axis] - 1)));
+    }
+    return cell;
+}
+
+std::size_t LightGrid::cell_index(std::array<std::size_t, 3> const& cell) const {
+    return (cell[2] * cell_count_[1] + cell[1]) * cell_count_[0] + cell[0];
+}
+
+} // namespace cherry_blazer
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "point.hh"
+#include "point_light.hh"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace cherry_blazer {
+
+// LightGrid is a uniform grid over the spheres of influence of the lights (see PointLight::radius),
+// so that shading a point only visits the lights which can reach it, rather than every light of the
+// scene. Every cell lists the lights whose influence overlaps it. Lights with infinite radius reach
+// everywhere and are kept in a separate list.
+class LightGrid {
+  public:
+    // Pick the cell size from the average diameter of the lights' influence.
+    explicit LightGrid(std::vector<PointLight> lights);
+    LightGrid(std::vector<PointLight> lights, double cell_size);
+
+    [[nodiscard]] std::span<PointLight const> lights() const;
+
+    // Indices (into lights()) of the lights which reach everywhere.
+    [[nodiscard]] std::span<std::uint32_t const> unbounded() const;
+
+    // Indices (into lights()) of the finite lights which may reach the point. Some of them can
+    // still be farther than their radius, the grid is only as precise as its cells.
+    [[nodiscard]] std::span<std::uint32_t const> nearby(Point3d const& point) const;
+
+  private:
+    std::vector<PointLight> lights_;
+    std::vector<std::uint32_t> unbounded_;
+
+    // Cells are stored compactly: lights of cell i are cell_lights_[cell_offsets_[i]] up to
+    // cell_lights_[cell_offsets_[i + 1]].
+    std::vector<std::uint32_t> cell_offsets_;
+    std::vector<std::uint32_t> cell_lights_;
+
+    Point3d origin_;
+    double inverse_cell_size_{};
+    std::array<std::size_t, 3> cell_count_{};
+
+    [[nodiscard]] std::array<std::size_t, 3> cell_of(Point3d const& point) const;
+    [[nodiscard]] std::size_t cell_index(std::array<std::size_t, 3> const& cell) const;
+};
+
+} // namespace cherry_blazer
@@ -1,47 +1,146 @@
 #include "lighting.hh"
 
+#include "detail/detail.hh"
+#include "detail/fast_pow.hh"
 #include "reflect.hh"
 #include "vector_operations.hh"
 
 #include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
 
 namespace cherry_blazer {
 
-Color lighting(Material const& material, PointLight const& light, Point3d const& point,
-               Vec3d const& eye_vector, Vec3d const& normal_vector) {
-    // combine the surface color with the light's color/intensity
-    auto effective_color = material.color * light.intensity;
+namespace {
+
+double specular_exponent(double cosine, double shininess, SpecularQuality quality) {
+    switch (quality) {
+    case SpecularQuality::Exact:
+        return std::pow(cosine, shininess);
+    case SpecularQuality::Fast:
+        if (detail::is_small_integral(shininess))
+            return detail::ipow(cosine, static_cast<std::uint32_t>(shininess));
+        return std::pow(cosine, shininess);
+    case SpecularQuality::Approximate:
+        return detail::approx_pow(cosine, shininess);
+    }
+    detail::unreachable("SpecularQuality: non-exhaustive switch");
+}
+
+// Smooth window which fades the light to zero at its radius, and is 1 for lights without radius.
+double attenuation(PointLight const& light, double distance_squared) {
+    if (std::isinf(light.radius))
+        return 1.;
+    auto const ratio = distance_squared / (light.radius * light.radius);
+    if (ratio >= 1.)
+        return 0.;
+    auto const window = 1. - ratio * ratio;
+    return window * window;
+}
+
+// Add the contribution of a single light to result.
+void accumulate(Color& result, Material const& material, PointLight const& light,
+                Point3d const& point, Vec3d const& eye_vector, Vec3d const& normal_vector,
+                bool in_shadow, SpecularQuality quality) {
+    auto const to_light = light.position - point;
+    auto const distance_squared = dot(to_light, to_light);
+
+    // cull lights which don't reach the point, before doing anything else
+    auto const falloff = attenuation(light, distance_squared);
+    if (falloff == 0.)
+        return;
+
+    // combine the surface color with the light's color/intensity (materialized, because it is used
+    // twice below)
+    Color const effective_color = material.color * light.intensity * falloff;
 
     // find the direction of the light source
-    auto light_vector = normalize(light.position - point);
+    auto const light_vector = to_light / std::sqrt(distance_squared);
 
-    // compute the ambient contribution
-    auto ambient = effective_color * material.ambient;
+    // compute the ambient contribution (an expression, evaluated together with the sum below)
+    auto const ambient = effective_color * material.ambient;
 
     // light_dot_normal represents the cosine of the angle between the light vector and the normal
     // vector. A negative number means the light is on the other side of the surface.
-    auto light_dot_normal = dot(light_vector, normal_vector);
+    auto const light_dot_normal = dot(light_vector, normal_vector);
 
-    Color diffuse{};  // black
-    Color specular{}; // black
+    // cull diffuse and specular work of lights blocked by an object or behind the surface
+    if (in_shadow || light_dot_normal < 0.) {
+        result += ambient;
+        return;
+    }
 
-    if (light_dot_normal >= 0.) {
-        // compute diffuse contribution
-        diffuse = effective_color * material.diffuse * light_dot_normal;
+    // compute diffuse contribution
+    auto const diffuse = effective_color * material.diffuse * light_dot_normal;
 
-        // reflect_dot_eye represents the cosine of the angle between the reflection vector and the
-        // eye vector. A negative number means the light reflects away from the eye.
-        auto reflect_vector = reflect(-light_vector, normal_vector);
-        auto reflect_dot_eye = dot(reflect_vector, eye_vector);
+    // reflect_dot_eye represents the cosine of the angle between the reflection vector and the
+    // eye vector. A negative number means the light reflects away from the eye.
+    auto const reflect_vector = reflect(-light_vector, normal_vector);
+    auto const reflect_dot_eye = dot(reflect_vector, eye_vector);
 
-        if (reflect_dot_eye > 0.) {
-            // compute specular contribution
-            specular =
-                light.intensity * material.specular * std::pow(reflect_dot_eye, material.shininess);
-        }
+    if (reflect_dot_eye <= 0.) {
+        result += ambient + diffuse;
+        return;
     }
 
-    return ambient + diffuse + specular;
+    // compute specular contribution
+    auto const specular = light.intensity * falloff * material.specular *
+                          specular_exponent(reflect_dot_eye, material.shininess, quality);
+
+    // Single pass over the components, no intermediate Colors.
+    result += ambient + diffuse + specular;
+}
+
+} // namespace
+
+Color lighting(Material const& material, PointLight const& light, Point3d const& point,
+               Vec3d const& eye_vector, Vec3d const& normal_vector, SpecularQuality quality) {
+    Color result{}; // black
+    accumulate(result, material, light, point, eye_vector, normal_vector, false, quality);
+    return result;
+}
+
+Color lighting(Material const& material, PointLight const& light, Point3d const& point,
+               Vec3d const& eye_vector, Vec3d const& normal_vector, bool in_shadow,
+               SpecularQuality quality) {
+    Color result{}; // black
+    accumulate(result, material, light, point, eye_vector, normal_vector, in_shadow, quality);
+    return result;
+}
+
+Color lighting(Material const& material, std::span<PointLight const> lights, Point3d const& point,
+               Vec3d const& eye_vector, Vec3d const& normal_vector, SpecularQuality quality) {
+    Color result{}; // black
+    for (auto const& light : lights)
+        accumulate(result, material, light, point, eye_vector, normal_vector, false, quality);
+    return result;
+}
+
+Color lighting(Material const& material, std::span<PointLight const> lights, Point3d const& point,
+               Vec3d const& eye_vector, Vec3d const& normal_vector,
+               std::span<bool const> in_shadow, SpecularQuality quality) {
+    if (in_shadow.size() != lights.size())
+        throw std::logic_error{"lighting: need one shadow flag per light"};
+
+    Color result{}; // black
+    for (std::size_t i = 0; i < lights.size(); ++i)
+        accumulate(result, material, lights[i], point, eye_vector, normal_vector, in_shadow[i],
+                   quality);
+    return result;
+}
+
+Color lighting(Material const& material, LightGrid const& lights, Point3d const& point,
+               Vec3d const& eye_vector, Vec3d const& normal_vector, SpecularQuality quality) {
+    Color result{}; // black
+    auto const all_lights = lights.lights();
+    for (auto const i : lights.unbounded())
+        accumulate(result, material, all_lights[i], point, eye_vector, normal_vector, false,
+                   quality);
+    for (auto const i : lights.nearby(point))
+        accumulate(result, material, all_lights[i], point, eye_vector, normal_vector, false,
+                   quality);
+    return result;
 }
 
 } // namespace cherry_blazer
@@ -1,14 +1,54 @@
 #pragma once
 
 #include "color.hh"
+#include "light_grid.hh"
 #include "material.hh"
 #include "point.hh"
 #include "point_light.hh"
 #include "vector.hh"
 
+#include <span>
+
 namespace cherry_blazer {
 
+// How the specular highlight, cos^shininess, is computed. The exponent is the most expensive
+// operation of the shading, so a render can trade accuracy for speed here.
+enum class SpecularQuality {
+    // std::pow.
+    Exact,
+    // Exponentiation by squaring when shininess is a whole number (the usual case), otherwise
+    // std::pow. Same result as Exact up to rounding.
+    Fast,
+    // exp2(shininess * log2(cos)) through polynomial approximations, for any shininess. Relative
+    // error stays below 1e-6 for shininess up to 1000, which is invisible in an 8-bit image.
+    Approximate
+};
+
+Color lighting(Material const& material, PointLight const& light, Point3d const& point,
+               Vec3d const& eye_vector, Vec3d const& normal_vector,
+               SpecularQuality quality = SpecularQuality::Exact);
+
+// A point in shadow is only lit by the ambient part of the light.
 Color lighting(Material const& material, PointLight const& light, Point3d const& point,
-               Vec3d const& eye_vector, Vec3d const& normal_vector);
+               Vec3d const& eye_vector, Vec3d const& normal_vector, bool in_shadow,
+               SpecularQuality quality = SpecularQuality::Exact);
+
+// Sum of the contributions of all the lights. Lights out of reach of the point (see
+// PointLight::radius) are skipped before any other work, and lights behind the surface only
+// contribute their ambient part.
+Color lighting(Material const& material, std::span<PointLight const> lights, Point3d const& point,
+               Vec3d const& eye_vector, Vec3d const& normal_vector,
+               SpecularQuality quality = SpecularQuality::Exact);
+
+// Same as above, but in_shadow[i] tells whether lights[i] is blocked (see World::shadows()).
+Color lighting(Material const& material, std::span<PointLight const> lights, Point3d const& point,
+               Vec3d const& eye_vector, Vec3d const& normal_vector,
+               std::span<bool const> in_shadow, SpecularQuality quality = SpecularQuality::Exact);
+
+// Same as the light span overload without shadows, but only visits the lights which the grid finds
+// near the point, so the cost depends on the number of nearby lights rather than of all lights.
+Color lighting(Material const& material, LightGrid const& lights, Point3d const& point,
+               Vec3d const& eye_vector, Vec3d const& normal_vector,
+               SpecularQuality quality = SpecularQuality::Exact);
 
 } // namespace cherry_blazer
@@ -0,0 +1,49 @@
+#include "detail/mapped_file.hh"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <string>
+#include <system_error>
+
+namespace cherry_blazer::detail {
+
+MappedFile::MappedFile(std::filesystem::path const& path) {
+    auto const fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        throw std::system_error(errno, std::system_category(),
+                                "failed to open '" + path.string() + "'");
+    }
+    struct stat status {};
+    if (::fstat(fd, &status) != 0) {
+        auto const error = errno;
+        ::close(fd);
+        throw std::system_error(error, std::system_category(),
+                                "failed to stat '" + path.string() + "'");
+    }
+    size_ = static_cast<std::size_t>(status.st_size);
+    if (size_ == 0) { // mmap() refuses empty mappings
+        ::close(fd);
+        return;
+    }
+    auto* const mapping = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    auto const error = errno;
+    ::close(fd); // the mapping keeps the file
+    if (mapping == MAP_FAILED) { // NOLINT(cppcoreguidelines-pro-type-cstyle-cast)
+        throw std::system_error(error, std::system_category(),
+                                "failed to map '" + path.string() + "'");
+    }
+    data_ = static_cast<char const*>(mapping);
+    // All of it is read, so have it read ahead.
+    ::madvise(mapping, size_, MADV_WILLNEED);
+}
+
+MappedFile::~MappedFile() {
+    if (data_ != nullptr)
+        ::munmap(const_cast<char*>(data_), size_); // NOLINT(*-const-cast)
+}
+
+} // namespace cherry_blazer::detail
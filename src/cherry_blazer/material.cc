@@ -5,8 +5,10 @@
 namespace cherry_blazer {
 
 bool operator==(Material const& lhs, Material const& rhs) {
-    return std::tie(lhs.color, lhs.ambient, lhs.diffuse, lhs.specular, lhs.shininess) ==
-           std::tie(rhs.color, rhs.ambient, rhs.diffuse, rhs.specular, rhs.shininess);
+    return std::tie(lhs.color, lhs.ambient, lhs.diffuse, lhs.specular, lhs.shininess,
+                    lhs.reflective, lhs.transparency, lhs.refractive_index) ==
+           std::tie(rhs.color, rhs.ambient, rhs.diffuse, rhs.specular, rhs.shininess,
+                    rhs.reflective, rhs.transparency, rhs.refractive_index);
 }
 
 } // namespace cherry_blazer
@@ -12,6 +12,12 @@ struct Material {
     double diffuse{.9};
     double specular{.9};
     double shininess{200.};
+    // Fraction of the light reflected like a mirror, 0 for none.
+    double reflective{0.};
+    // Fraction of the light let through, and how much it bends on the way (1 for vacuum, 1.5 for
+    // glass).
+    double transparency{0.};
+    double refractive_index{1.};
 };
 
 bool operator==(Material const& lhs, Material const& rhs);
@@ -0,0 +1,81 @@
+#include "mesh.hh"
+
+#include "parallel.hh"
+#include "vector_operations.hh"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+namespace cherry_blazer {
+
+namespace {
+
+// Triangle bounds are computed in chunks of this many triangles.
+constexpr std::size_t grain = 4096;
+
+} // namespace
+
+Mesh::Mesh(std::vector<double> x, std::vector<double> y, std::vector<double> z,
+           std::vector<std::uint32_t> indices)
+    : x_{std::move(x)}, y_{std::move(y)}, z_{std::move(z)}, indices_{std::move(indices)} {
+    if (x_.size() != y_.size() || x_.size() != z_.size())
+        throw std::logic_error{"Mesh: coordinate arrays differ in size"};
+    if (indices_.size() % 3 != 0)
+        throw std::logic_error{"Mesh: indices are not triples"};
+
+    std::vector<Aabb> boxes(triangle_count());
+    parallel_for(boxes.size(), grain, [this, &boxes](std::size_t begin, std::size_t end) {
+        for (auto triangle = begin; triangle < end; ++triangle) {
+            auto& box = boxes[triangle];
+            for (std::size_t corner = 0; corner < 3; ++corner) {
+                auto const index = indices_[3 * triangle + corner];
+                if (index >= x_.size())
+                    throw std::logic_error{"Mesh: vertex index out of range"};
+                auto const point = position(index);
+                for (std::size_t axis = 0; axis < 3; ++axis) {
+                    box.min[axis] = std::min(box.min[axis], point[axis]);
+                    box.max[axis] = std::max(box.max[axis], point[axis]);
+                }
+            }
+        }
+    });
+    bvh_ = Bvh{boxes};
+}
+
+Vec3d Mesh::normal(std::uint32_t triangle) const noexcept {
+    auto const a = vertex(indices_[3 * triangle]);
+    auto const b = vertex(indices_[3 * triangle + 1]);
+    auto const c = vertex(indices_[3 * triangle + 2]);
+    return normalize(cross(b - a, c - a));
+}
+
+std::optional<std::pair<TriangleHit, std::uint32_t>> Mesh::closest_hit(Ray const& ray,
+                                                                       double max_t) const {
+    std::optional<std::pair<TriangleHit, std::uint32_t>> closest;
+    bvh_.traverse(ray, max_t, [&](std::uint32_t triangle, double& closest_t) {
+        auto const* const corners = &indices_[3 * std::size_t{triangle}];
+        if (auto const hit = intersect_triangle(position(corners[0]), position(corners[1]),
+                                                position(corners[2]), ray, 0., closest_t)) {
+            closest_t = hit->t;
+            closest = {*hit, triangle};
+        }
+        return false;
+    });
+    return closest;
+}
+
+bool Mesh::occluded(Ray const& ray, double max_t) const {
+    auto found = false;
+    bvh_.traverse(ray, max_t, [&](std::uint32_t triangle, double& /*max_t*/) {
+        auto const* const corners = &indices_[3 * std::size_t{triangle}];
+        auto const hit = intersect_triangle(position(corners[0]), position(corners[1]),
+                                            position(corners[2]), ray, 0., max_t);
+        found = hit && hit->t > 0. && hit->t < max_t;
+        return found;
+    });
+    return found;
+}
+
+} // namespace cherry_blazer
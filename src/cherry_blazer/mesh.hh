@@ -0,0 +1,117 @@
+#pragma once
+
+#include "bvh.hh"
+#include "material.hh"
+#include "point.hh"
+#include "ray.hh"
+#include "vector.hh"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace cherry_blazer {
+
+// Where a ray crosses a triangle: the ray parameter, and the barycentric coordinates of the point
+// (weights of the second and third vertices).
+struct TriangleHit {
+    double t;
+    double u;
+    double v;
+};
+
+// Möller–Trumbore: the crossing of the ray with triangle (a, b, c), if it lies in [min_t;max_t].
+// Rays in the plane of the triangle miss it.
+[[nodiscard]] inline std::optional<TriangleHit>
+intersect_triangle(std::array<double, 3> const& a, std::array<double, 3> const& b,
+                   std::array<double, 3> const& c, Ray const& ray, double min_t,
+                   double max_t) noexcept {
+    std::array<double, 3> const edge1{b[0] - a[0], b[1] - a[1], b[2] - a[2]};
+    std::array<double, 3> const edge2{c[0] - a[0], c[1] - a[1], c[2] - a[2]};
+    auto const& d = ray.direction;
+    // p = direction x edge2
+    std::array<double, 3> const p{d[1] * edge2[2] - d[2] * edge2[1],
+                                  d[2] * edge2[0] - d[0] * edge2[2],
+                                  d[0] * edge2[1] - d[1] * edge2[0]};
+    auto const determinant = edge1[0] * p[0] + edge1[1] * p[1] + edge1[2] * p[2];
+    if (determinant == 0.)
+        return std::nullopt;
+    auto const inverse = 1. / determinant;
+
+    std::array<double, 3> const s{ray.origin[0] - a[0], ray.origin[1] - a[1], ray.origin[2] - a[2]};
+    auto const u = (s[0] * p[0] + s[1] * p[1] + s[2] * p[2]) * inverse;
+    if (u < 0. || u > 1.)
+        return std::nullopt;
+
+    // q = s x edge1
+    std::array<double, 3> const q{s[1] * edge1[2] - s[2] * edge1[1],
+                                  s[2] * edge1[0] - s[0] * edge1[2],
+                                  s[0] * edge1[1] - s[1] * edge1[0]};
+    auto const v = (d[0] * q[0] + d[1] * q[1] + d[2] * q[2]) * inverse;
+    if (v < 0. || u + v > 1.)
+        return std::nullopt;
+
+    auto const t = (edge2[0] * q[0] + edge2[1] * q[1] + edge2[2] * q[2]) * inverse;
+    if (t < min_t || t > max_t)
+        return std::nullopt;
+    return TriangleHit{t, u, v};
+}
+
+// Triangle mesh in world space. The vertex positions are stored as three arrays of coordinates
+// (structure of arrays) and each triangle as three indices into them, so shared vertices are
+// stored once. The mesh has its own Bvh over its triangles, and a single material; its faces are
+// shaded flat.
+class Mesh {
+  public:
+    Mesh() = default;
+    // Takes vertex i at (x[i], y[i], z[i]) and triangle j as vertices indices[3j..3j+2], counter-
+    // clockwise seen from the front. Builds the Bvh in parallel. Throws std::logic_error if the
+    // coordinate arrays differ in size, the indices are not triples, or an index is out of range.
+    Mesh(std::vector<double> x, std::vector<double> y, std::vector<double> z,
+         std::vector<std::uint32_t> indices);
+
+    Material material;
+
+    [[nodiscard]] std::size_t vertex_count() const noexcept { return x_.size(); }
+    [[nodiscard]] std::size_t triangle_count() const noexcept { return indices_.size() / 3; }
+
+    [[nodiscard]] std::span<double const> x() const noexcept { return x_; }
+    [[nodiscard]] std::span<double const> y() const noexcept { return y_; }
+    [[nodiscard]] std::span<double const> z() const noexcept { return z_; }
+    [[nodiscard]] std::span<std::uint32_t const> indices() const noexcept { return indices_; }
+
+    [[nodiscard]] Point3d vertex(std::uint32_t index) const noexcept {
+        return Point3d{x_[index], y_[index], z_[index]};
+    }
+
+    // Unit normal of a triangle, on the side from which its vertices run counterclockwise.
+    [[nodiscard]] Vec3d normal(std::uint32_t triangle) const noexcept;
+
+    [[nodiscard]] Bvh const& bvh() const noexcept { return bvh_; }
+
+    // Nearest crossing of the ray with a triangle in [0;max_t], with the triangle, if any.
+    [[nodiscard]] std::optional<std::pair<TriangleHit, std::uint32_t>>
+    closest_hit(Ray const& ray, double max_t) const;
+    // Whether any triangle crosses the ray in ]0;max_t[.
+    [[nodiscard]] bool occluded(Ray const& ray, double max_t) const;
+
+  private:
+    std::vector<double> x_;
+    std::vector<double> y_;
+    std::vector<double> z_;
+    std::vector<std::uint32_t> indices_;
+    Bvh bvh_;
+
+    [[nodiscard]] std::array<double, 3> position(std::uint32_t index) const noexcept {
+        return {x_[index], y_[index], z_[index]};
+    }
+};
+
+// Smallest box around the mesh.
+[[nodiscard]] inline Aabb bounds(Mesh const& mesh) noexcept { return mesh.bvh().root_bounds(); }
+
+} // namespace cherry_blazer
@@ -1,24 +1,64 @@
 #pragma once
 
-#include "coord.hh"
-#include "matrix_operations.hh"
 #include "point.hh"
-#include "point_operations.hh"
 #include "sphere.hh"
+#include "transformation.hh"
 #include "vector.hh"
 
+#include <cmath>
+#include <cstddef>
+#include <span>
+#include <stdexcept>
+
 namespace cherry_blazer {
 
-template <typename Precision, std::size_t Dimension>
-auto normal(Sphere const& sphere, Point<Precision, Dimension> const& at_world_point) {
-    auto const inverted_transformation_matrix = inverse(sphere.transformation.mat);
+// An object space normal in world space, with w = 0 and unit length. Normals go back to world
+// space through the inverse-transpose, which Transformation caches, so there is no inversion here.
+// Only its upper 3x3 part takes part: the rest would only affect w, which is 0 for a normal.
+[[nodiscard]] inline Vec3d normal_to_world(Transformation const& transformation,
+                                           Vec3d const& object_normal) noexcept {
+    auto const& inv_transpose = transformation.inv_transpose;
+    double world_normal[3];
+    for (std::size_t row{}; row < 3; ++row) {
+        world_normal[row] = inv_transpose(row, 0) * object_normal[0] +
+                            inv_transpose(row, 1) * object_normal[1] +
+                            inv_transpose(row, 2) * object_normal[2];
+    }
+
+    auto const inverse_length =
+        1. / std::sqrt(world_normal[0] * world_normal[0] + world_normal[1] * world_normal[1] +
+                       world_normal[2] * world_normal[2]);
+    return Vec3d{world_normal[0] * inverse_length, world_normal[1] * inverse_length,
+                 world_normal[2] * inverse_length};
+}
+
+// The world point in the object space of transformation, as the inverse Transformation caches.
+[[nodiscard]] inline Point3d to_object_space(Transformation const& transformation,
+                                             Point3d const& world_point) noexcept {
+    auto const& inv = transformation.inv;
+    double object_point[3];
+    for (std::size_t row{}; row < 3; ++row) {
+        object_point[row] = inv(row, 0) * world_point[0] + inv(row, 1) * world_point[1] +
+                            inv(row, 2) * world_point[2] + inv(row, 3);
+    }
+    return Point3d{object_point[0], object_point[1], object_point[2]};
+}
 
-    auto const object_point = inverted_transformation_matrix * at_world_point;
-    auto const world_normal =
-        transpose(inverted_transformation_matrix) * object_point - Point{0., 0., 0.};
-    //    world_normal[Coord::W] = static_cast<Precision>(0);
+// Normal of the sphere at a point on its surface, in world space, with w = 0 and unit length.
+// The normal of the unit sphere at an object space point is the point itself (minus the origin).
+[[nodiscard]] inline Vec3d normal(Sphere const& sphere, Point3d const& at_world_point) noexcept {
+    auto const object_point = to_object_space(sphere.transformation, at_world_point);
+    return normal_to_world(sphere.transformation,
+                           Vec3d{object_point[0], object_point[1], object_point[2]});
+}
 
-    return normalize(world_normal);
+// Normals of the sphere at many points at once: out[i] is the normal at points[i].
+// Throws std::logic_error if the spans differ in size.
+inline void normals(Sphere const& sphere, std::span<Point3d const> points, std::span<Vec3d> out) {
+    if (points.size() != out.size())
+        throw std::logic_error{"normals: need one output per point"};
+    for (std::size_t i = 0; i < points.size(); ++i)
+        out[i] = normal(sphere, points[i]);
 }
 
 } // namespace cherry_blazer
@@ -0,0 +1,189 @@
+#include "obj.hh"
+
+#include "detail/mapped_file.hh"
+#include "detail/parse_number.hh"
+#include "parallel.hh"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace cherry_blazer {
+
+namespace {
+
+// Chunks are about this many bytes, cut at line ends.
+constexpr std::size_t chunk_size = std::size_t{1} << 20U;
+
+struct Chunk {
+    std::string_view text;
+    // First counted, then turned into the numbers in the chunks before this one.
+    std::size_t lines{0};
+    std::size_t vertices{0};
+    std::size_t triangles{0};
+};
+
+std::vector<Chunk> split(std::string_view text) {
+    std::vector<Chunk> chunks;
+    std::size_t begin = 0;
+    while (begin < text.size()) {
+        auto end = std::min(begin + chunk_size, text.size());
+        if (end < text.size()) {
+            auto const line_end = text.find('\n', end);
+            end = line_end == std::string_view::npos ? text.size() : line_end + 1;
+        }
+        chunks.push_back({text.substr(begin, end - begin)});
+        begin = end;
+    }
+    return chunks;
+}
+
+bool is_space(char c) noexcept {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+// Calls line(text) for every line of the chunk, without its end and comment.
+template <typename Line> void for_each_line(std::string_view chunk, Line const& line) {
+    while (!chunk.empty()) {
+        auto const end = chunk.find('\n');
+        auto current = chunk.substr(0, end);
+        chunk.remove_prefix(end == std::string_view::npos ? chunk.size() : end + 1);
+        if (auto const comment = current.find('#'); comment != std::string_view::npos)
+            current = current.substr(0, comment);
+        line(current);
+    }
+}
+
+// The next word of the line, removed from it. Empty at the end of the line.
+std::string_view next_word(std::string_view& line) noexcept {
+    std::size_t begin = 0;
+    while (begin < line.size() && is_space(line[begin]))
+        ++begin;
+    auto end = begin;
+    while (end < line.size() && !is_space(line[end]))
+        ++end;
+    auto const word = line.substr(begin, end - begin);
+    line.remove_prefix(end);
+    return word;
+}
+
+std::size_t count_words(std::string_view line) noexcept {
+    std::size_t count = 0;
+    while (!next_word(line).empty())
+        ++count;
+    return count;
+}
+
+void count(Chunk& chunk) {
+    for_each_line(chunk.text, [&chunk](std::string_view line) {
+        ++chunk.lines;
+        auto const keyword = next_word(line);
+        if (keyword == "v") {
+            ++chunk.vertices;
+        } else if (keyword == "f") {
+            // Faces of fewer than three vertices are reported by the second pass.
+            auto const corners = count_words(line);
+            chunk.triangles += corners >= 3 ? corners - 2 : 0;
+        }
+    });
+}
+
+// Where the second pass writes.
+struct Output {
+    std::vector<double>& x;
+    std::vector<double>& y;
+    std::vector<double>& z;
+    std::vector<std::uint32_t>& indices;
+};
+
+// Index into the mesh vertices of a face corner, given the number of vertices before its line.
+std::uint32_t vertex_index(std::string_view corner, std::size_t preceding, std::size_t total) {
+    auto const position = corner.substr(0, corner.find('/'));
+    auto const index = detail::to_integer<std::int64_t>(position);
+    auto resolved = std::int64_t{-1};
+    if (index > 0)
+        resolved = index - 1;
+    else if (index < 0)
+        resolved = static_cast<std::int64_t>(preceding) + index;
+    if (resolved < 0 || static_cast<std::uint64_t>(resolved) >= total)
+        throw std::logic_error{"no vertex " + std::string{position}};
+    return static_cast<std::uint32_t>(resolved);
+}
+
+void parse(Chunk const& chunk, std::size_t total_vertices, Output const& out) {
+    auto line_number = chunk.lines;
+    auto vertex = chunk.vertices;
+    auto index = 3 * chunk.triangles;
+    for_each_line(chunk.text, [&](std::string_view line) {
+        ++line_number;
+        try {
+            auto const keyword = next_word(line);
+            if (keyword == "v") {
+                out.x[vertex] = detail::to_double(next_word(line));
+                out.y[vertex] = detail::to_double(next_word(line));
+                out.z[vertex] = detail::to_double(next_word(line));
+                ++vertex;
+            } else if (keyword == "f") {
+                auto const first_word = next_word(line);
+                auto const second_word = next_word(line);
+                auto word = next_word(line);
+                if (word.empty())
+                    throw std::logic_error{"face of fewer than three vertices"};
+                auto const first = vertex_index(first_word, vertex, total_vertices);
+                auto previous = vertex_index(second_word, vertex, total_vertices);
+                for (; !word.empty(); word = next_word(line)) {
+                    auto const current = vertex_index(word, vertex, total_vertices);
+                    out.indices[index++] = first;
+                    out.indices[index++] = previous;
+                    out.indices[index++] = current;
+                    previous = current;
+                }
+            }
+        } catch (std::logic_error const& e) {
+            throw std::logic_error{"line " + std::to_string(line_number) + ": " + e.what()};
+        }
+    });
+}
+
+} // namespace
+
+Mesh parse_obj(std::string_view text) {
+    auto chunks = split(text);
+    parallel_for(chunks.size(), 1, [&chunks](std::size_t begin, std::size_t end) {
+        for (auto i = begin; i < end; ++i)
+            count(chunks[i]);
+    });
+
+    Chunk totals;
+    for (auto& chunk : chunks) {
+        totals.lines += std::exchange(chunk.lines, totals.lines);
+        totals.vertices += std::exchange(chunk.vertices, totals.vertices);
+        totals.triangles += std::exchange(chunk.triangles, totals.triangles);
+    }
+    if (totals.vertices > std::numeric_limits<std::uint32_t>::max())
+        throw std::logic_error{"parse_obj: more vertices than 32-bit indices can address"};
+
+    std::vector<double> x(totals.vertices);
+    std::vector<double> y(totals.vertices);
+    std::vector<double> z(totals.vertices);
+    std::vector<std::uint32_t> indices(3 * totals.triangles);
+    Output const out{x, y, z, indices};
+    parallel_for(chunks.size(), 1, [&](std::size_t begin, std::size_t end) {
+        for (auto i = begin; i < end; ++i)
+            parse(chunks[i], totals.vertices, out);
+    });
+
+    return {std::move(x), std::move(y), std::move(z), std::move(indices)};
+}
+
+Mesh load_obj(std::filesystem::path const& path) {
+    detail::MappedFile const file{path};
+    return parse_obj(file.text());
+}
+
+} // namespace cherry_blazer
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "mesh.hh"
+
+#include <filesystem>
+#include <string_view>
+
+namespace cherry_blazer {
+
+// Wavefront OBJ meshes. Of the statements, only vertex positions and faces are read:
+//
+//   v <x> <y> <z> [<w>]
+//   f <v1> <v2> <v3> ...        (each as v, v/vt, v//vn or v/vt/vn)
+//
+// Vertex indices start at 1, negative ones count back from the last vertex read. Faces of more
+// than three vertices are split into triangles around their first vertex. Everything else
+// (normals, texture coordinates, groups, materials, "#" comments) is skipped.
+
+// Reads a mesh from OBJ text. The text is read in place, without copying lines or words, in
+// chunks parsed in parallel: a first pass counts the vertices and triangles of each chunk, so
+// the second writes them straight to where they belong in the mesh. Throws std::logic_error,
+// naming the line, if the text is malformed or refers to vertices which don't exist.
+[[nodiscard]] Mesh parse_obj(std::string_view text);
+
+// Same, from a file, which is mapped into memory rather than read. Throws std::system_error if it
+// cannot be opened or mapped.
+[[nodiscard]] Mesh load_obj(std::filesystem::path const& path);
+
+} // namespace cherry_blazer
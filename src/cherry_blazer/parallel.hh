@@ -0,0 +1,100 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+namespace cherry_blazer {
+
+// How many threads parallel_for() runs on: one per hardware thread.
+[[nodiscard]] inline unsigned worker_count() noexcept {
+    auto const count = std::thread::hardware_concurrency();
+    return count == 0 ? 1 : count;
+}
+
+// Calls body(begin, end) for consecutive chunks [begin;end) of [0;count), each at most grain long,
+// on up to worker_count() threads including the calling one. Threads take the next chunk as soon
+// as they are done with the previous one, so uneven chunks balance out. Returns when all chunks
+// are done. If body throws, the remaining chunks are skipped and the first exception is rethrown.
+template <typename Body> void parallel_for(std::size_t count, std::size_t grain, Body const& body) {
+    grain = std::max(grain, std::size_t{1});
+    auto const chunks = count / grain + (count % grain != 0 ? 1 : 0);
+    auto const thread_count = std::min<std::size_t>(worker_count(), chunks);
+
+    std::atomic<std::size_t> next_chunk{0};
+    std::exception_ptr error;
+    std::mutex error_mutex;
+    auto const work = [&] {
+        try {
+            for (;;) {
+                auto const chunk = next_chunk.fetch_add(1, std::memory_order_relaxed);
+                if (chunk >= chunks)
+                    return;
+                auto const begin = chunk * grain;
+                body(begin, std::min(begin + grain, count));
+            }
+        } catch (...) {
+            std::scoped_lock const lock{error_mutex};
+            if (!error)
+                error = std::current_exception();
+            next_chunk.store(chunks, std::memory_order_relaxed);
+        }
+    };
+
+    std::vector<std::thread> workers;
+    workers.reserve(thread_count > 0 ? thread_count - 1 : 0);
+    try {
+        while (workers.size() + 1 < thread_count)
+            workers.emplace_back(work);
+    } catch (std::system_error const&) {
+        // Out of threads: the ones already running and this one do all the chunks.
+    }
+    work();
+    for (auto& worker : workers)
+        worker.join();
+
+    if (error)
+        std::rethrow_exception(error);
+}
+
+// Runs first on a new thread and second on the calling one, and returns when both are done.
+// If either throws, the exception is rethrown (first's if both do).
+template <typename First, typename Second>
+void parallel_invoke(First const& first, Second const& second) {
+    std::exception_ptr first_error;
+    std::thread thread;
+    try {
+        thread = std::thread{[&] {
+            try {
+                first();
+            } catch (...) {
+                first_error = std::current_exception();
+            }
+        }};
+    } catch (std::system_error const&) {
+        // Out of threads: run both here.
+        first();
+        second();
+        return;
+    }
+
+    std::exception_ptr second_error;
+    try {
+        second();
+    } catch (...) {
+        second_error = std::current_exception();
+    }
+    thread.join();
+
+    if (first_error)
+        std::rethrow_exception(first_error);
+    if (second_error)
+        std::rethrow_exception(second_error);
+}
+
+} // namespace cherry_blazer
@@ -0,0 +1,151 @@
+#include "path_tracer.hh"
+
+#include "parallel.hh"
+#include "reflect.hh"
+#include "vector_operations.hh"
+
+#include <boost/container/small_vector.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <numbers>
+#include <span>
+#include <stdexcept>
+
+namespace cherry_blazer {
+
+namespace {
+
+// The random numbers of a sample: the first block places it in the pixel, and block 1 + b drives
+// bounce b (which way to scatter, two for the direction, and Russian roulette).
+constexpr std::uint32_t pixel_block = 0;
+
+// Unit vector around the unit normal, with a density proportional to the cosine between them.
+// Malley's method: a uniform point of the unit disk, lifted onto the hemisphere. The disk is
+// spanned by a basis built without branches from the normal alone.
+// T. Duff et al., "Building an orthonormal basis, revisited", JCGT 6(1), 2017.
+Vec3d cosine_direction(Vec3d const& normal, double u1, double u2) {
+    auto const sign = std::copysign(1., normal[2]);
+    auto const a = -1. / (sign + normal[2]);
+    auto const b = normal[0] * normal[1] * a;
+    Vec3d const tangent{1. + sign * normal[0] * normal[0] * a, sign * b, -sign * normal[0]};
+    Vec3d const bitangent{b, sign + normal[1] * normal[1] * a, -normal[1]};
+
+    auto const radius = std::sqrt(u1);
+    auto const angle = 2. * std::numbers::pi * u2;
+    return tangent * (radius * std::cos(angle)) + bitangent * (radius * std::sin(angle)) +
+           normal * std::sqrt(1. - u1);
+}
+
+} // namespace
+
+Color trace_path(World const& world, Ray const& ray, SampleRandom const& random,
+                 PathTracing const& settings) {
+    // Scenes rarely have more than a handful of lights, so the flags usually stay on the stack.
+    boost::container::small_vector<bool, 8> in_shadow(world.lights().size());
+    std::span<bool> const flags{in_shadow.data(), in_shadow.size()};
+
+    Color color{0., 0., 0.};
+    Color throughput{1., 1., 1.};
+    Ray path = ray;
+    for (auto bounce{0U};; ++bounce) {
+        auto const hit = world.closest_hit(path);
+        if (!hit)
+            break;
+        auto const surface = world.surface(path, *hit);
+        auto const& material = world.material(surface);
+
+        // Direct light. Its ambient part stands for the indirect light, which the path samples.
+        auto direct_material = material;
+        direct_material.ambient = 0.;
+        world.shadows(surface.point, surface.normal_vector, flags);
+        color += throughput * lighting(direct_material, world.lights(), surface.point,
+                                       surface.eye_vector, surface.normal_vector, flags,
+                                       settings.quality);
+        if (bounce == settings.max_depth)
+            break;
+
+        // How much light each way of scattering carries on, the diffuse one by its brightest
+        // channel. Where a surface both reflects and refracts, the angle splits the light between
+        // them, as in World::shade().
+        auto const n_ratio =
+            surface.inside ? material.refractive_index : 1. / material.refractive_index;
+        auto const refraction = refract(surface.eye_vector, surface.normal_vector, n_ratio);
+        auto const both = material.reflective > 0. && material.transparency > 0.;
+        auto const reflectance = both ? refraction.reflectance : 1.;
+
+        Color const albedo = material.color * material.diffuse;
+        auto const diffuse = std::max({albedo.r, albedo.g, albedo.b, 0.});
+        auto const mirror = material.reflective * reflectance;
+        auto const through =
+            refraction.direction ? material.transparency * (both ? 1. - reflectance : 1.) : 0.;
+        auto const total = diffuse + mirror + through;
+        if (total <= 0.)
+            break;
+
+        // Pick one in proportion to its weight, and divide by the probability of the pick. The
+        // cosine density cancels out the cosine of diffuse scattering, leaving the albedo.
+        auto const u = random.uniform4(pixel_block + 1 + bounce);
+        auto const pick = u[0] * total;
+        if (pick < diffuse) {
+            throughput = throughput * albedo * (total / diffuse);
+            path = Ray{surface.point, cosine_direction(surface.normal_vector, u[1], u[2])};
+        } else if (pick < diffuse + mirror) {
+            throughput = throughput * total;
+            path = Ray{surface.point, reflect(-surface.eye_vector, surface.normal_vector)};
+        } else {
+            throughput = throughput * total;
+            path = Ray{under_point(surface), *refraction.direction};
+        }
+
+        if (bounce + 1 > settings.min_depth) {
+            auto const brightest = std::max({throughput.r, throughput.g, throughput.b});
+            auto const survival = std::min(brightest, .95);
+            if (u[3] >= survival)
+                break;
+            throughput = throughput / survival;
+        }
+    }
+    return color;
+}
+
+Canvas render_path_traced(World const& world, Camera const& camera, PathTracing const& settings) {
+    if (settings.samples_per_pixel == 0)
+        throw std::logic_error{"render_path_traced: need at least one sample per pixel"};
+    if (settings.tile_size == 0)
+        throw std::logic_error{"render_path_traced: tiles cannot be empty"};
+
+    auto const width = camera.hsize();
+    auto const height = camera.vsize();
+    auto const size = settings.tile_size;
+    auto const columns = (width + size - 1) / size;
+    auto const rows = (height + size - 1) / size;
+
+    // Threads write disjoint pixels, and the canvas is marked dirty once they are done.
+    Canvas canvas{width, height};
+    parallel_for(std::size_t{columns} * rows, 1, [&](std::size_t begin, std::size_t end) {
+        for (auto tile = begin; tile < end; ++tile) {
+            auto const x0 = static_cast<unsigned>(tile % columns) * size;
+            auto const y0 = static_cast<unsigned>(tile / columns) * size;
+            for (auto y = y0; y < std::min(y0 + size, height); ++y) {
+                for (auto x = x0; x < std::min(x0 + size, width); ++x) {
+                    Color sum{0., 0., 0.};
+                    for (auto sample{0U}; sample < settings.samples_per_pixel; ++sample) {
+                        SampleRandom const random{x, y, sample, settings.frame, settings.seed};
+                        auto const offset = random.uniform4(pixel_block);
+                        auto const ray =
+                            camera.ray_for_pixel(x, y, offset[0] - .5, offset[1] - .5);
+                        sum += trace_path(world, ray, random, settings);
+                    }
+                    canvas(x, y) = sum / double(settings.samples_per_pixel);
+                }
+            }
+        }
+    });
+
+    canvas.mark_dirty({0, 0, width, height});
+    return canvas;
+}
+
+} // namespace cherry_blazer
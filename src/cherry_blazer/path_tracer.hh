@@ -0,0 +1,58 @@
+#pragma once
+
+#include "camera.hh"
+#include "canvas.hh"
+#include "color.hh"
+#include "lighting.hh"
+#include "random.hh"
+#include "ray.hh"
+#include "world.hh"
+
+#include <cstdint>
+
+namespace cherry_blazer {
+
+// Settings of render_path_traced().
+struct PathTracing {
+    // Each pixel averages this many paths, through random points of the pixel.
+    unsigned samples_per_pixel{16};
+    // Paths are not cut short by Russian roulette before this many bounces...
+    unsigned min_depth{3};
+    // ... and always end after this many.
+    unsigned max_depth{16};
+    // Pixels are rendered in square tiles of this size, which threads take in turn.
+    unsigned tile_size{16};
+    // Together with the pixel and the sample, these pick the random numbers (see SampleRandom).
+    unsigned frame{0};
+    std::uint32_t seed{0};
+    SpecularQuality quality{SpecularQuality::Exact};
+};
+
+// Light arriving along the ray, estimated by following a single random path through the world.
+//
+// At every surface the path hits, the lights are sampled directly (next-event estimation): their
+// contribution is lighting() without the ambient part, which the light bouncing off other
+// surfaces stands in for. The path then goes on in one direction, picked among the ways the
+// material scatters light in proportion to how much each one scatters: diffusely, with
+// directions weighted by the cosine to the normal, like a mirror, or through the surface. Light
+// only comes from the point lights, so paths which leave the world add nothing.
+//
+// Past settings.min_depth bounces, a path continues with the probability of its throughput, at
+// most .95, and is weighted up by its inverse when it does (Russian roulette), so that dim paths
+// end early while the estimate stays unbiased.
+//
+// Diffuse surfaces are Lambertian with albedo color * diffuse, which matches the diffuse part of
+// lighting() for a light whose intensity is the radiance it gives a white surface facing it. The
+// specular highlight only applies to the direct light. Like World::shade(), refraction assumes
+// that light enters from and leaves to vacuum.
+[[nodiscard]] Color trace_path(World const& world, Ray const& ray, SampleRandom const& random,
+                               PathTracing const& settings = {});
+
+// Renders the image with trace_path(), averaging settings.samples_per_pixel paths per pixel.
+// Tiles are rendered in parallel (see parallel_for()). The random numbers of a sample only
+// depend on its pixel, its index and the settings, so the image is the same whatever the number
+// of threads. Throws std::logic_error if samples_per_pixel or tile_size is 0.
+[[nodiscard]] Canvas render_path_traced(World const& world, Camera const& camera,
+                                        PathTracing const& settings = {});
+
+} // namespace cherry_blazer
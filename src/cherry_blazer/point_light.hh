@@ -3,11 +3,17 @@
 #include "color.hh"
 #include "point.hh"
 
+#include <limits>
+
 namespace cherry_blazer {
 
 struct PointLight {
     Point3d position;
     Color intensity;
+    // Distance at which the light fades out completely. Points farther away are not lit by it at
+    // all, which lets shading skip the light. The default light reaches everywhere and does not
+    // fade.
+    double radius{std::numeric_limits<double>::infinity()};
 };
 
 } // namespace cherry_blazer
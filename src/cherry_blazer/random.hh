@@ -0,0 +1,69 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+namespace cherry_blazer {
+
+namespace detail {
+
+// Philox4x32-10, a counter-based generator: the output is a pure function of a 128-bit counter and
+// a 64-bit key, so there is no state to share between threads, and every lane of a loop can
+// compute its own numbers independently.
+// J. K. Salmon et al., "Parallel random numbers: as easy as 1, 2, 3", SC 2011.
+using philox_counter = std::array<std::uint32_t, 4>;
+using philox_key = std::array<std::uint32_t, 2>;
+
+[[nodiscard]] constexpr philox_counter philox4x32(philox_counter counter, philox_key key) noexcept {
+    constexpr std::uint64_t multiplier0 = 0xD2511F53;
+    constexpr std::uint64_t multiplier1 = 0xCD9E8D57;
+    constexpr std::uint32_t weyl0 = 0x9E3779B9;
+    constexpr std::uint32_t weyl1 = 0xBB67AE85;
+
+    for (auto round{0}; round < 10; ++round) {
+        auto const product0 = multiplier0 * counter[0];
+        auto const product1 = multiplier1 * counter[2];
+        counter = {static_cast<std::uint32_t>(product1 >> 32U) ^ counter[1] ^ key[0],
+                   static_cast<std::uint32_t>(product1),
+                   static_cast<std::uint32_t>(product0 >> 32U) ^ counter[3] ^ key[1],
+                   static_cast<std::uint32_t>(product0)};
+        key[0] += weyl0;
+        key[1] += weyl1;
+    }
+    return counter;
+}
+
+// Uniform double in [0;1) from 32 random bits.
+[[nodiscard]] constexpr double to_unit_interval(std::uint32_t bits) noexcept {
+    return double(bits) * 0x1p-32;
+}
+
+} // namespace detail
+
+// Random numbers of one sample of one pixel of one frame. They depend on nothing but these
+// indices and the seed: no state is carried from one number to the next, so renders come out the
+// same regardless of the number of threads and of the order in which pixels are visited.
+class SampleRandom {
+  public:
+    constexpr SampleRandom(unsigned x, unsigned y, unsigned sample, unsigned frame = 0,
+                           std::uint32_t seed = 0) noexcept
+        : counter_{x, y, sample, frame}, seed_{seed} {}
+
+    // Uniform numbers in [0;1), four at a time: numbers 4*block to 4*block+3.
+    [[nodiscard]] constexpr std::array<double, 4> uniform4(std::uint32_t block) const noexcept {
+        auto const bits = detail::philox4x32(counter_, {seed_, block});
+        return {detail::to_unit_interval(bits[0]), detail::to_unit_interval(bits[1]),
+                detail::to_unit_interval(bits[2]), detail::to_unit_interval(bits[3])};
+    }
+
+    // The i-th uniform number in [0;1) of the sample.
+    [[nodiscard]] constexpr double uniform(std::uint32_t i) const noexcept {
+        return uniform4(i / 4)[i % 4];
+    }
+
+  private:
+    detail::philox_counter counter_;
+    std::uint32_t seed_;
+};
+
+} // namespace cherry_blazer
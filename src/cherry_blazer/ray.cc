@@ -12,8 +12,6 @@ namespace cherry_blazer {
 Ray::Ray(Point3d const& origin, Vec3d const& direction) noexcept
     : origin{origin}, direction{direction} {}
 
-Point3d Ray::position(double time) const noexcept { return origin + direction * time; }
-
 Ray transform(Ray const& ray, Transformation const& tform) noexcept {
     switch (tform.kind) {
     case Transformation::Kind::Identity:
@@ -29,4 +27,19 @@ Ray transform(Ray const& ray, Transformation const& tform) noexcept {
     return {};
 }
 
+Ray to_object_space(Ray const& ray, Transformation const& tform) noexcept {
+    switch (tform.kind) {
+    case Transformation::Kind::Identity:
+        return ray;
+    case Transformation::Kind::Translation:
+        return {tform.inv * ray.origin, ray.direction};
+    case Transformation::Kind::Scaling:
+    case Transformation::Kind::Rotation:
+    case Transformation::Kind::Shearing:
+        return {tform.inv * ray.origin, tform.inv * ray.direction};
+    }
+    fmt::print(std::cerr, "ERROR: Unexpected enum: {}\n", tform.kind);
+    return {};
+}
+
 } // namespace cherry_blazer
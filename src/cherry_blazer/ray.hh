@@ -2,8 +2,10 @@
 
 #include "intersection.hh"
 #include "point.hh"
+#include "point_operations.hh"
 #include "transformation.hh"
 #include "vector.hh"
+#include "vector_operations.hh"
 
 #include <cstddef>
 
@@ -16,9 +18,17 @@ struct Ray {
     Ray() noexcept = default;
     Ray(Point3d const& origin, Vec3d const& direction) noexcept;
 
-    [[nodiscard]] Point3d position(double time) const noexcept;
+    // Defined here rather than in ray.cc, so that it can be inlined into the callers' hot loops.
+    [[nodiscard]] constexpr Point3d position(double time) const noexcept {
+        return origin + direction * time;
+    }
 };
 
 Ray transform(Ray const& ray, Transformation const& tform) noexcept;
 
+// The ray in the object space of tform: transform(ray, tform.inverted()), using the cached inverse
+// directly instead of building a Transformation from it. The direction is not normalized, so the
+// ray parameter of every point stays the same.
+Ray to_object_space(Ray const& ray, Transformation const& tform) noexcept;
+
 } // namespace cherry_blazer
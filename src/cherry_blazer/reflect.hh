@@ -3,6 +3,9 @@
 #include "vector.hh"
 #include "vector_operations.hh"
 
+#include <cmath>
+#include <optional>
+
 namespace cherry_blazer {
 
 template <typename Precision, std::size_t Dimension>
@@ -10,4 +13,33 @@ auto reflect(Vector<Precision, Dimension> const& in, Vector<Precision, Dimension
     return in - normal * 2. * dot(in, normal);
 }
 
+// How light passes through a surface between two media, seen from the eye: its unit vector and
+// the unit normal are on the same side, and n_ratio is the refractive index on that side over
+// the one on the other side.
+template <typename Precision, std::size_t Dimension> struct Refraction {
+    // The refracted direction, a unit vector, or nothing under total internal reflection.
+    std::optional<Vector<Precision, Dimension>> direction;
+    // Fraction of the light reflected rather than refracted, by Schlick's approximation; 1 under
+    // total internal reflection.
+    Precision reflectance;
+};
+
+template <typename Precision, std::size_t Dimension>
+Refraction<Precision, Dimension> refract(Vector<Precision, Dimension> const& eye,
+                                         Vector<Precision, Dimension> const& normal,
+                                         Precision n_ratio) {
+    // Snell's law, with the sines squared.
+    auto const cos_i = dot(eye, normal);
+    auto const sin2_t = n_ratio * n_ratio * (Precision{1} - cos_i * cos_i);
+    if (sin2_t > Precision{1})
+        return {std::nullopt, Precision{1}};
+    auto const cos_t = std::sqrt(Precision{1} - sin2_t);
+
+    auto const r0 = (n_ratio - Precision{1}) * (n_ratio - Precision{1}) /
+                    ((n_ratio + Precision{1}) * (n_ratio + Precision{1}));
+    auto const cos = n_ratio > Precision{1} ? cos_t : cos_i;
+    auto const reflectance = r0 + (Precision{1} - r0) * std::pow(Precision{1} - cos, 5);
+    return {normal * (n_ratio * cos_i - cos_t) - eye * n_ratio, reflectance};
+}
+
 } // namespace cherry_blazer
@@ -0,0 +1,437 @@
+#include "render.hh"
+
+#include "footprint.hh"
+#include "random.hh"
+#include "visibility_buffer.hh"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace cherry_blazer {
+
+namespace {
+
+// Sphere ids start at 1, so 0 stands for the background.
+constexpr std::uint64_t no_object = 0;
+
+bool contrasting(Color const& lhs, Color const& rhs, double threshold) {
+    return std::abs(lhs.r - rhs.r) > threshold || std::abs(lhs.g - rhs.g) > threshold ||
+           std::abs(lhs.b - rhs.b) > threshold;
+}
+
+// Index (into objects(), instances() or meshes()) and screen footprint of everything that has one.
+struct Footprint {
+    Tile tile;
+    std::uint32_t index;
+};
+
+// Footprints binned into square cells of the image, in compact form: cell c overlaps
+// footprints_[entries_[i]] for i in [starts_[c];starts_[c + 1]). A pixel only tests the footprints
+// of its cell, so the cost per pixel follows the number of objects nearby on screen rather than
+// of all objects.
+class FootprintGrid {
+  public:
+    FootprintGrid(std::vector<Footprint> footprints, unsigned width, unsigned height)
+        : footprints_{std::move(footprints)}, columns_{(width + cell_size - 1) / cell_size} {
+        auto const rows = (height + cell_size - 1) / cell_size;
+        starts_.assign(std::size_t{columns_} * rows + 1, 0);
+        for_each_cell([this](std::size_t cell, std::uint32_t /*footprint*/) {
+            ++starts_[cell + 1]; // counted one cell ahead, to become starts by the sums below
+        });
+        for (std::size_t cell = 1; cell < starts_.size(); ++cell)
+            starts_[cell] += starts_[cell - 1];
+
+        entries_.resize(starts_.back());
+        auto next = starts_;
+        for_each_cell([this, &next](std::size_t cell, std::uint32_t footprint) {
+            entries_[next[cell]++] = footprint;
+        });
+    }
+
+    // Indices of the footprints covering pixel (x, y), in increasing order.
+    void select(unsigned x, unsigned y, std::vector<std::uint32_t>& candidates) const {
+        candidates.clear();
+        auto const cell = std::size_t{y / cell_size} * columns_ + x / cell_size;
+        for (auto i = starts_[cell]; i < starts_[cell + 1]; ++i) {
+            auto const& [tile, index] = footprints_[entries_[i]];
+            if (x >= tile.x && x - tile.x < tile.width && y >= tile.y && y - tile.y < tile.height)
+                candidates.push_back(index);
+        }
+    }
+
+  private:
+    // Pixels per side of a cell.
+    static constexpr unsigned cell_size = 16;
+
+    std::vector<Footprint> footprints_;
+    unsigned columns_;
+    std::vector<std::size_t> starts_;
+    std::vector<std::uint32_t> entries_;
+
+    // Calls f(cell, footprint) for every cell each footprint overlaps, footprint by footprint.
+    template <typename F> void for_each_cell(F const& f) const {
+        for (std::size_t i = 0; i < footprints_.size(); ++i) {
+            auto const& tile = footprints_[i].tile;
+            if (tile.width == 0 || tile.height == 0)
+                continue;
+            for (auto row = tile.y / cell_size; row <= (tile.y + tile.height - 1) / cell_size;
+                 ++row) {
+                for (auto column = tile.x / cell_size;
+                     column <= (tile.x + tile.width - 1) / cell_size; ++column) {
+                    f(std::size_t{row} * columns_ + column, static_cast<std::uint32_t>(i));
+                }
+            }
+        }
+    }
+};
+
+// Screen footprints of all the objects, instances and meshes, to find the ones a primary ray may
+// hit without testing all of them. The other shapes have no footprints: there are usually few of
+// them, and planes cover the whole screen anyway, so every ray tests them all.
+class Footprints {
+  public:
+    Footprints(World const& world, Camera const& camera)
+        : world_{world}, objects_{footprints(world.objects(), camera)},
+          instances_{footprints(world.instances(), camera)},
+          meshes_{footprints(world.meshes(), camera)} {}
+
+    // Selects the objects, instances and meshes whose footprints cover pixel (x, y). False if
+    // there are none, so that rays through the pixel surely miss everything.
+    bool select(unsigned x, unsigned y) {
+        objects_.select(x, y, object_candidates_);
+        instances_.select(x, y, instance_candidates_);
+        meshes_.select(x, y, mesh_candidates_);
+        return !object_candidates_.empty() || !instance_candidates_.empty() ||
+               !mesh_candidates_.empty() || has_shapes_;
+    }
+
+    // Nearest hit of a ray through the pixel last selected.
+    [[nodiscard]] std::optional<Hit> closest_hit(Ray const& ray) const {
+        auto closest = object_candidates_.empty()
+                           ? std::nullopt
+                           : world_.closest_hit(ray, object_candidates_);
+        for (auto const instance : instance_candidates_) {
+            auto const max_t = closest ? closest->t : std::numeric_limits<double>::infinity();
+            if (auto const hit = world_.closest_instance_hit(ray, instance, max_t))
+                closest = hit;
+        }
+        for (auto const mesh : mesh_candidates_) {
+            auto const max_t = closest ? closest->t : std::numeric_limits<double>::infinity();
+            if (auto const hit = world_.closest_mesh_hit(ray, mesh, max_t))
+                closest = hit;
+        }
+        if (has_shapes_) {
+            auto const max_t = closest ? closest->t : std::numeric_limits<double>::infinity();
+            if (auto const hit = world_.closest_shape_hit(ray, max_t))
+                closest = hit;
+        }
+        return closest;
+    }
+
+  private:
+    World const& world_;
+    bool has_shapes_{world_.has_shapes()};
+    FootprintGrid objects_;
+    FootprintGrid instances_;
+    FootprintGrid meshes_;
+    std::vector<std::uint32_t> object_candidates_;
+    std::vector<std::uint32_t> instance_candidates_;
+    std::vector<std::uint32_t> mesh_candidates_;
+
+    // Footprints of spheres, or of the boxes of instances or meshes.
+    template <typename T>
+    static FootprintGrid footprints(std::span<T const> things, Camera const& camera) {
+        std::vector<Footprint> out;
+        for (std::size_t i = 0; i < things.size(); ++i) {
+            std::optional<Tile> footprint;
+            if constexpr (std::is_same_v<T, Sphere>)
+                footprint = screen_footprint(things[i], camera);
+            else
+                footprint = screen_footprint(bounds(things[i]), camera);
+            if (footprint)
+                out.push_back({*footprint, static_cast<std::uint32_t>(i)});
+        }
+        return {std::move(out), camera.hsize(), camera.vsize()};
+    }
+};
+
+} // namespace
+
+Canvas render(World const& world, Camera const& camera, SpecularQuality quality) {
+    Footprints footprints{world, camera};
+    Canvas canvas{camera.hsize(), camera.vsize()};
+    for (auto y{0U}; y < camera.vsize(); ++y) {
+        for (auto x{0U}; x < camera.hsize(); ++x) {
+            if (!footprints.select(x, y))
+                continue; // background, no ray needed
+            auto const ray = camera.ray_for_pixel(x, y);
+            if (auto const hit = footprints.closest_hit(ray))
+                canvas(x, y) = world.shade(ray, *hit, quality);
+        }
+    }
+    canvas.mark_dirty({0, 0, canvas.width(), canvas.height()});
+    return canvas;
+}
+
+Canvas render_rasterized(World const& world, Camera const& camera, SpecularQuality quality) {
+    VisibilityBuffer const visibility{world, camera};
+    Canvas canvas{camera.hsize(), camera.vsize()};
+    for (auto y{0U}; y < camera.vsize(); ++y) {
+        for (auto x{0U}; x < camera.hsize(); ++x) {
+            if (auto const hit = visibility.hit(x, y))
+                canvas(x, y) = world.shade(camera.ray_for_pixel(x, y), *hit, quality);
+        }
+    }
+    canvas.mark_dirty({0, 0, canvas.width(), canvas.height()});
+    return canvas;
+}
+
+void render_tile(World const& world, Camera const& camera, Tile const& tile, Canvas& canvas,
+                 SpecularQuality quality) {
+    if (canvas.width() != camera.hsize() || canvas.height() != camera.vsize())
+        throw std::logic_error{"render_tile: canvas does not match the camera"};
+
+    std::vector<Ray> rays(std::size_t{tile.width} * tile.height);
+    camera.rays_for_tile(tile, rays); // checks the tile
+
+    auto ray = rays.cbegin();
+    for (auto y{tile.y}; y < tile.y + tile.height; ++y)
+        for (auto x{tile.x}; x < tile.x + tile.width; ++x)
+            canvas(x, y) = world.color_at(*ray++, quality);
+    canvas.mark_dirty(tile);
+}
+
+ProgressiveRender::ProgressiveRender(World const& world, Camera const& camera,
+                                     SpecularQuality quality, unsigned block_size)
+    : world_{world}, camera_{camera}, quality_{quality},
+      canvas_{camera.hsize(), camera.vsize()}, passes_{}, passes_done_{0}, step_{block_size},
+      row_{0} {
+    if (!std::has_single_bit(block_size))
+        throw std::logic_error{"ProgressiveRender: block size must be a power of two"};
+    passes_ = unsigned(std::countr_zero(block_size)) + 1;
+}
+
+Canvas const& ProgressiveRender::canvas() const& { return canvas_; }
+
+Canvas ProgressiveRender::canvas() && { return std::move(canvas_); }
+
+SpecularQuality ProgressiveRender::quality() const { return quality_; }
+
+void ProgressiveRender::set_quality(SpecularQuality quality) { quality_ = quality; }
+
+unsigned ProgressiveRender::passes() const { return passes_; }
+
+unsigned ProgressiveRender::passes_done() const { return passes_done_; }
+
+bool ProgressiveRender::done() const { return passes_done_ == passes_; }
+
+std::size_t ProgressiveRender::pass_pixels(unsigned pass) const {
+    if (pass >= passes_)
+        return 0;
+
+    // pixels on the grid of the pass, minus those on the grid of the previous one
+    auto const grid = [this](unsigned step) {
+        auto const columns = (std::size_t{canvas_.width()} + step - 1) / step;
+        auto const rows = (std::size_t{canvas_.height()} + step - 1) / step;
+        return columns * rows;
+    };
+    auto const step = (1U << (passes_ - 1)) >> pass;
+    return pass == 0 ? grid(step) : grid(step) - grid(step * 2);
+}
+
+template <typename Stop> bool ProgressiveRender::render_pass_until(Stop const& stop) {
+    if (done())
+        return false;
+
+    for (; row_ < canvas_.height(); row_ += step_) {
+        if (stop())
+            return false;
+        render_row(row_);
+    }
+
+    ++passes_done_;
+    step_ /= 2;
+    row_ = 0;
+    return true;
+}
+
+bool ProgressiveRender::render_pass(std::atomic<bool> const& cancel) {
+    return render_pass_until([&cancel] { return cancel.load(std::memory_order_relaxed); });
+}
+
+bool ProgressiveRender::render_pass() {
+    return render_pass_until([] { return false; });
+}
+
+bool ProgressiveRender::render_pass(std::chrono::steady_clock::time_point deadline) {
+    return render_pass_until([deadline] { return std::chrono::steady_clock::now() >= deadline; });
+}
+
+void ProgressiveRender::render_row(unsigned y) {
+    auto const width = canvas_.width();
+    auto const height = canvas_.height();
+
+    // After the first pass, pixels on even multiples of the previous step were shaded already: on
+    // such rows, only every other pixel is new.
+    auto first = 0U;
+    auto stride = step_;
+    if (passes_done_ != 0 && y % (2 * step_) == 0) {
+        first = step_;
+        stride = 2 * step_;
+    }
+
+    auto const block_height = std::min(step_, height - y);
+    for (auto x = first; x < width; x += stride) {
+        auto const color = world_.color_at(camera_.ray_for_pixel(x, y), quality_);
+        auto const block_width = std::min(step_, width - x);
+        for (auto block_y{0U}; block_y < block_height; ++block_y)
+            for (auto block_x{0U}; block_x < block_width; ++block_x)
+                canvas_(x + block_x, y + block_y) = color;
+    }
+    canvas_.mark_dirty({0, y, width, block_height});
+}
+
+BudgetedRender render(World const& world, Camera const& camera,
+                      std::chrono::steady_clock::time_point deadline, SpecularQuality quality,
+                      unsigned block_size) {
+    using clock = std::chrono::steady_clock;
+    auto const start = clock::now();
+
+    ProgressiveRender progressive{world, camera, quality, block_size};
+    progressive.render_pass(); // always, so that there is an image
+
+    auto shaded = progressive.pass_pixels(0);
+    while (!progressive.done()) {
+        auto const now = clock::now();
+        if (now >= deadline)
+            break;
+
+        std::chrono::duration<double> const per_pixel = (now - start) / double(shaded);
+        auto const next_pixels = progressive.pass_pixels(progressive.passes_done());
+        if (now + per_pixel * double(next_pixels) > deadline)
+            progressive.set_quality(SpecularQuality::Approximate);
+
+        if (!progressive.render_pass(deadline))
+            break;
+        shaded += next_pixels;
+    }
+
+    auto const end = clock::now();
+    auto const finest_block_size =
+        (1U << (progressive.passes() - 1)) >> (progressive.passes_done() - 1);
+    RenderReport const report{finest_block_size, progressive.quality(), progressive.done(),
+                              end <= deadline, end - start};
+    return {std::move(progressive).canvas(), report};
+}
+
+BudgetedRender render(World const& world, Camera const& camera,
+                      std::chrono::steady_clock::duration budget, SpecularQuality quality,
+                      unsigned block_size) {
+    return render(world, camera, std::chrono::steady_clock::now() + budget, quality, block_size);
+}
+
+AntialiasedRender render_antialiased(World const& world, Camera const& camera,
+                                     Supersampling const& settings, SpecularQuality quality) {
+    if (settings.samples_per_axis == 0)
+        throw std::logic_error{"render_antialiased: need at least one sample per axis"};
+
+    auto const width = camera.hsize();
+    auto const height = camera.vsize();
+    auto const index = [width](unsigned x, unsigned y) { return std::size_t{y} * width + x; };
+
+    // the color of a sample of pixel (x, y), and the id of the object it sees
+    Footprints footprints{world, camera};
+    auto const trace = [&world, &footprints, quality](Ray const& ray, unsigned x, unsigned y,
+                                                      std::uint64_t& object_id) {
+        auto const hit = footprints.select(x, y) ? footprints.closest_hit(ray) : std::nullopt;
+        if (!hit) {
+            object_id = no_object;
+            return Color{0., 0., 0.};
+        }
+        if (hit->mesh != no_mesh) {
+            // A whole mesh counts as one object. Sphere ids are never 0, so these never clash.
+            object_id = (std::uint64_t{hit->mesh} + 1) << 32U;
+        } else if (hit->primitive != Primitive::Sphere) {
+            // Other shapes have no ids; their index does, with the high half told apart from
+            // that of spheres, of any instance but the last few, by the kind of shape.
+            object_id = (std::uint64_t{no_instance - static_cast<std::uint32_t>(hit->primitive)}
+                         << 32U) |
+                        hit->object;
+        } else {
+            // Instances share their group's objects, ids included, so the instance tells them
+            // apart.
+            object_id = (std::uint64_t{hit->instance} << 32U) |
+                        world.object(hit->object, hit->instance).id();
+        }
+        return world.shade(ray, *hit, quality);
+    };
+
+    // One sample per pixel, through its center.
+    Canvas canvas{width, height};
+    std::vector<std::uint64_t> object_ids(std::size_t{width} * height);
+    for (auto y{0U}; y < height; ++y)
+        for (auto x{0U}; x < width; ++x)
+            canvas(x, y) = trace(camera.ray_for_pixel(x, y), x, y, object_ids[index(x, y)]);
+
+    // Mark both pixels of every differing pair of horizontal or vertical neighbours.
+    std::vector<bool> refine(object_ids.size());
+    auto const compare = [&](unsigned x0, unsigned y0, unsigned x1, unsigned y1) {
+        if (object_ids[index(x0, y0)] != object_ids[index(x1, y1)] ||
+            contrasting(canvas(x0, y0), canvas(x1, y1), settings.contrast_threshold)) {
+            refine[index(x0, y0)] = true;
+            refine[index(x1, y1)] = true;
+        }
+    };
+    for (auto y{0U}; y < height; ++y) {
+        for (auto x{0U}; x < width; ++x) {
+            if (x + 1 < width)
+                compare(x, y, x + 1, y);
+            if (y + 1 < height)
+                compare(x, y, x, y + 1);
+        }
+    }
+
+    // Average a regular grid of samples over each marked pixel.
+    auto const n = settings.samples_per_axis;
+    auto const samples = double(n * n);
+    std::size_t supersampled_pixels = 0;
+    for (auto y{0U}; y < height; ++y) {
+        for (auto x{0U}; x < width; ++x) {
+            if (!refine[index(x, y)])
+                continue;
+            Color sum{0., 0., 0.};
+            std::uint64_t object_id{};
+            for (auto j{0U}; j < n; ++j) {
+                for (auto i{0U}; i < n; ++i) {
+                    auto within_x = .5;
+                    auto within_y = .5;
+                    if (settings.jitter) {
+                        SampleRandom const random{x, y, j * n + i, 0, settings.seed};
+                        within_x = random.uniform(0);
+                        within_y = random.uniform(1);
+                    }
+                    auto const offset_x = (double(i) + within_x) / double(n) - .5;
+                    auto const offset_y = (double(j) + within_y) / double(n) - .5;
+                    sum += trace(camera.ray_for_pixel(x, y, offset_x, offset_y), x, y, object_id);
+                }
+            }
+            canvas(x, y) = sum / samples;
+            ++supersampled_pixels;
+        }
+    }
+
+    canvas.mark_dirty({0, 0, width, height});
+    return {std::move(canvas), supersampled_pixels};
+}
+
+} // namespace cherry_blazer
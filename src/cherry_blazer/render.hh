@@ -0,0 +1,143 @@
+#pragma once
+
+#include "camera.hh"
+#include "canvas.hh"
+#include "lighting.hh"
+#include "world.hh"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace cherry_blazer {
+
+// Renders the image, one ray per pixel. Before tracing, every object is projected onto the image
+// (see screen_footprint()): a primary ray is only tested against the objects whose footprint
+// covers its pixel, and pixels outside of all footprints are left black without casting a ray.
+// Shadow rays still test all the objects.
+Canvas render(World const& world, Camera const& camera,
+              SpecularQuality quality = SpecularQuality::Exact);
+
+// Same image as render(), but primary visibility comes from a VisibilityBuffer, i.e. objects are
+// rasterized into the image instead of rays being traced into the objects. Shadow rays are still
+// traced.
+Canvas render_rasterized(World const& world, Camera const& camera,
+                         SpecularQuality quality = SpecularQuality::Exact);
+
+// Renders only the pixels of tile into canvas, e.g. the area where something changed since the
+// last frame. Throws std::logic_error if the tile does not fit the camera's image, or the canvas
+// does not match it.
+void render_tile(World const& world, Camera const& camera, Tile const& tile, Canvas& canvas,
+                 SpecularQuality quality = SpecularQuality::Exact);
+
+// Renders a world in passes of increasing resolution, so that a usable preview is available early.
+// The first pass shades one pixel per block_size x block_size block and paints the whole block
+// with it. Every following pass halves the block size and shades only the pixels which no earlier
+// pass shaded, so the passes interleave and, together, shade every pixel exactly once.
+//
+// world and camera must outlive the render.
+class ProgressiveRender {
+  public:
+    // Throws std::logic_error if block_size is not a power of two.
+    ProgressiveRender(World const& world, Camera const& camera,
+                      SpecularQuality quality = SpecularQuality::Exact, unsigned block_size = 8);
+
+    // The image so far. Safe to read whenever no pass is running.
+    [[nodiscard]] Canvas const& canvas() const&;
+    [[nodiscard]] Canvas canvas() &&;
+
+    // Shading quality of the next pixels. Can change between passes, e.g. to save time.
+    [[nodiscard]] SpecularQuality quality() const;
+    void set_quality(SpecularQuality quality);
+
+    // Number of passes in total, and number of passes finished so far.
+    [[nodiscard]] unsigned passes() const;
+    [[nodiscard]] unsigned passes_done() const;
+    [[nodiscard]] bool done() const;
+    // Number of pixels shaded by the given pass (counted from 0).
+    [[nodiscard]] std::size_t pass_pixels(unsigned pass) const;
+
+    // Render the next pass. cancel is checked before every row: once it is set, the pass stops
+    // there and returns false, and the next call picks it up at that row. Returns true if the pass
+    // was finished (false as well if all passes were already done).
+    bool render_pass(std::atomic<bool> const& cancel);
+    bool render_pass();
+    // Same, but stops at the deadline instead.
+    bool render_pass(std::chrono::steady_clock::time_point deadline);
+
+  private:
+    World const& world_;
+    Camera const& camera_;
+    SpecularQuality quality_;
+    Canvas canvas_;
+    unsigned passes_;
+    unsigned passes_done_;
+    // Spacing of the pixels shaded by the current pass, and the next row of the pass to render.
+    unsigned step_;
+    unsigned row_;
+
+    template <typename Stop> bool render_pass_until(Stop const& stop);
+    void render_row(unsigned y);
+};
+
+// What a time-budgeted render achieved.
+struct RenderReport {
+    // Block size of the finest finished pass: 1 if every pixel was shaded, more if the image is
+    // (partly) a low resolution preview.
+    unsigned block_size;
+    // Specular quality of the last shaded pixels.
+    SpecularQuality quality;
+    bool complete;
+    // Only the first pass, or the row being shaded when the deadline passed, can miss it.
+    bool deadline_met;
+    std::chrono::steady_clock::duration elapsed;
+};
+
+struct BudgetedRender {
+    Canvas canvas;
+    RenderReport report;
+};
+
+// Renders as much of the image as fits before the deadline, progressively (see
+// ProgressiveRender), so that whatever is done when time runs out is a complete, if coarse, image.
+// The first pass is always finished; block_size bounds its cost. After every pass, the time per
+// pixel so far predicts the next pass: if it would not fit at the requested quality, shading drops
+// to SpecularQuality::Approximate for the rest of the render. Passes which still don't fit are cut
+// at the deadline, leaving lower resolution where they did not get to.
+BudgetedRender render(World const& world, Camera const& camera,
+                      std::chrono::steady_clock::time_point deadline,
+                      SpecularQuality quality = SpecularQuality::Exact, unsigned block_size = 8);
+
+// Same, with a budget counted from the call.
+BudgetedRender render(World const& world, Camera const& camera,
+                      std::chrono::steady_clock::duration budget,
+                      SpecularQuality quality = SpecularQuality::Exact, unsigned block_size = 8);
+
+// Settings of render_antialiased().
+struct Supersampling {
+    // A pixel gets samples_per_axis x samples_per_axis samples once it is refined.
+    unsigned samples_per_axis{4};
+    // Neighbouring pixels whose colors differ by more than this in any component are refined.
+    double contrast_threshold{.1};
+    // Whether each sample is placed randomly within its cell of the grid, rather than at its
+    // center. The positions only depend on the pixel, the sample and the seed (see SampleRandom).
+    bool jitter{false};
+    std::uint32_t seed{0};
+};
+
+struct AntialiasedRender {
+    Canvas canvas;
+    // How many pixels took extra samples.
+    std::size_t supersampled_pixels;
+};
+
+// Renders one sample per pixel first, then supersamples only the pixels which differ from a
+// neighbour beyond the contrast threshold or see a different object (compared by Sphere::id()), so
+// edges are anti-aliased while flat areas cost a single sample.
+// Throws std::logic_error if samples_per_axis is 0.
+AntialiasedRender render_antialiased(World const& world, Camera const& camera,
+                                     Supersampling const& settings = {},
+                                     SpecularQuality quality = SpecularQuality::Exact);
+
+} // namespace cherry_blazer
@@ -0,0 +1,258 @@
+#include "scene_file.hh"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cerrno>
+#include <fstream>
+#include <initializer_list>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace cherry_blazer {
+
+namespace {
+
+// The file stores these byte for byte.
+static_assert(std::is_trivially_copyable_v<Sphere>);
+static_assert(std::is_trivially_copyable_v<PointLight>);
+static_assert(std::is_trivially_copyable_v<detail::BvhNode>);
+static_assert(alignof(Sphere) <= scene_file_alignment);
+static_assert(alignof(PointLight) <= scene_file_alignment);
+static_assert(alignof(detail::BvhNode) <= scene_file_alignment);
+
+constexpr std::array<char, 8> magic{'C', 'B', 'S', 'C', 'E', 'N', 'E', '\0'};
+constexpr std::uint32_t version = 1;
+
+// FNV-1a over the byte order and the sizes and alignments of everything stored.
+constexpr std::uint32_t layout() {
+    std::uint32_t hash = 2166136261U;
+    for (std::size_t value :
+         {std::size_t{std::endian::native == std::endian::little}, sizeof(SceneFileHeader),
+          sizeof(Sphere), alignof(Sphere), sizeof(PointLight), alignof(PointLight),
+          sizeof(detail::BvhNode), alignof(detail::BvhNode), sizeof(std::uint32_t)}) {
+        hash ^= static_cast<std::uint32_t>(value);
+        hash *= 16777619U;
+    }
+    return hash;
+}
+
+constexpr std::uint64_t align_up(std::uint64_t offset) {
+    return (offset + scene_file_alignment - 1) / scene_file_alignment * scene_file_alignment;
+}
+
+// Whether count elements of size bytes each fit in the file at offset.
+bool section_fits(std::uint64_t offset, std::uint64_t count, std::size_t size,
+                  std::uint64_t file_size) {
+    return offset % scene_file_alignment == 0 && offset <= file_size &&
+           count <= (file_size - offset) / size;
+}
+
+// Whether the nodes reachable from the root form a tree that Bvh::traverse() can walk: its stack
+// may hold a far child for every inner node above the current one, so no inner node may have
+// Bvh::max_depth of them. Children come after their parents, so there are no cycles, but subtrees
+// could still be shared, which visiting no more nodes than there are rules out.
+bool bvh_walkable(std::span<detail::BvhNode const> nodes) {
+    if (nodes.empty())
+        return true;
+    // Right children still to visit, with their depth: at most one per level.
+    // NOLINTNEXTLINE(*-member-init)
+    std::array<std::pair<std::uint32_t, std::size_t>, Bvh::max_depth> stack;
+    std::size_t stack_size = 0;
+    std::size_t visited = 0;
+    std::uint32_t node = 0;
+    std::size_t depth = 0;
+    for (;;) {
+        if (++visited > nodes.size())
+            return false;
+        if (nodes[node].count == 0) {
+            if (depth >= Bvh::max_depth)
+                return false;
+            stack[stack_size++] = {nodes[node].first + 1, depth + 1};
+            node = nodes[node].first;
+            ++depth;
+            continue;
+        }
+        if (stack_size == 0)
+            return true;
+        std::tie(node, depth) = stack[--stack_size];
+    }
+}
+
+// Whether every index of the Bvh is in range, so that traversing it stays within the file: inner
+// nodes refer to children after them, leaves to runs of the object order, which refers to
+// objects. Also whether the tree is shaped for traversal (see bvh_walkable()).
+bool bvh_fits(std::span<detail::BvhNode const> nodes, std::span<std::uint32_t const> object_order,
+              std::uint64_t object_count) {
+    for (std::size_t i = 0; i < nodes.size(); ++i) {
+        auto const& node = nodes[i];
+        auto const valid = node.count == 0
+                               ? node.first > i && std::uint64_t{node.first} + 2 <= nodes.size()
+                               : std::uint64_t{node.first} + node.count <= object_count;
+        if (!valid)
+            return false;
+    }
+    return bvh_walkable(nodes) &&
+           std::all_of(object_order.begin(), object_order.end(),
+                       [object_count](std::uint32_t object) { return object < object_count; });
+}
+
+} // namespace
+
+void save_scene(World const& world, std::filesystem::path const& path) {
+    if (!world.instances().empty() || !world.meshes().empty() || world.has_shapes())
+        throw std::logic_error{"save_scene: scene files cannot hold instances, meshes or shapes"};
+
+    auto const objects = world.objects();
+    auto const lights = world.lights();
+    auto const nodes = world.bvh().nodes();
+    auto const object_order = world.bvh().object_order();
+
+    SceneFileHeader header{};
+    header.magic = magic;
+    header.version = version;
+    header.layout = layout();
+
+    std::uint64_t end = sizeof(SceneFileHeader);
+    auto const place = [&end](std::size_t bytes) {
+        auto const offset = align_up(end);
+        end = offset + bytes;
+        return offset;
+    };
+    header.object_count = objects.size();
+    header.objects_offset = place(objects.size_bytes());
+    header.light_count = lights.size();
+    header.lights_offset = place(lights.size_bytes());
+    header.node_count = nodes.size();
+    header.nodes_offset = place(nodes.size_bytes());
+    header.object_order_offset = place(object_order.size_bytes());
+    header.size = end;
+
+    std::ofstream file{path, std::ios::binary | std::ios::trunc};
+    if (!file) {
+        throw std::system_error(errno, std::system_category(),
+                                "failed to open '" + path.string() + "'");
+    }
+
+    std::uint64_t written = 0;
+    auto const write = [&](std::uint64_t offset, void const* data, std::size_t bytes) {
+        constexpr std::array<char, scene_file_alignment> padding{};
+        file.write(padding.data(), static_cast<std::streamsize>(offset - written));
+        file.write(static_cast<char const*>(data), static_cast<std::streamsize>(bytes));
+        written = offset + bytes;
+    };
+    write(0, &header, sizeof(header));
+    write(header.objects_offset, objects.data(), objects.size_bytes());
+    write(header.lights_offset, lights.data(), lights.size_bytes());
+    write(header.nodes_offset, nodes.data(), nodes.size_bytes());
+    write(header.object_order_offset, object_order.data(), object_order.size_bytes());
+
+    if (!file.flush()) {
+        throw std::system_error(errno, std::system_category(),
+                                "failed to write '" + path.string() + "'");
+    }
+}
+
+SceneFile::SceneFile(std::filesystem::path const& path) {
+    auto const fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        throw std::system_error(errno, std::system_category(),
+                                "failed to open '" + path.string() + "'");
+    }
+
+    struct stat status {};
+    if (::fstat(fd, &status) != 0) {
+        auto const error = errno;
+        ::close(fd);
+        throw std::system_error(error, std::system_category(),
+                                "failed to stat '" + path.string() + "'");
+    }
+    auto const size = static_cast<std::size_t>(status.st_size);
+    if (size < sizeof(SceneFileHeader)) {
+        ::close(fd);
+        throw std::logic_error{"'" + path.string() + "' is not a scene file"};
+    }
+
+    // Private and writable: the World may change objects and lights in place, and the pages it
+    // touches get copied, the file stays as it is.
+    auto* const mapping = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    auto const error = errno;
+    ::close(fd); // the mapping keeps the file
+    if (mapping == MAP_FAILED) { // NOLINT(cppcoreguidelines-pro-type-cstyle-cast)
+        throw std::system_error(error, std::system_category(),
+                                "failed to map '" + path.string() + "'");
+    }
+    data_ = static_cast<std::byte*>(mapping);
+    size_ = size;
+
+    // The header and the indices of the Bvh are checked, the rest is used as it is.
+    auto const& h = header();
+    auto const valid = h.magic == magic && h.version == version && h.layout == layout() &&
+                       h.size == size &&
+                       section_fits(h.objects_offset, h.object_count, sizeof(Sphere), size) &&
+                       section_fits(h.lights_offset, h.light_count, sizeof(PointLight), size) &&
+                       section_fits(h.nodes_offset, h.node_count, sizeof(detail::BvhNode), size) &&
+                       section_fits(h.object_order_offset, h.object_count, sizeof(std::uint32_t),
+                                    size);
+    if (!valid) {
+        ::munmap(data_, size_);
+        throw std::logic_error{"'" + path.string() +
+                               "' is not a scene file of this version and layout"};
+    }
+    if (!bvh_fits(section<detail::BvhNode const>(h.nodes_offset, h.node_count),
+                  section<std::uint32_t const>(h.object_order_offset, h.object_count),
+                  h.object_count)) {
+        ::munmap(data_, size_);
+        throw std::logic_error{"'" + path.string() + "' has a corrupt Bvh"};
+    }
+}
+
+SceneFile::SceneFile(SceneFile&& other) noexcept
+    : data_{std::exchange(other.data_, nullptr)}, size_{std::exchange(other.size_, 0)} {}
+
+SceneFile& SceneFile::operator=(SceneFile&& other) noexcept {
+    std::swap(data_, other.data_);
+    std::swap(size_, other.size_);
+    return *this;
+}
+
+SceneFile::~SceneFile() {
+    if (data_ != nullptr)
+        ::munmap(data_, size_);
+}
+
+SceneFileHeader const& SceneFile::header() const noexcept {
+    // The mapping is page-aligned, and the sections are aligned within it.
+    return *static_cast<SceneFileHeader const*>(static_cast<void const*>(data_));
+}
+
+template <typename T>
+std::span<T> SceneFile::section(std::uint64_t offset, std::uint64_t count) noexcept {
+    return {static_cast<T*>(static_cast<void*>(data_ + offset)), static_cast<std::size_t>(count)};
+}
+
+std::span<Sphere> SceneFile::objects() noexcept {
+    return section<Sphere>(header().objects_offset, header().object_count);
+}
+
+std::span<PointLight> SceneFile::lights() noexcept {
+    return section<PointLight>(header().lights_offset, header().light_count);
+}
+
+Bvh SceneFile::bvh() noexcept {
+    return {section<detail::BvhNode>(header().nodes_offset, header().node_count),
+            section<std::uint32_t>(header().object_order_offset, header().object_count)};
+}
+
+World SceneFile::world() noexcept { return {objects(), lights(), bvh()}; }
+
+} // namespace cherry_blazer
@@ -0,0 +1,83 @@
+#pragma once
+
+#include "bvh.hh"
+#include "point_light.hh"
+#include "sphere.hh"
+#include "world.hh"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+
+namespace cherry_blazer {
+
+// Binary scene files hold a World, Bvh included, in the in-memory representation of its parts, so
+// loading one is mapping it into memory: no parsing and no allocation per object, whatever its
+// size. The file is:
+//   SceneFileHeader
+//   the Spheres (transformations with cached inverses, materials)
+//   the PointLights
+//   the Bvh nodes, then its object order (see Bvh::nodes() and Bvh::object_order())
+// with every section at an offset aligned to scene_file_alignment, zero-padded before it.
+//
+// The representation depends on the platform and the build, so a file records its layout and can
+// only be loaded where the layout is the same. Spheres keep the ids they had when saved, rather
+// than being given new ones, which would copy every page of them (see Sphere::id()).
+
+inline constexpr std::size_t scene_file_alignment = 64;
+
+struct SceneFileHeader {
+    std::array<char, 8> magic;
+    std::uint32_t version;
+    // Identifies the byte order and the sizes and alignments of the stored types.
+    std::uint32_t layout;
+    std::uint64_t object_count;
+    std::uint64_t objects_offset;
+    std::uint64_t light_count;
+    std::uint64_t lights_offset;
+    std::uint64_t node_count;
+    std::uint64_t nodes_offset;
+    std::uint64_t object_order_offset;
+    // Size of the whole file.
+    std::uint64_t size;
+};
+
+// Writes the world to path, replacing the file if it exists. Throws std::system_error if the file
+// cannot be written, std::logic_error if the world has instances, meshes or shapes.
+void save_scene(World const& world, std::filesystem::path const& path);
+
+// A scene file mapped into memory. The mapping is private and copy-on-write: changes to the World
+// (see world()) stay in this process and never reach the file.
+class SceneFile {
+  public:
+    // Throws std::system_error if the file cannot be opened or mapped, std::logic_error if it is
+    // not a scene file, is truncated, was saved with a different version or layout, or its Bvh
+    // refers to nodes or objects it does not have, shares subtrees or is too deep to traverse.
+    explicit SceneFile(std::filesystem::path const& path);
+
+    SceneFile(SceneFile const&) = delete;
+    SceneFile(SceneFile&& other) noexcept;
+    SceneFile& operator=(SceneFile const&) = delete;
+    SceneFile& operator=(SceneFile&& other) noexcept;
+    ~SceneFile();
+
+    [[nodiscard]] SceneFileHeader const& header() const noexcept;
+
+    [[nodiscard]] std::span<Sphere> objects() noexcept;
+    [[nodiscard]] std::span<PointLight> lights() noexcept;
+    [[nodiscard]] Bvh bvh() noexcept;
+
+    // World over the mapped objects, lights and Bvh. The SceneFile must outlive it.
+    [[nodiscard]] World world() noexcept;
+
+  private:
+    std::byte* data_{nullptr};
+    std::size_t size_{0};
+
+    template <typename T> [[nodiscard]] std::span<T> section(std::uint64_t offset,
+                                                            std::uint64_t count) noexcept;
+};
+
+} // namespace cherry_blazer
@@ -0,0 +1,304 @@
+#include "scene_text.hh"
+
+#include "axis.hh"
+#include "detail/mapped_file.hh"
+#include "detail/parse_number.hh"
+#include "material.hh"
+#include "matrix_operations.hh"
+#include "point_light.hh"
+#include "shearing.hh"
+#include "sphere.hh"
+#include "square_matrix.hh"
+#include "transformation.hh"
+
+#include <array>
+#include <cstddef>
+#include <istream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace cherry_blazer {
+
+namespace {
+
+// Splits the input into words, one line at a time: lines of text are read in place, lines of a
+// stream are read into a buffer.
+class Words {
+  public:
+    explicit Words(std::string_view text) : text_{text} {}
+    explicit Words(std::istream& input) : input_{&input} {}
+
+    // The next word, or an empty one at the end of the input.
+    std::string_view next() {
+        for (;;) {
+            while (position_ < line_.size() && is_space(line_[position_]))
+                ++position_;
+            if (position_ < line_.size() && line_[position_] != '#') {
+                auto const begin = position_;
+                while (position_ < line_.size() && !is_space(line_[position_]))
+                    ++position_;
+                return line_.substr(begin, position_ - begin);
+            }
+            if (!next_line())
+                return {};
+            ++line_number_;
+            position_ = 0;
+        }
+    }
+
+    // The next word, without consuming it.
+    std::string_view peek() {
+        auto const word = next();
+        position_ -= word.size();
+        return word;
+    }
+
+    [[nodiscard]] std::size_t line_number() const noexcept { return line_number_; }
+
+  private:
+    std::string_view text_;
+    std::istream* input_{nullptr};
+    std::string buffer_;
+    std::string_view line_;
+    std::size_t position_{0};
+    std::size_t line_number_{0};
+
+    bool next_line() {
+        if (input_ != nullptr) {
+            if (!std::getline(*input_, buffer_))
+                return false;
+            line_ = buffer_;
+            return true;
+        }
+        if (text_.empty())
+            return false;
+        auto const end = text_.find('\n');
+        line_ = text_.substr(0, end);
+        text_.remove_prefix(end == std::string_view::npos ? text_.size() : end + 1);
+        return true;
+    }
+
+    static bool is_space(char c) noexcept {
+        return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\v' || c == '\f';
+    }
+};
+
+class Loader {
+  public:
+    explicit Loader(Words words) : words_{std::move(words)} {}
+
+    Scene load() {
+        for (auto word = words_.next(); !word.empty(); word = words_.next()) {
+            try {
+                statement(word);
+            } catch (std::logic_error const& e) {
+                throw std::logic_error{"line " + std::to_string(words_.line_number()) + ": " +
+                                       e.what()};
+            }
+        }
+        return {World{std::move(spheres_), std::move(lights_)}, std::move(camera_)};
+    }
+
+  private:
+    Words words_;
+    std::vector<Sphere> spheres_;
+    std::vector<PointLight> lights_;
+    std::optional<Camera> camera_;
+
+    std::string_view word() {
+        auto const next = words_.next();
+        if (next.empty())
+            throw std::logic_error{"unexpected end of the description"};
+        return next;
+    }
+
+    double number() { return detail::to_double(word()); }
+
+    void keyword(std::string_view expected) {
+        if (word() != expected)
+            throw std::logic_error{"expected '" + std::string{expected} + "'"};
+    }
+
+    Vec3d vector() {
+        auto const x = number();
+        auto const y = number();
+        auto const z = number();
+        return Vec3d{x, y, z};
+    }
+
+    Point3d point() {
+        auto const x = number();
+        auto const y = number();
+        auto const z = number();
+        return Point3d{x, y, z};
+    }
+
+    Color color() {
+        auto const r = number();
+        auto const g = number();
+        auto const b = number();
+        return Color{r, g, b};
+    }
+
+    void statement(std::string_view keyword) {
+        if (keyword == "sphere") {
+            spheres_.emplace_back();
+        } else if (keyword == "light") {
+            light();
+        } else if (keyword == "camera") {
+            camera();
+        } else if (keyword == "translate") {
+            translate();
+        } else if (keyword == "scale") {
+            scale();
+        } else if (keyword == "rotate") {
+            rotate();
+        } else if (keyword == "shear") {
+            shear();
+        } else if (keyword == "color") {
+            material().color = color();
+        } else if (keyword == "ambient") {
+            material().ambient = number();
+        } else if (keyword == "diffuse") {
+            material().diffuse = number();
+        } else if (keyword == "specular") {
+            material().specular = number();
+        } else if (keyword == "shininess") {
+            material().shininess = number();
+        } else if (keyword == "reflective") {
+            material().reflective = number();
+        } else if (keyword == "transparency") {
+            material().transparency = number();
+        } else if (keyword == "refractive_index") {
+            material().refractive_index = number();
+        } else {
+            throw std::logic_error{"unknown keyword '" + std::string{keyword} + "'"};
+        }
+    }
+
+    void light() {
+        PointLight light{point(), color()};
+        if (words_.peek() == "radius") {
+            words_.next();
+            light.radius = number();
+        }
+        lights_.push_back(light);
+    }
+
+    void camera() {
+        auto const hsize = detail::to_integer<unsigned>(word());
+        auto const vsize = detail::to_integer<unsigned>(word());
+        auto const field_of_view = number();
+        keyword("from");
+        auto const from = point();
+        keyword("to");
+        auto const to = point();
+        keyword("up");
+        auto const up = vector();
+        camera_.emplace(hsize, vsize, field_of_view, view_transform(from, to, up));
+    }
+
+    Axis axis() {
+        auto const name = word();
+        if (name == "x")
+            return Axis::X;
+        if (name == "y")
+            return Axis::Y;
+        if (name == "z")
+            return Axis::Z;
+        throw std::logic_error{"expected x, y or z, got '" + std::string{name} + "'"};
+    }
+
+    ShearDirection shear_direction() {
+        auto const name = word();
+        if (name == "xy")
+            return Shear::X::AgainstY{};
+        if (name == "xz")
+            return Shear::X::AgainstZ{};
+        if (name == "yx")
+            return Shear::Y::AgainstX{};
+        if (name == "yz")
+            return Shear::Y::AgainstZ{};
+        if (name == "zx")
+            return Shear::Z::AgainstX{};
+        if (name == "zy")
+            return Shear::Z::AgainstY{};
+        throw std::logic_error{"expected xy, xz, yx, yz, zx or zy, got '" + std::string{name} +
+                               "'"};
+    }
+
+    void require_sphere(std::string_view what) const {
+        if (spheres_.empty())
+            throw std::logic_error{std::string{what} + " before any sphere"};
+    }
+
+    Material& material() {
+        require_sphere("material");
+        return spheres_.back().material;
+    }
+
+    // The inverse of each transformation is known, so the inverse of the sphere's transformation
+    // is composed alongside it instead of inverting the result.
+
+    void translate() {
+        auto const offset = vector();
+        transform(Mat4d::translation(offset), Mat4d::translation(-offset),
+                  Transformation::Kind::Translation);
+    }
+
+    void scale() {
+        auto const factors = vector();
+        if (factors[0] == 0. || factors[1] == 0. || factors[2] == 0.)
+            throw std::logic_error{"scaling by 0 is not invertible"};
+        transform(Mat4d::scaling(factors),
+                  Mat4d::scaling(Vec3d{1. / factors[0], 1. / factors[1], 1. / factors[2]}),
+                  Transformation::Kind::Scaling);
+    }
+
+    void rotate() {
+        auto const axis = this->axis();
+        auto const radians = number();
+        transform(Mat4d::rotation(axis, radians), Mat4d::rotation(axis, -radians),
+                  Transformation::Kind::Rotation);
+    }
+
+    void shear() {
+        auto const shearing = Mat4d::shearing(shear_direction());
+        // A shearing is the identity plus one element off the diagonal, and undone by subtracting
+        // that element instead.
+        auto inverse = shearing;
+        for (std::size_t row = 0; row < 3; ++row) {
+            for (std::size_t col = 0; col < 3; ++col) {
+                if (row != col)
+                    inverse(row, col) = -shearing(row, col);
+            }
+        }
+        transform(shearing, inverse, Transformation::Kind::Shearing);
+    }
+
+    // Applies transform after the ones the current sphere already has.
+    void transform(Mat4d const& transform, Mat4d const& inverse, Transformation::Kind kind) {
+        require_sphere("transformation");
+        auto& current = spheres_.back().transformation;
+        // Ray transform() moves only the origin for pure translations, so any other part makes
+        // the whole a non-translation.
+        if (current.kind != Transformation::Kind::Identity &&
+            kind == Transformation::Kind::Translation)
+            kind = current.kind;
+        current = Transformation{transform * current.mat, current.inv * inverse, kind};
+    }
+};
+
+} // namespace
+
+Scene load_scene_text(std::istream& input) { return Loader{Words{input}}.load(); }
+
+Scene load_scene_text(std::filesystem::path const& path) {
+    detail::MappedFile const file{path};
+    return Loader{Words{file.text()}}.load();
+}
+
+} // namespace cherry_blazer
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "camera.hh"
+#include "world.hh"
+
+#include <filesystem>
+#include <istream>
+#include <optional>
+
+namespace cherry_blazer {
+
+// Scene descriptions in text, for writing and editing by hand. A description is a sequence of
+// whitespace-separated words, which may be spread over lines freely; "#" starts a comment which
+// runs to the end of the line.
+//
+//   camera <hsize> <vsize> <field_of_view> from <x y z> to <x y z> up <x y z>
+//   light <x y z> <r g b> [radius <radius>]
+//   sphere
+//
+// After a sphere, any of the following change it, until the next sphere:
+//
+//   translate <x y z>
+//   scale <x y z>
+//   rotate x|y|z <radians>
+//   shear xy|xz|yx|yz|zx|zy        (e.g. xy: x moves in proportion to y)
+//   color <r g b>
+//   ambient|diffuse|specular|shininess <value>
+//   reflective|transparency|refractive_index <value>
+//
+// The transformations of a sphere apply in the order they are written, so "translate 0 0 5 scale
+// 2 2 2" moves the sphere to z = 5, then scales it (and its position) to z = 10. For example:
+//
+//   camera 400 200 1.047 from 0 1.5 -5 to 0 1 0 up 0 1 0
+//   light -10 10 -10 1 1 1
+//   sphere scale .5 .5 .5 translate 1.5 .5 -.5
+//       color .5 1 .1 diffuse .7 specular .3
+
+// What a description holds: the World, and the camera if it has one.
+struct Scene {
+    World world;
+    std::optional<Camera> camera;
+};
+
+// Reads a description. The input is streamed: only the current line is held besides the objects
+// read so far, and the objects go straight into the World's storage. Numbers are read with
+// std::from_chars, and the inverses of the transformations are composed from the inverses of
+// their parts, without inverting a matrix. The Bvh is built in parallel at the end. Throws
+// std::logic_error, naming the line, if the description is malformed.
+[[nodiscard]] Scene load_scene_text(std::istream& input);
+
+// Same, from a file, which is mapped into memory and read in place, without copying its lines.
+// Throws std::system_error if it cannot be opened or mapped.
+[[nodiscard]] Scene load_scene_text(std::filesystem::path const& path);
+
+} // namespace cherry_blazer
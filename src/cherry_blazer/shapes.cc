@@ -0,0 +1,204 @@
+#include "shapes.hh"
+
+#include "normal.hh"
+
+#include <algorithm>
+#include <cmath>
+
+namespace cherry_blazer {
+
+namespace {
+
+// Below this, a ray counts as parallel to a plane, and a point as on a cap.
+constexpr double epsilon = 1e-9;
+
+constexpr auto infinity = std::numeric_limits<double>::infinity();
+
+constexpr Aabb all_space{{-infinity, -infinity, -infinity}, {infinity, infinity, infinity}};
+
+// Caps of a cut cylinder or cone: crossings with the planes y = minimum and y = maximum where the
+// shape's radius there (squared) reaches.
+void caps(Ray const& ray, double minimum, double minimum_radius_squared, double maximum,
+          double maximum_radius_squared, Crossings& out) noexcept {
+    auto const& o = ray.origin;
+    auto const& d = ray.direction;
+    if (std::abs(d[1]) < epsilon)
+        return;
+    auto const cap = [&](double y, double radius_squared) {
+        auto const t = (y - o[1]) / d[1];
+        auto const x = o[0] + t * d[0];
+        auto const z = o[2] + t * d[2];
+        if (x * x + z * z <= radius_squared)
+            out.push_back(t);
+    };
+    cap(minimum, minimum_radius_squared);
+    cap(maximum, maximum_radius_squared);
+}
+
+// Keeps the crossing if it lies between the cuts.
+void push_within(Ray const& ray, double t, double minimum, double maximum,
+                 Crossings& out) noexcept {
+    auto const y = ray.origin[1] + t * ray.direction[1];
+    if (minimum < y && y < maximum)
+        out.push_back(t);
+}
+
+// Normal of a cut cylinder or cone at an object space point: on a cap if the point lies within
+// its radius (squared) at its height, on the side otherwise.
+template <typename Side>
+Vec3d cut_normal(Point3d const& p, double minimum, double minimum_radius_squared, double maximum,
+                 double maximum_radius_squared, Side const& side) noexcept {
+    auto const distance_squared = p[0] * p[0] + p[2] * p[2];
+    if (distance_squared < maximum_radius_squared && p[1] >= maximum - epsilon)
+        return Vec3d{0., 1., 0.};
+    if (distance_squared < minimum_radius_squared && p[1] <= minimum + epsilon)
+        return Vec3d{0., -1., 0.};
+    return side(distance_squared);
+}
+
+} // namespace
+
+Crossings crossings(Plane const& plane, Ray const& world_ray) noexcept {
+    auto const ray = to_object_space(world_ray, plane.transformation);
+    Crossings out;
+    if (std::abs(ray.direction[1]) >= epsilon)
+        out.push_back(-ray.origin[1] / ray.direction[1]);
+    return out;
+}
+
+Crossings crossings(Cube const& cube, Ray const& world_ray) noexcept {
+    auto const ray = to_object_space(world_ray, cube.transformation);
+    // Slabs: the ray is inside the cube where it is between the faces of all three axes. A ray in
+    // the plane of a face gives 0 * infinity = NaN, which std::max/min ignore here.
+    auto enter = -infinity;
+    auto leave = infinity;
+    for (std::size_t axis = 0; axis < 3; ++axis) {
+        auto const inverse = 1. / ray.direction[axis];
+        auto const near = (-1. - ray.origin[axis]) * inverse;
+        auto const far = (1. - ray.origin[axis]) * inverse;
+        enter = std::max(enter, std::min(near, far));
+        leave = std::min(leave, std::max(near, far));
+    }
+    Crossings out;
+    if (enter <= leave) {
+        out.push_back(enter);
+        out.push_back(leave);
+    }
+    return out;
+}
+
+Crossings crossings(Cylinder const& cylinder, Ray const& world_ray) noexcept {
+    auto const ray = to_object_space(world_ray, cylinder.transformation);
+    auto const& o = ray.origin;
+    auto const& d = ray.direction;
+    Crossings out;
+
+    // x^2 + z^2 = 1 along the ray; rays parallel to the axis never cross the side.
+    auto const a = d[0] * d[0] + d[2] * d[2];
+    if (a >= epsilon) {
+        auto const b = 2. * (o[0] * d[0] + o[2] * d[2]);
+        auto const c = o[0] * o[0] + o[2] * o[2] - 1.;
+        auto const discriminant = b * b - 4. * a * c;
+        if (discriminant >= 0.) {
+            auto const root = std::sqrt(discriminant);
+            push_within(ray, (-b - root) / (2. * a), cylinder.minimum, cylinder.maximum, out);
+            push_within(ray, (-b + root) / (2. * a), cylinder.minimum, cylinder.maximum, out);
+        }
+    }
+    if (cylinder.closed)
+        caps(ray, cylinder.minimum, 1., cylinder.maximum, 1., out);
+
+    std::sort(out.begin(), out.end());
+    return out;
+}
+
+Crossings crossings(Cone const& cone, Ray const& world_ray) noexcept {
+    auto const ray = to_object_space(world_ray, cone.transformation);
+    auto const& o = ray.origin;
+    auto const& d = ray.direction;
+    Crossings out;
+
+    // x^2 + z^2 = y^2 along the ray. With a = 0 the ray is parallel to the side and crosses the
+    // other nappe once, unless it also goes through the apex.
+    auto const a = d[0] * d[0] - d[1] * d[1] + d[2] * d[2];
+    auto const b = 2. * (o[0] * d[0] - o[1] * d[1] + o[2] * d[2]);
+    auto const c = o[0] * o[0] - o[1] * o[1] + o[2] * o[2];
+    if (std::abs(a) < epsilon) {
+        if (std::abs(b) >= epsilon)
+            push_within(ray, -c / b, cone.minimum, cone.maximum, out);
+    } else {
+        auto const discriminant = b * b - 4. * a * c;
+        if (discriminant >= 0.) {
+            auto const root = std::sqrt(discriminant);
+            push_within(ray, (-b - root) / (2. * a), cone.minimum, cone.maximum, out);
+            push_within(ray, (-b + root) / (2. * a), cone.minimum, cone.maximum, out);
+        }
+    }
+    if (cone.closed) {
+        caps(ray, cone.minimum, cone.minimum * cone.minimum, cone.maximum,
+             cone.maximum * cone.maximum, out);
+    }
+
+    std::sort(out.begin(), out.end());
+    return out;
+}
+
+Vec3d normal(Plane const& plane, Point3d const& /*at_world_point*/) noexcept {
+    return normal_to_world(plane.transformation, Vec3d{0., 1., 0.});
+}
+
+Vec3d normal(Cube const& cube, Point3d const& at_world_point) noexcept {
+    auto const p = to_object_space(cube.transformation, at_world_point);
+    // The point is on the face of the axis it is furthest along.
+    auto const x = std::abs(p[0]);
+    auto const y = std::abs(p[1]);
+    auto const z = std::abs(p[2]);
+    Vec3d object_normal{0., 0., p[2]};
+    if (x >= y && x >= z)
+        object_normal = Vec3d{p[0], 0., 0.};
+    else if (y >= z)
+        object_normal = Vec3d{0., p[1], 0.};
+    return normal_to_world(cube.transformation, object_normal);
+}
+
+Vec3d normal(Cylinder const& cylinder, Point3d const& at_world_point) noexcept {
+    auto const p = to_object_space(cylinder.transformation, at_world_point);
+    auto const object_normal =
+        cut_normal(p, cylinder.minimum, 1., cylinder.maximum, 1.,
+                   [&p](double /*distance_squared*/) { return Vec3d{p[0], 0., p[2]}; });
+    return normal_to_world(cylinder.transformation, object_normal);
+}
+
+Vec3d normal(Cone const& cone, Point3d const& at_world_point) noexcept {
+    auto const p = to_object_space(cone.transformation, at_world_point);
+    auto const object_normal =
+        cut_normal(p, cone.minimum, cone.minimum * cone.minimum, cone.maximum,
+                   cone.maximum * cone.maximum, [&p](double distance_squared) {
+                       auto const y = std::sqrt(distance_squared);
+                       return Vec3d{p[0], p[1] > 0. ? -y : y, p[2]};
+                   });
+    return normal_to_world(cone.transformation, object_normal);
+}
+
+Aabb bounds(Plane const& /*plane*/) noexcept { return all_space; }
+
+Aabb bounds(Cube const& cube) noexcept {
+    return bounds(Aabb{{-1., -1., -1.}, {1., 1., 1.}}, cube.transformation.mat);
+}
+
+Aabb bounds(Cylinder const& cylinder) noexcept {
+    if (!std::isfinite(cylinder.minimum) || !std::isfinite(cylinder.maximum))
+        return all_space;
+    return bounds(Aabb{{-1., cylinder.minimum, -1.}, {1., cylinder.maximum, 1.}},
+                  cylinder.transformation.mat);
+}
+
+Aabb bounds(Cone const& cone) noexcept {
+    if (!std::isfinite(cone.minimum) || !std::isfinite(cone.maximum))
+        return all_space;
+    auto const radius = std::max(std::abs(cone.minimum), std::abs(cone.maximum));
+    return bounds(Aabb{{-radius, cone.minimum, -radius}, {radius, cone.maximum, radius}},
+                  cone.transformation.mat);
+}
+
+} // namespace cherry_blazer
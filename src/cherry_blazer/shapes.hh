@@ -0,0 +1,79 @@
+#pragma once
+
+#include "bvh.hh"
+#include "material.hh"
+#include "point.hh"
+#include "ray.hh"
+#include "transformation.hh"
+#include "vector.hh"
+
+#include <boost/container/static_vector.hpp>
+
+#include <cstdint>
+#include <limits>
+
+namespace cherry_blazer {
+
+// Primitives besides Sphere and Mesh. Like Sphere, each is a unit shape in its own object space,
+// which its transformation places in the world. They are plain structs with no virtual functions:
+// the World keeps each type in an array of its own and runs that type's kernel over it.
+
+// The plane y = 0.
+struct Plane {
+    Transformation transformation;
+    Material material;
+};
+
+// The cube [-1;1]^3.
+struct Cube {
+    Transformation transformation;
+    Material material;
+};
+
+// The cylinder of radius 1 around the y axis, cut to minimum < y < maximum. Closed cylinders have
+// caps at both cuts, making them solid.
+struct Cylinder {
+    Transformation transformation;
+    Material material;
+    double minimum{-std::numeric_limits<double>::infinity()};
+    double maximum{std::numeric_limits<double>::infinity()};
+    bool closed{false};
+};
+
+// The double cone x^2 + z^2 = y^2, with its apex at the origin, cut like Cylinder. Closed cones
+// have caps at both cuts.
+struct Cone {
+    Transformation transformation;
+    Material material;
+    double minimum{-std::numeric_limits<double>::infinity()};
+    double maximum{std::numeric_limits<double>::infinity()};
+    bool closed{false};
+};
+
+// Which kind of primitive a hit is on (see Hit).
+enum class Primitive : std::uint8_t { Sphere, Plane, Cube, Cylinder, Cone, Csg };
+
+// Values of t at which a ray crosses the surface of a shape, in increasing order. None of the
+// shapes is crossed more than four times, so the list never allocates.
+using Crossings = boost::container::static_vector<double, 4>;
+
+// The kernels: closed-form, in object space, without allocation. The ray is in world space.
+[[nodiscard]] Crossings crossings(Plane const& plane, Ray const& ray) noexcept;
+[[nodiscard]] Crossings crossings(Cube const& cube, Ray const& ray) noexcept;
+[[nodiscard]] Crossings crossings(Cylinder const& cylinder, Ray const& ray) noexcept;
+[[nodiscard]] Crossings crossings(Cone const& cone, Ray const& ray) noexcept;
+
+// Unit normals at points on the surfaces, in world space.
+[[nodiscard]] Vec3d normal(Plane const& plane, Point3d const& at_world_point) noexcept;
+[[nodiscard]] Vec3d normal(Cube const& cube, Point3d const& at_world_point) noexcept;
+[[nodiscard]] Vec3d normal(Cylinder const& cylinder, Point3d const& at_world_point) noexcept;
+[[nodiscard]] Vec3d normal(Cone const& cone, Point3d const& at_world_point) noexcept;
+
+// Smallest boxes around the shapes. Unbounded shapes (planes, uncut cylinders and cones) get the
+// box of all space, with infinite bounds on every axis.
+[[nodiscard]] Aabb bounds(Plane const& plane) noexcept;
+[[nodiscard]] Aabb bounds(Cube const& cube) noexcept;
+[[nodiscard]] Aabb bounds(Cylinder const& cylinder) noexcept;
+[[nodiscard]] Aabb bounds(Cone const& cone) noexcept;
+
+} // namespace cherry_blazer
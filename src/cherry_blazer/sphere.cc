@@ -1,9 +1,34 @@
 #include "sphere.hh"
 
+#include <limits>
+#include <stdexcept>
+
 namespace cherry_blazer {
 
+Sphere::Sphere() : id_{next_id()} {}
+
 Sphere::Sphere(Transformation const& transformation)
-    : transformation{transformation}, id_{++id_counter} {}
+    : transformation{transformation}, id_{next_id()} {}
+
+unsigned Sphere::next_id() {
+    // The ids of the block this thread is handing out: [next, end).
+    thread_local unsigned next = 0;
+    thread_local unsigned end = 0;
+
+    if (next == end) {
+        // Only uniqueness is needed, no ordering with other memory. A compare-exchange rather than
+        // fetch_add, so that the counter never wraps around into ids handed out already.
+        auto block = next_id_block.load(std::memory_order_relaxed);
+        do {
+            if (block > std::numeric_limits<unsigned>::max() - id_block_size)
+                throw std::logic_error{"Sphere ids exhausted"};
+        } while (!next_id_block.compare_exchange_weak(block, block + id_block_size,
+                                                      std::memory_order_relaxed));
+        next = block;
+        end = block + id_block_size;
+    }
+    return next++;
+}
 
 unsigned Sphere::id() const { return id_; }
 
@@ -3,6 +3,7 @@
 #include "material.hh"
 #include "transformation.hh"
 
+#include <atomic>
 #include <memory>
 
 namespace cherry_blazer {
@@ -13,16 +14,26 @@ class Sphere {
     Transformation transformation;
     Material material;
 
-    Sphere() : transformation{}, material{}, id_{++id_counter} {}
+    Sphere();
     Sphere(Transformation const& transformation);
 
+    // Unique among all spheres created by the process, on any thread. Copies share the id. The
+    // exception are spheres loaded from a scene file (see SceneFile), which keep the ids they were
+    // saved with, so they may share their id with a sphere created by the loading process.
     [[nodiscard]] unsigned id() const;
 
+    // Ids are handed out to each thread in blocks of this many, so that the shared counter is
+    // touched once per block instead of once per sphere.
+    static constexpr unsigned id_block_size = 1024;
+
   private:
     unsigned id_;
 
+    [[nodiscard]] static unsigned next_id();
+
+    // First id of the next unclaimed block. Ids start at 1.
     // NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
-    static inline constinit unsigned id_counter = 0;
+    static inline constinit std::atomic<unsigned> next_id_block{1};
 };
 
 bool operator==(Sphere const& lhs, Sphere const& rhs);
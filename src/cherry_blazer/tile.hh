@@ -0,0 +1,13 @@
+#pragma once
+
+namespace cherry_blazer {
+
+// Rectangle of pixels, with (x, y) being its top left pixel.
+struct Tile {
+    unsigned x;
+    unsigned y;
+    unsigned width;
+    unsigned height;
+};
+
+} // namespace cherry_blazer
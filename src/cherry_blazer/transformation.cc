@@ -1,8 +1,32 @@
 #include "transformation.hh"
 
+#include "matrix_operations.hh"
+#include "parallel.hh"
+
+#include <cstddef>
+#include <stdexcept>
+
 namespace cherry_blazer {
 
-Transformation::Transformation(Mat4d const& mat, Kind const& kind) : mat{mat}, kind{kind} {}
+Transformation::Transformation(Mat4d const& mat, Kind const& kind)
+    : Transformation{mat, inverse(mat), kind} {}
+
+Transformation::Transformation(Mat4d const& mat, Mat4d const& inv, Kind const& kind)
+    : mat{mat}, inv{inv}, inv_transpose{transpose(inv)}, kind{kind} {}
+
+Transformation Transformation::inverted() const { return {inv, mat, kind}; }
+
+void make_transformations(std::span<Mat4d const> mats, Transformation::Kind kind,
+                          std::span<Transformation> out) {
+    if (mats.size() != out.size())
+        throw std::logic_error{"make_transformations: need one output per matrix"};
+
+    constexpr std::size_t grain = 1024;
+    parallel_for(mats.size(), grain, [&](std::size_t begin, std::size_t end) {
+        for (auto i = begin; i < end; ++i)
+            out[i] = Transformation{mats[i], kind};
+    });
+}
 
 std::ostream& operator<<(std::ostream& os, Transformation::Kind const& kind) {
     switch (kind) {
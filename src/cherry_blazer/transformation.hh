@@ -3,18 +3,37 @@
 
 #include <memory>
 #include <ostream>
+#include <span>
 
 namespace cherry_blazer {
 
 class Transformation {
   public:
     Mat4d mat;
+    // Inverse of mat, computed once on construction: intersection tests work in object space and
+    // need it for every ray.
+    Mat4d inv;
+    // Transpose of inv, which takes normals to world space. Cached for the same reason.
+    Mat4d inv_transpose;
     enum class Kind { Identity, Translation, Scaling, Rotation, Shearing } kind;
 
-    Transformation() : mat{Mat4d::identity()}, kind{Kind::Identity} {}
+    Transformation()
+        : mat{Mat4d::identity()}, inv{Mat4d::identity()}, inv_transpose{Mat4d::identity()},
+          kind{Kind::Identity} {}
+    // Throws std::logic_error if mat is not invertible.
     Transformation(Mat4d const& mat, Kind const& kind);
+    // For when the inverse is already known, e.g. when it is a product of known inverses.
+    Transformation(Mat4d const& mat, Mat4d const& inv, Kind const& kind);
+
+    // The transformation which undoes this one.
+    [[nodiscard]] Transformation inverted() const;
 };
 
+// out[i] = Transformation{mats[i], kind}, with the inverses computed in parallel, for scenes of
+// many objects. Throws std::logic_error if the sizes differ or a matrix is not invertible.
+void make_transformations(std::span<Mat4d const> mats, Transformation::Kind kind,
+                          std::span<Transformation> out);
+
 std::ostream& operator<<(std::ostream& os, Transformation::Kind const& kind);
 
 } // namespace cherry_blazer
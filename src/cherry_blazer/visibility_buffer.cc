@@ -0,0 +1,235 @@
+#include "visibility_buffer.hh"
+
+#include "footprint.hh"
+#include "ray.hh"
+#include "vector_operations.hh"
+
+#include <boost/assert.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace cherry_blazer {
+
+namespace {
+
+// Marks pixels which no object covers.
+constexpr Hit no_hit{std::numeric_limits<double>::infinity(),
+                     std::numeric_limits<std::uint32_t>::max()};
+
+// Coverage or depth this close to changing, relative to the magnitudes involved, is left to the
+// exact intersection, so that rounding cannot make the buffer disagree with World::closest_hit().
+constexpr double tolerance = 1e-9;
+
+// Pixels an object, instance or mesh is drawn over (see screen_footprint()), and its index.
+struct Footprint {
+    Tile tile;
+    std::uint32_t index;
+};
+
+// Footprints in the order a sweep down the image meets them.
+class Sweep {
+  public:
+    explicit Sweep(std::vector<Footprint> footprints) : footprints_{std::move(footprints)} {
+        std::stable_sort(footprints_.begin(), footprints_.end(),
+                         [](Footprint const& lhs, Footprint const& rhs) {
+                             return lhs.tile.y < rhs.tile.y;
+                         });
+    }
+
+    // The footprints covering row y, which must be one more than in the previous call (0 first).
+    std::span<Footprint const> row(unsigned y) {
+        std::erase_if(active_, [y](Footprint const& footprint) {
+            return footprint.tile.y + footprint.tile.height <= y;
+        });
+        while (next_ < footprints_.size() && footprints_[next_].tile.y == y)
+            active_.push_back(footprints_[next_++]);
+        return active_;
+    }
+
+    // The footprints covering the row of the last call to row().
+    [[nodiscard]] std::span<Footprint const> active() const { return active_; }
+
+  private:
+    std::vector<Footprint> footprints_;
+    std::size_t next_{0};
+    std::vector<Footprint> active_;
+};
+
+template <typename T, typename Box>
+Sweep sweep(std::span<T const> things, Camera const& camera, Box const& box) {
+    std::vector<Footprint> footprints;
+    for (std::size_t i = 0; i < things.size(); ++i) {
+        if (auto const footprint = screen_footprint(box(things[i]), camera))
+            footprints.push_back({*footprint, static_cast<std::uint32_t>(i)});
+    }
+    return Sweep{std::move(footprints)};
+}
+
+// A sphere in its own space, where it is the unit sphere, as seen by the pixels' rays: they start
+// at eye and go along top_left + right * x + down * y (not normalized, so that a ray's parameter t
+// is the same in world space and, for all objects, along the same ray).
+struct Outline {
+    Vec3d eye;
+    Vec3d top_left;
+    Vec3d right;
+    Vec3d down;
+    // How far outside the sphere the eye is: |eye|^2 - 1.
+    double outside;
+};
+
+Outline outline(Sphere const& sphere, ImagePlane const& plane) {
+    auto const eye = to_object_space(Ray{plane.eye, plane.top_left - plane.eye},
+                                     sphere.transformation);
+    auto const right = to_object_space(Ray{plane.eye, plane.right}, sphere.transformation);
+    auto const down = to_object_space(Ray{plane.eye, plane.down}, sphere.transformation);
+    Vec3d const center_to_eye{eye.origin[0], eye.origin[1], eye.origin[2]};
+    return {center_to_eye, eye.direction, right.direction, down.direction,
+            dot(center_to_eye, center_to_eye) - 1.};
+}
+
+} // namespace
+
+VisibilityBuffer::VisibilityBuffer(World const& world, Camera const& camera)
+    : width_{camera.hsize()}, height_{camera.vsize()},
+      hits_{std::make_unique<Hit[]>(width_ * height_)} {
+    std::fill(hits_.get(), hits_.get() + width_ * height_, no_hit);
+
+    auto const plane = camera.image_plane();
+    auto const objects = world.objects();
+    auto spheres = sweep(objects, camera, [](Sphere const& sphere) -> Sphere const& {
+        return sphere;
+    });
+    std::vector<Outline> outlines(objects.size());
+    for (std::size_t i = 0; i < objects.size(); ++i)
+        outlines[i] = outline(objects[i], plane);
+    auto instances =
+        sweep(world.instances(), camera, [](Instance const& instance) { return bounds(instance); });
+    auto meshes = sweep(world.meshes(), camera, [](Mesh const& mesh) { return bounds(mesh); });
+
+    // Per row, spheres are scan-converted into depths first, then each pixel's ray is built once,
+    // to intersect the nearest sphere exactly and to trace whatever else covers the pixel.
+    std::vector<Ray> rays(width_);
+    std::vector<double> depths(width_);
+    std::vector<std::uint32_t> nearest(width_);
+    std::vector<bool> uncertain(width_);
+    std::vector<std::uint32_t> candidates;
+    for (auto y{0U}; y < height(); ++y) {
+        std::fill(depths.begin(), depths.end(), std::numeric_limits<double>::infinity());
+        std::fill(nearest.begin(), nearest.end(), no_hit.object);
+        std::fill(uncertain.begin(), uncertain.end(), false);
+        for (auto const& [tile, object] : spheres.row(y)) {
+            // Along the row, the direction is start + right * x: |direction|^2 is a quadratic in x,
+            // and half of the b of the ray-sphere quadratic, dot(direction, eye), is linear.
+            auto const& o = outlines[object];
+            Vec3d const start = o.top_left + o.down * double(y);
+            auto const half_b0 = dot(start, o.eye);
+            auto const half_b1 = dot(o.right, o.eye);
+            auto const a0 = dot(start, start);
+            auto const a1 = 2. * dot(start, o.right);
+            auto const a2 = dot(o.right, o.right);
+            for (auto x{tile.x}; x < tile.x + tile.width; ++x) {
+                auto const fx = double(x);
+                auto const half_b = half_b0 + fx * half_b1;
+                auto const a = a0 + fx * (a1 + fx * a2);
+                auto const discriminant = half_b * half_b - a * o.outside;
+                auto const scale = half_b * half_b + std::abs(a * o.outside);
+                if (discriminant < -tolerance * scale)
+                    continue; // inside the footprint, but outside the sphere's outline
+                if (discriminant <= tolerance * scale) {
+                    uncertain[x] = true; // grazing
+                    continue;
+                }
+                // the nearer of the two intersections in front of the eye
+                auto const root = std::sqrt(discriminant);
+                auto const near = -half_b - root;
+                auto const far = -half_b + root;
+                if (std::abs(near) <= tolerance * (std::abs(half_b) + root) ||
+                    std::abs(far) <= tolerance * (std::abs(half_b) + root)) {
+                    uncertain[x] = true; // the eye is on the sphere
+                    continue;
+                }
+                auto const t = (near >= 0. ? near : far) / a;
+                if (t < 0. || t >= depths[x] * (1. + tolerance))
+                    continue;
+                if (t > depths[x] * (1. - tolerance))
+                    uncertain[x] = true; // as near as another sphere
+                if (t < depths[x]) {
+                    depths[x] = t;
+                    nearest[x] = object;
+                }
+            }
+        }
+
+        auto const row = spheres.active();
+        for (auto x{0U}; x < width(); ++x) {
+            rays[x] = camera.ray_for_pixel(x, y);
+            auto& hit = hits_[index(x, y)];
+            std::optional<Hit> exact;
+            if (!uncertain[x] && nearest[x] != no_hit.object)
+                exact = world.closest_hit(rays[x], std::span{&nearest[x], 1});
+            if (uncertain[x] || (nearest[x] != no_hit.object && !exact)) {
+                // Too close to call: intersect all spheres over the pixel, in order.
+                candidates.clear();
+                for (auto const& [tile, object] : row) {
+                    if (tile.x <= x && x < tile.x + tile.width)
+                        candidates.push_back(object);
+                }
+                std::sort(candidates.begin(), candidates.end());
+                exact = world.closest_hit(rays[x], candidates);
+            }
+            if (exact)
+                hit = *exact;
+        }
+
+        auto const draw = [&](Tile const& tile, auto const& closest_hit) {
+            for (auto x{tile.x}; x < tile.x + tile.width; ++x) {
+                auto& hit = hits_[index(x, y)];
+                if (auto const nearer = closest_hit(rays[x], hit.t))
+                    hit = *nearer;
+            }
+        };
+        for (auto const& [tile, instance] : instances.row(y)) {
+            draw(tile, [&world, i = instance](Ray const& ray, double max_t) {
+                return world.closest_instance_hit(ray, i, max_t);
+            });
+        }
+        for (auto const& [tile, mesh] : meshes.row(y)) {
+            draw(tile, [&world, i = mesh](Ray const& ray, double max_t) {
+                return world.closest_mesh_hit(ray, i, max_t);
+            });
+        }
+        // The other shapes, planes in particular, may cover any pixel.
+        if (world.has_shapes()) {
+            draw({0, y, width(), 1}, [&world](Ray const& ray, double max_t) {
+                return world.closest_shape_hit(ray, max_t);
+            });
+        }
+    }
+}
+
+unsigned VisibilityBuffer::width() const { return unsigned(width_); }
+
+unsigned VisibilityBuffer::height() const { return unsigned(height_); }
+
+std::optional<Hit> VisibilityBuffer::hit(unsigned x, unsigned y) const {
+    auto const& hit = hits_[index(x, y)];
+    if (hit.object == no_hit.object)
+        return std::nullopt;
+    return hit;
+}
+
+std::size_t VisibilityBuffer::index(unsigned x, unsigned y) const {
+    BOOST_VERIFY(x < width_);
+    BOOST_VERIFY(y < height_);
+    return y * width_ + x;
+}
+
+} // namespace cherry_blazer
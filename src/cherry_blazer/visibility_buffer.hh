@@ -0,0 +1,38 @@
+#pragma once
+
+#include "camera.hh"
+#include "world.hh"
+
+#include <cstddef>
+#include <memory>
+#include <optional>
+
+namespace cherry_blazer {
+
+// Primary visibility by rasterization: for every pixel, the nearest object its camera ray (see
+// Camera::ray_for_pixel()) hits, and where. The image is swept by scanlines. Each sphere covers
+// the pixels of a row where a quadratic in x is not negative, its depth being the root of another,
+// with coefficients set once per row, so its outline is scan-converted over its screen footprint
+// (see screen_footprint()) at a few multiplications per pixel. Only the nearest sphere of a pixel
+// is then intersected with the pixel's ray, computed once and shared by the instances and meshes,
+// drawn over the footprints of their boxes, and the other shapes. The cost grows with the area
+// the objects cover, not with pixels times objects.
+class VisibilityBuffer {
+  public:
+    VisibilityBuffer(World const& world, Camera const& camera);
+
+    [[nodiscard]] unsigned width() const;
+    [[nodiscard]] unsigned height() const;
+
+    // The same hit as world.closest_hit(camera.ray_for_pixel(x, y)), or nothing.
+    [[nodiscard]] std::optional<Hit> hit(unsigned x, unsigned y) const;
+
+  private:
+    std::size_t width_;
+    std::size_t height_;
+    std::unique_ptr<Hit[]> hits_;
+
+    [[nodiscard]] std::size_t index(unsigned x, unsigned y) const;
+};
+
+} // namespace cherry_blazer
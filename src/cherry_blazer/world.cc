@@ -0,0 +1,387 @@
+#include "world.hh"
+
+#include "intersection.hh"
+#include "normal.hh"
+#include "point_operations.hh"
+#include "reflect.hh"
+#include "shapes.hh"
+#include "vector_operations.hh"
+
+#include <boost/container/small_vector.hpp>
+
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+namespace cherry_blazer {
+
+namespace {
+
+// Nearest intersection in front of the ray origin with objects[index(i)], i in [0;count).
+template <typename Index>
+std::optional<Hit> nearest_hit(std::span<Sphere const> objects, Ray const& ray, std::size_t count,
+                               Index const& index) {
+    std::optional<Hit> closest;
+    auto closest_t = std::numeric_limits<double>::max();
+    for (std::size_t i = 0; i < count; ++i) {
+        auto const object = index(i);
+        auto const interval = intersect_interval(objects[object], ray);
+        if (!interval)
+            continue;
+        // the nearer of the two intersections in front of the origin
+        auto const t = interval->first >= 0. ? interval->first : interval->second;
+        if (t >= 0. && t < closest_t) {
+            closest_t = t;
+            closest = Hit{t, object};
+        }
+    }
+    return closest;
+}
+
+// Nearest intersection in front of the ray origin and before max_t, with the objects of bvh.
+std::optional<Hit> nearest_hit(Bvh const& bvh, std::span<Sphere const> objects, Ray const& ray,
+                               double max_t, std::uint32_t instance) {
+    std::optional<Hit> closest;
+    bvh.traverse(ray, max_t, [&](std::uint32_t object, double& closest_t) {
+        auto const interval = intersect_interval(objects[object], ray);
+        if (!interval)
+            return false;
+        // the nearer of the two intersections in front of the origin
+        auto const t = interval->first >= 0. ? interval->first : interval->second;
+        if (t >= 0. && t < closest_t) {
+            closest_t = t;
+            closest = Hit{t, object, instance};
+        }
+        return false;
+    });
+    return closest;
+}
+
+// Whether any of the objects of bvh blocks the ray between its origin and ray.position(max_t).
+bool blocked(Bvh const& bvh, std::span<Sphere const> objects, Ray const& ray, double max_t) {
+    auto found = false;
+    bvh.traverse(ray, max_t, [&](std::uint32_t object, double& /*max_t*/) {
+        auto const interval = intersect_interval(objects[object], ray);
+        if (!interval)
+            return false;
+        auto const [enter, leave] = *interval;
+        found = (enter > 0. && enter < max_t) || (leave > 0. && leave < max_t);
+        return found;
+    });
+    return found;
+}
+
+// Throws std::logic_error if an instance has no group.
+std::vector<Aabb> bounds_of(std::span<Instance const> instances) {
+    std::vector<Aabb> boxes;
+    boxes.reserve(instances.size());
+    for (auto const& instance : instances) {
+        if (!instance.group)
+            throw std::logic_error{"World: instance without a group"};
+        boxes.push_back(bounds(instance));
+    }
+    return boxes;
+}
+
+std::vector<Aabb> bounds_of(std::span<Mesh const> meshes) {
+    std::vector<Aabb> boxes;
+    boxes.reserve(meshes.size());
+    for (auto const& mesh : meshes)
+        boxes.push_back(bounds(mesh));
+    return boxes;
+}
+
+} // namespace
+
+World::World(std::vector<Sphere> objects, std::vector<PointLight> lights,
+             std::vector<Instance> instances, std::vector<Mesh> meshes, Shapes shapes)
+    : objects_{std::move(objects)}, lights_{std::move(lights)}, bvh_{objects_.span()},
+      instances_{std::move(instances)}, instance_bvh_{bounds_of(instances_)},
+      meshes_{std::move(meshes)}, mesh_bvh_{bounds_of(meshes_)},
+      planes_{std::move(shapes.planes)}, cubes_{std::move(shapes.cubes)},
+      cylinders_{std::move(shapes.cylinders)}, cones_{std::move(shapes.cones)},
+      csgs_{std::move(shapes.csgs)} {}
+
+World::World(std::span<Sphere> objects, std::span<PointLight> lights, Bvh bvh)
+    : objects_{objects}, lights_{lights}, bvh_{std::move(bvh)} {}
+
+std::span<Sphere const> World::objects() const { return objects_.span(); }
+
+std::span<PointLight const> World::lights() const { return lights_.span(); }
+
+std::span<Sphere> World::objects() { return objects_.span(); }
+
+std::span<PointLight> World::lights() { return lights_.span(); }
+
+std::span<Instance const> World::instances() const { return instances_; }
+
+std::span<Mesh const> World::meshes() const { return meshes_; }
+
+std::span<Mesh> World::meshes() { return meshes_; }
+
+std::span<Plane const> World::planes() const { return planes_.shapes(); }
+
+std::span<Cube const> World::cubes() const { return cubes_.shapes(); }
+
+std::span<Cylinder const> World::cylinders() const { return cylinders_.shapes(); }
+
+std::span<Cone const> World::cones() const { return cones_.shapes(); }
+
+std::span<Csg const> World::csgs() const { return csgs_.shapes(); }
+
+std::span<Plane> World::planes() { return planes_.shapes(); }
+
+std::span<Cube> World::cubes() { return cubes_.shapes(); }
+
+std::span<Cylinder> World::cylinders() { return cylinders_.shapes(); }
+
+std::span<Cone> World::cones() { return cones_.shapes(); }
+
+Sphere const& World::object(std::uint32_t object, std::uint32_t instance) const {
+    if (instance == no_instance)
+        return objects()[object];
+    return instances_[instance].group->objects()[object];
+}
+
+Material const& World::material(Surface const& surface) const {
+    if (surface.mesh != no_mesh)
+        return meshes_[surface.mesh].material;
+    return visit_object(surface.object, surface.instance, surface.primitive, surface.part,
+                        [](auto const& object) -> Material const& { return object.material; });
+}
+
+Bvh const& World::bvh() const { return bvh_; }
+
+void World::rebuild() {
+    bvh_ = Bvh{objects()};
+    instance_bvh_ = Bvh{bounds_of(instances_)};
+    mesh_bvh_ = Bvh{bounds_of(meshes_)};
+    planes_.rebuild();
+    cubes_.rebuild();
+    cylinders_.rebuild();
+    cones_.rebuild();
+    csgs_.rebuild();
+}
+
+std::optional<Hit> World::closest_hit(Ray const& ray) const {
+    auto closest = nearest_hit(bvh_, objects(), ray, std::numeric_limits<double>::infinity(),
+                               no_instance);
+    // Each level only looks for hits nearer than those of the levels before.
+    auto const max_t = [&closest] {
+        return closest ? closest->t : std::numeric_limits<double>::infinity();
+    };
+    instance_bvh_.traverse(ray, max_t(), [&](std::uint32_t instance, double& closest_t) {
+        if (auto const hit = closest_instance_hit(ray, instance, closest_t)) {
+            closest_t = hit->t;
+            closest = hit;
+        }
+        return false;
+    });
+    mesh_bvh_.traverse(ray, max_t(), [&](std::uint32_t mesh, double& closest_t) {
+        if (auto const hit = closest_mesh_hit(ray, mesh, closest_t)) {
+            closest_t = hit->t;
+            closest = hit;
+        }
+        return false;
+    });
+    if (auto const hit = closest_shape_hit(ray, max_t()))
+        closest = hit;
+    return closest;
+}
+
+std::optional<Hit> World::closest_hit(Ray const& ray,
+                                      std::span<std::uint32_t const> candidates) const {
+    return nearest_hit(objects(), ray, candidates.size(),
+                       [candidates](std::size_t i) { return candidates[i]; });
+}
+
+std::optional<Hit> World::closest_instance_hit(Ray const& ray, std::uint32_t instance,
+                                               double max_t) const {
+    auto const& placed = instances_[instance];
+    auto const& group = *placed.group;
+    return nearest_hit(group.bvh(), group.objects(), to_object_space(ray, placed.transformation),
+                       max_t, instance);
+}
+
+std::optional<Hit> World::closest_mesh_hit(Ray const& ray, std::uint32_t mesh,
+                                           double max_t) const {
+    auto const hit = meshes_[mesh].closest_hit(ray, max_t);
+    if (!hit)
+        return std::nullopt;
+    return Hit{hit->first.t, hit->second, no_instance, mesh};
+}
+
+std::optional<Hit> World::closest_shape_hit(Ray const& ray, double max_t) const {
+    std::optional<Hit> closest;
+    for_each_shape_array([&](auto const& shapes, Primitive primitive) {
+        if (auto const hit = shapes.closest_hit(ray, max_t)) {
+            max_t = hit->t;
+            closest = Hit{hit->t, hit->shape, no_instance, no_mesh, primitive, hit->part};
+        }
+    });
+    return closest;
+}
+
+bool World::has_shapes() const {
+    return !planes().empty() || !cubes().empty() || !cylinders().empty() || !cones().empty() ||
+           !csgs().empty();
+}
+
+bool World::occluded(Ray const& ray, double max_t) const {
+    if (blocked(bvh_, objects(), ray, max_t))
+        return true;
+
+    auto found = false;
+    instance_bvh_.traverse(ray, max_t, [&](std::uint32_t instance, double& /*max_t*/) {
+        auto const& placed = instances_[instance];
+        auto const& group = *placed.group;
+        found = blocked(group.bvh(), group.objects(), to_object_space(ray, placed.transformation),
+                        max_t);
+        return found;
+    });
+    if (found)
+        return true;
+
+    mesh_bvh_.traverse(ray, max_t, [&](std::uint32_t mesh, double& /*max_t*/) {
+        found = meshes_[mesh].occluded(ray, max_t);
+        return found;
+    });
+    if (found)
+        return true;
+
+    for_each_shape_array([&](auto const& shapes, Primitive /*primitive*/) {
+        found = found || shapes.occluded(ray, max_t);
+    });
+    return found;
+}
+
+void World::shadows(Point3d const& point, Vec3d const& normal_vector,
+                    std::span<bool> in_shadow) const {
+    if (in_shadow.size() != lights().size())
+        throw std::logic_error{"World::shadows: need one shadow flag per light"};
+
+    for (std::size_t i = 0; i < lights().size(); ++i) {
+        auto const& light = lights()[i];
+        auto const to_light = light.position - point;
+        auto const distance_squared = dot(to_light, to_light);
+        if (distance_squared >= light.radius * light.radius || dot(to_light, normal_vector) < 0.) {
+            in_shadow[i] = true;
+            continue;
+        }
+        // Unnormalized direction, so the light is at t = 1 and no square root is needed.
+        in_shadow[i] = occluded(Ray{point, to_light}, 1.);
+    }
+}
+
+Color World::color_at(Ray const& ray, SpecularQuality quality) const {
+    auto const hit = closest_hit(ray);
+    if (!hit)
+        return Color{0., 0., 0.};
+    return shade(ray, *hit, quality);
+}
+
+Surface World::surface(Ray const& ray, Hit const& hit) const {
+    auto const point = ray.position(hit.t);
+    auto const eye_vector = -normalize(ray.direction);
+    auto normal_vector = Vec3d{};
+    if (hit.mesh != no_mesh) {
+        normal_vector = meshes_[hit.mesh].normal(hit.object);
+    } else if (hit.primitive == Primitive::Csg) {
+        normal_vector = csgs_.shapes()[hit.object].normal(hit.part, point);
+    } else if (hit.instance == no_instance) {
+        normal_vector =
+            visit_object(hit.object, no_instance, hit.primitive, hit.part,
+                         [&point](auto const& object) { return normal(object, point); });
+    } else {
+        auto const& placed = instances_[hit.instance];
+        auto const group_point = to_object_space(placed.transformation, point);
+        normal_vector = normal_to_world(placed.transformation,
+                                        normal(placed.group->objects()[hit.object], group_point));
+    }
+    // the hit is inside the object, so light it from the inside
+    auto const inside = dot(normal_vector, eye_vector) < 0.;
+    if (inside)
+        normal_vector = -normal_vector;
+    return {point + normal_vector * shadow_bias,
+            eye_vector,
+            normal_vector,
+            hit.object,
+            hit.instance,
+            hit.mesh,
+            hit.primitive,
+            hit.part,
+            inside};
+}
+
+Color World::shade(Surface const& surface, std::span<bool const> in_shadow,
+                   SpecularQuality quality) const {
+    return lighting(material(surface), lights(), surface.point, surface.eye_vector,
+                    surface.normal_vector, in_shadow, quality);
+}
+
+TraceLimits const& World::trace_limits() const { return trace_limits_; }
+
+void World::set_trace_limits(TraceLimits const& limits) { trace_limits_ = limits; }
+
+Color World::shade(Ray const& ray, Hit const& hit, SpecularQuality quality) const {
+    // Scenes rarely have more than a handful of lights, so the flags usually stay on the stack.
+    boost::container::small_vector<bool, 8> in_shadow(lights().size());
+    std::span<bool> const flags{in_shadow.data(), in_shadow.size()};
+
+    // Reflected and refracted rays wait on an explicit stack instead of recursive calls, so that
+    // deep bounces cannot overflow the call stack. Each one's throughput is its weight in the
+    // color. Taking the last one first keeps the stack no deeper than max_depth + 1.
+    struct Bounce {
+        Ray ray;
+        Hit hit;
+        Color throughput;
+        unsigned depth;
+    };
+    boost::container::small_vector<Bounce, 8> pending{{ray, hit, Color{1., 1., 1.}, 0}};
+
+    Color color{0., 0., 0.};
+    while (!pending.empty()) {
+        auto const bounce = pending.back();
+        pending.pop_back();
+
+        auto const hit_surface = surface(bounce.ray, bounce.hit);
+        shadows(hit_surface.point, hit_surface.normal_vector, flags);
+        color += bounce.throughput * shade(hit_surface, flags, quality);
+
+        auto const& hit_material = material(hit_surface);
+        if (bounce.depth == trace_limits_.max_depth ||
+            (hit_material.reflective <= 0. && hit_material.transparency <= 0.)) {
+            continue;
+        }
+        auto const follow = [&](Ray const& next, double weight) {
+            Color const throughput = bounce.throughput * weight;
+            auto const limit = trace_limits_.min_throughput;
+            if (throughput.r < limit && throughput.g < limit && throughput.b < limit)
+                return;
+            if (auto const next_hit = closest_hit(next))
+                pending.push_back({next, *next_hit, throughput, bounce.depth + 1});
+        };
+
+        auto const& normal_vector = hit_surface.normal_vector;
+        auto const n_ratio = hit_surface.inside ? hit_material.refractive_index
+                                                : 1. / hit_material.refractive_index;
+        auto const refraction = refract(hit_surface.eye_vector, normal_vector, n_ratio);
+        // Where a surface both reflects and refracts, how much goes which way depends on the angle.
+        auto const both = hit_material.reflective > 0. && hit_material.transparency > 0.;
+        auto const reflectance = both ? refraction.reflectance : 1.;
+
+        if (hit_material.reflective > 0.) {
+            follow(Ray{hit_surface.point, reflect(-hit_surface.eye_vector, normal_vector)},
+                   hit_material.reflective * reflectance);
+        }
+        if (hit_material.transparency > 0. && refraction.direction) {
+            follow(Ray{under_point(hit_surface), *refraction.direction},
+                   hit_material.transparency * (both ? 1. - reflectance : 1.));
+        }
+    }
+    return color;
+}
+
+} // namespace cherry_blazer
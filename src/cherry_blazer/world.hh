@@ -0,0 +1,236 @@
+#pragma once
+
+#include "bvh.hh"
+#include "color.hh"
+#include "csg.hh"
+#include "detail/owned_or_viewed.hh"
+#include "detail/shape_array.hh"
+#include "group.hh"
+#include "lighting.hh"
+#include "mesh.hh"
+#include "point.hh"
+#include "point_light.hh"
+#include "ray.hh"
+#include "shapes.hh"
+#include "sphere.hh"
+#include "vector.hh"
+
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <span>
+#include <variant>
+#include <vector>
+
+namespace cherry_blazer {
+
+// Instance of hits on the World's own objects.
+inline constexpr std::uint32_t no_instance = std::numeric_limits<std::uint32_t>::max();
+// Mesh of hits on spheres.
+inline constexpr std::uint32_t no_mesh = std::numeric_limits<std::uint32_t>::max();
+
+// The closest intersection of a ray with the world: the ray parameter and the index of the object,
+// in objects(), in the objects of the group of instances()[instance], or, for meshes, of the
+// triangle in meshes()[mesh]. For other primitives than spheres, object indexes the array of
+// that primitive, e.g. planes(), and for Csg ones, part is the leaf hit.
+struct Hit {
+    double t;
+    std::uint32_t object;
+    std::uint32_t instance{no_instance};
+    std::uint32_t mesh{no_mesh};
+    Primitive primitive{Primitive::Sphere};
+    std::uint16_t part{0};
+};
+
+// Where and how a ray hit a surface: everything shading needs besides lights and materials.
+struct Surface {
+    // The hit point, moved slightly off the surface so that it does not shadow itself.
+    Point3d point;
+    Vec3d eye_vector;
+    // Facing the eye, also when the hit is inside the object.
+    Vec3d normal_vector;
+    std::uint32_t object;
+    std::uint32_t instance{no_instance};
+    std::uint32_t mesh{no_mesh};
+    Primitive primitive{Primitive::Sphere};
+    std::uint16_t part{0};
+    // Whether the ray hit the surface from inside the object.
+    bool inside{false};
+};
+
+// Surface::point is moved this far along the normal, so that shadow rays from it do not hit the
+// surface itself because of rounding errors.
+inline constexpr double shadow_bias = 1e-5;
+
+// The mirror image of Surface::point, just under the surface, where refracted rays start.
+[[nodiscard]] inline Point3d under_point(Surface const& surface) {
+    return surface.point - surface.normal_vector * (2. * shadow_bias);
+}
+
+// How far World::shade() follows reflected and refracted rays.
+struct TraceLimits {
+    // Most bounces after the first hit.
+    unsigned max_depth{5};
+    // Rays that would add less than this, in every channel, to the color are not traced.
+    double min_throughput{1e-3};
+};
+
+// Planes, cubes, cylinders, cones and CSG trees, grouped by type, for building a World.
+struct Shapes {
+    std::vector<Plane> planes;
+    std::vector<Cube> cubes;
+    std::vector<Cylinder> cylinders;
+    std::vector<Cone> cones;
+    std::vector<Csg> csgs;
+};
+
+class World {
+  public:
+    World() = default;
+    // Builds a Bvh over the objects, one over the instances, on top of their groups' Bvhs, one
+    // over the meshes, on top of theirs, and one per type of the other shapes. Throws
+    // std::logic_error if an instance has no group.
+    World(std::vector<Sphere> objects, std::vector<PointLight> lights,
+          std::vector<Instance> instances = {}, std::vector<Mesh> meshes = {},
+          Shapes shapes = {});
+    // Refers to objects and lights stored elsewhere, e.g. in a SceneFile, instead of owning them,
+    // and uses the given Bvh of the objects. The memory must outlive the World and its copies.
+    World(std::span<Sphere> objects, std::span<PointLight> lights, Bvh bvh);
+
+    [[nodiscard]] std::span<Sphere const> objects() const;
+    [[nodiscard]] std::span<PointLight const> lights() const;
+    // Objects and lights can be changed in place, but not added or removed, so indices stay valid.
+    // Call rebuild() after changing the transformation of objects.
+    [[nodiscard]] std::span<Sphere> objects();
+    [[nodiscard]] std::span<PointLight> lights();
+
+    [[nodiscard]] std::span<Instance const> instances() const;
+    [[nodiscard]] std::span<Mesh const> meshes() const;
+    // Only their materials can be changed.
+    [[nodiscard]] std::span<Mesh> meshes();
+
+    // Like objects(), the shapes can be changed in place; call rebuild() after moving them.
+    [[nodiscard]] std::span<Plane const> planes() const;
+    [[nodiscard]] std::span<Cube const> cubes() const;
+    [[nodiscard]] std::span<Cylinder const> cylinders() const;
+    [[nodiscard]] std::span<Cone const> cones() const;
+    [[nodiscard]] std::span<Plane> planes();
+    [[nodiscard]] std::span<Cube> cubes();
+    [[nodiscard]] std::span<Cylinder> cylinders();
+    [[nodiscard]] std::span<Cone> cones();
+    [[nodiscard]] std::span<Csg const> csgs() const;
+
+    // The object a hit or surface refers to, with its material and id: objects()[object], or, for
+    // instances, the object of the group in the group's own space.
+    [[nodiscard]] Sphere const& object(std::uint32_t object,
+                                       std::uint32_t instance = no_instance) const;
+    // Material of the sphere, mesh or shape a surface is on.
+    [[nodiscard]] Material const& material(Surface const& surface) const;
+
+    // Bvh of objects() (instances have their own).
+    [[nodiscard]] Bvh const& bvh() const;
+    // Rebuilds the Bvhs, so that they fit the objects' current transformations.
+    void rebuild();
+
+    // Nearest intersection in front of the ray origin, if any.
+    [[nodiscard]] std::optional<Hit> closest_hit(Ray const& ray) const;
+    // Same, but only tests the given objects (indices into objects()), and no instances, meshes or
+    // other shapes.
+    [[nodiscard]] std::optional<Hit> closest_hit(Ray const& ray,
+                                                 std::span<std::uint32_t const> candidates) const;
+    // Nearest intersection with instances()[instance] in front of the ray origin and before
+    // max_t, if any.
+    [[nodiscard]] std::optional<Hit> closest_instance_hit(Ray const& ray, std::uint32_t instance,
+                                                          double max_t) const;
+    // Same, with meshes()[mesh].
+    [[nodiscard]] std::optional<Hit> closest_mesh_hit(Ray const& ray, std::uint32_t mesh,
+                                                      double max_t) const;
+    // Same, with the planes, cubes, cylinders and cones.
+    [[nodiscard]] std::optional<Hit> closest_shape_hit(Ray const& ray, double max_t) const;
+    // Whether the world has any planes, cubes, cylinders, cones or CSG trees.
+    [[nodiscard]] bool has_shapes() const;
+
+    // Whether anything blocks the ray between its origin and ray.position(max_t). Stops at the
+    // first blocking object found: no sorting, no allocation, no normals or materials.
+    [[nodiscard]] bool occluded(Ray const& ray, double max_t) const;
+
+    // Shadow flags of all the lights at once, for a point on a surface with the given normal.
+    // Lights which don't reach the point or are behind the surface are flagged without tracing a
+    // shadow ray: lighting() gives them no more than the ambient part either way.
+    // Throws std::logic_error if in_shadow.size() != lights().size().
+    void shadows(Point3d const& point, Vec3d const& normal_vector,
+                 std::span<bool> in_shadow) const;
+
+    // Surface at the hit (from closest_hit(ray)).
+    [[nodiscard]] Surface surface(Ray const& ray, Hit const& hit) const;
+
+    // Color of the surface, given the shadow flags of all lights (see shadows()).
+    [[nodiscard]] Color shade(Surface const& surface, std::span<bool const> in_shadow,
+                              SpecularQuality quality = SpecularQuality::Exact) const;
+
+    [[nodiscard]] TraceLimits const& trace_limits() const;
+    void set_trace_limits(TraceLimits const& limits);
+
+    // Color of the hit (from closest_hit(ray)) as seen along the ray, with shadows, reflections
+    // and refraction (see TraceLimits). Rays entering a transparent object come from vacuum, and
+    // rays leaving one go back into it: objects nested inside each other are not told apart.
+    [[nodiscard]] Color shade(Ray const& ray, Hit const& hit,
+                              SpecularQuality quality = SpecularQuality::Exact) const;
+
+    // Color seen along the ray: black if it hits nothing, the shaded closest hit otherwise.
+    [[nodiscard]] Color color_at(Ray const& ray,
+                                 SpecularQuality quality = SpecularQuality::Exact) const;
+
+  private:
+    detail::OwnedOrViewed<Sphere> objects_;
+    detail::OwnedOrViewed<PointLight> lights_;
+    Bvh bvh_;
+    std::vector<Instance> instances_;
+    // The top level over the instances' boxes in the world.
+    Bvh instance_bvh_;
+    std::vector<Mesh> meshes_;
+    Bvh mesh_bvh_;
+    detail::ShapeArray<Plane> planes_;
+    detail::ShapeArray<Cube> cubes_;
+    detail::ShapeArray<Cylinder> cylinders_;
+    detail::ShapeArray<Cone> cones_;
+    detail::ShapeArray<Csg> csgs_;
+    TraceLimits trace_limits_;
+
+    // Calls f(shapes, primitive) for each of the shape arrays.
+    template <typename F> void for_each_shape_array(F const& f) const {
+        f(planes_, Primitive::Plane);
+        f(cubes_, Primitive::Cube);
+        f(cylinders_, Primitive::Cylinder);
+        f(cones_, Primitive::Cone);
+        f(csgs_, Primitive::Csg);
+    }
+
+    // Calls f with the object of a hit or surface which is not on a mesh, whatever its type; for
+    // CSG trees, with the leaf it is on.
+    template <typename F>
+    decltype(auto) visit_object(std::uint32_t object, std::uint32_t instance, Primitive primitive,
+                                std::uint16_t part, F const& f) const;
+};
+
+template <typename F>
+decltype(auto) World::visit_object(std::uint32_t object, std::uint32_t instance,
+                                   Primitive primitive, std::uint16_t part, F const& f) const {
+    switch (primitive) {
+    case Primitive::Plane:
+        return f(planes_.shapes()[object]);
+    case Primitive::Cube:
+        return f(cubes_.shapes()[object]);
+    case Primitive::Cylinder:
+        return f(cylinders_.shapes()[object]);
+    case Primitive::Cone:
+        return f(cones_.shapes()[object]);
+    case Primitive::Csg:
+        return std::visit(f, csgs_.shapes()[object].leaf(part));
+    case Primitive::Sphere:
+        break;
+    }
+    return f(this->object(object, instance));
+}
+
+} // namespace cherry_blazer
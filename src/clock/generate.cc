@@ -51,6 +51,10 @@ int main() {
     Color const green{0., 255., 0.};
     canvas.fill(white);
 
+    // Encode the whole canvas once; every frame then only re-encodes the pixels it changed.
+    std::string image_contents = canvas.as_ppm();
+    canvas.clear_dirty();
+
     auto const translation_matrix{Matrix<T, D, D>::translation(Vector{0., -1., 0.})};
     auto const scaling_matrix{Matrix<T, D, D>::scaling(Vector{radius, radius, radius})};
 
@@ -62,9 +66,9 @@ int main() {
             auto const x = point[0] + offset;
             auto const y = point[1] + offset;
             fmt::print("{:02d}: x: {:<7.3f} y: {:<7.3f}\n", i, x, y);
-            canvas(x, y) = green;
+            canvas.set(x, y, green);
             if (i != 1) {
-                canvas(last_point[0] + offset, last_point[1] + offset) = black;
+                canvas.set(last_point[0] + offset, last_point[1] + offset, black);
             }
             last_point = point;
         }
@@ -77,15 +81,16 @@ int main() {
             std::terminate();
         }
 
-        std::string const image_contents = canvas.as_ppm();
+        canvas.update_ppm(image_contents);
+        canvas.clear_dirty();
         image_file.write(image_contents.data(), long(image_contents.size()));
     }
 
     for (auto i{13U}; i <= 24; ++i) {
         auto const rotation_matrix = Matrix<T, D, D>::rotation(Axis::Z, i * pi_v<T> / 6);
         auto const point = rotation_matrix * scaling_matrix * translation_matrix * clock_origin;
-        canvas(last_point[0] + offset, last_point[1] + offset) = black;
-        canvas(point[0] + offset, point[1] + offset) = green;
+        canvas.set(last_point[0] + offset, last_point[1] + offset, black);
+        canvas.set(point[0] + offset, point[1] + offset, green);
         last_point = point;
 
         std::ofstream image_file;
@@ -96,7 +101,8 @@ int main() {
             std::terminate();
         }
 
-        std::string const image_contents = canvas.as_ppm();
+        canvas.update_ppm(image_contents);
+        canvas.clear_dirty();
         image_file.write(image_contents.data(), long(image_contents.size()));
     }
 }
@@ -1,21 +1,15 @@
 #include <cherry_blazer/axis.hh>
-#include <cherry_blazer/canvas.hh>
+#include <cherry_blazer/camera.hh>
 #include <cherry_blazer/color.hh>
-#include <cherry_blazer/coord.hh>
-#include <cherry_blazer/intersection.hh>
-#include <cherry_blazer/lighting.hh>
 #include <cherry_blazer/matrix_operations.hh>
-#include <cherry_blazer/normal.hh>
 #include <cherry_blazer/point.hh>
 #include <cherry_blazer/point_light.hh>
-#include <cherry_blazer/point_operations.hh>
-#include <cherry_blazer/ray.hh>
+#include <cherry_blazer/render.hh>
 #include <cherry_blazer/shearing.hh>
 #include <cherry_blazer/sphere.hh>
 #include <cherry_blazer/square_matrix.hh>
-#include <cherry_blazer/util.hh>
 #include <cherry_blazer/vector.hh>
-#include <cherry_blazer/vector_operations.hh>
+#include <cherry_blazer/world.hh>
 
 #include <cerrno>
 #include <exception>
@@ -26,21 +20,19 @@
 #include <system_error>
 
 using cherry_blazer::Axis;
-using cherry_blazer::Canvas;
+using cherry_blazer::Camera;
 using cherry_blazer::Color;
-using cherry_blazer::Coord;
 using cherry_blazer::Mat4d;
-using cherry_blazer::Point2d;
 using cherry_blazer::Point3d;
 using cherry_blazer::PointLight;
-using cherry_blazer::Ray;
 using cherry_blazer::Sphere;
 using cherry_blazer::Transformation;
 using cherry_blazer::Vec3d;
+using cherry_blazer::SpecularQuality;
+using cherry_blazer::Supersampling;
+using cherry_blazer::World;
 using cherry_blazer::Shear::X;
 
-using namespace cherry_blazer::util;
-
 using namespace std::numbers;
 
 int main() {
@@ -49,30 +41,12 @@ int main() {
 
     // Conventions about coordinate system: left-handed, Y is up, X is right, Z is outwards.
 
-    // Where ray starts.
-    Point3d ray_origin{0., 0., -5.};
-
-    // Where canvas is positioned.
-    auto wall_z = 10.;
-
-    // How large the wall will be. Because we are using unit spheres, the max y value will be 1. To
-    // find out the value, we take the ray origin and the highest point on the sphere and
-    // extrapolate between them. Then, we need a value twice as big as the result (for +y and -y
-    // values), plus some small margin.
-    auto lerp_result = lerp(wall_z, Point2d{ray_origin.get<Coord::Z>(), ray_origin.get<Coord::Y>()},
-                            Point2d{0., 1.});
-    auto wall_size = lerp_result * 2. + 1.;
-
-    // How large canvas is in pixels.
-    auto canvas_pixels = 1000.;
-
-    // Size of single pixel (in world space units).
-    auto pixel_size = wall_size / canvas_pixels;
-
-    // Half of the wall, which describes minimum and maximum x and y coordinates of the wall.
-    auto half = wall_size / 2.;
-
-    Canvas canvas{canvas_pixels, canvas_pixels};
+    // The eye looks at the sphere from the front. 30 degrees frame the unit sphere (which spans
+    // about 23 degrees from there) with a small margin.
+    auto const canvas_pixels = 1000U;
+    Camera const camera{canvas_pixels, canvas_pixels, pi_v<double> / 6.,
+                        view_transform(Point3d{0., 0., -5.}, Point3d{0., 0., 0.},
+                                       Vec3d{0., 1., 0.})};
 
     // Default sphere
     Sphere shape;
@@ -111,28 +85,10 @@ int main() {
     //    Mat4d::scaling(Vec3d{0.5, 1., 1.}),
     //                            Transformation::Kind::Scaling};
 
-    // For each row of pixels in the canvas
-    for (auto y{0U}; y < unsigned(canvas_pixels); ++y) {
-        // Compute the world y coordinate (top = +half, bottom = -half)
-        auto world_y = half - pixel_size * y;
-        // For each pixel in the row
-        for (auto x{0U}; x < unsigned(canvas_pixels); ++x) {
-            // Compute the world x coordinate (left = -half, right = +half)
-            auto world_x = -half + pixel_size * x;
-
-            // Describe the point on the wall that the ray will target
-            Point3d position{world_x, world_y, wall_z};
-
-            Ray ray{ray_origin, normalize(position - ray_origin)};
-            auto intersections = intersect(shape, ray);
-            if (auto* hit_point = hit(intersections); hit_point) {
-                auto point = ray.position(hit_point->t);
-                auto color = lighting(hit_point->object.material, light, point, -ray.direction,
-                                      normal(hit_point->object, point));
-                canvas(x, y) = color;
-            }
-        }
-    }
+    // One sample per pixel, plus extra samples along the edge of the sphere.
+    World const world{{shape}, {light}};
+    auto const canvas =
+        render_antialiased(world, camera, Supersampling{}, SpecularQuality::Fast).canvas;
 
     std::ofstream image_file;
     try {
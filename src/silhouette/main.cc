@@ -1,6 +1,8 @@
 #include <cherry_blazer/axis.hh>
+#include <cherry_blazer/camera.hh>
 #include <cherry_blazer/canvas.hh>
 #include <cherry_blazer/color.hh>
+#include <cherry_blazer/footprint.hh>
 #include <cherry_blazer/intersection.hh>
 #include <cherry_blazer/matrix_operations.hh>
 #include <cherry_blazer/point.hh>
@@ -9,7 +11,6 @@
 #include <cherry_blazer/shearing.hh>
 #include <cherry_blazer/sphere.hh>
 #include <cherry_blazer/square_matrix.hh>
-#include <cherry_blazer/util.hh>
 #include <cherry_blazer/vector.hh>
 #include <cherry_blazer/vector_operations.hh>
 
@@ -22,17 +23,16 @@
 #include <system_error>
 
 using cherry_blazer::Axis;
+using cherry_blazer::Camera;
 using cherry_blazer::Canvas;
 using cherry_blazer::Color;
 using cherry_blazer::Mat4d;
-using cherry_blazer::Point2d;
 using cherry_blazer::Point3d;
-using cherry_blazer::Ray;
 using cherry_blazer::Sphere;
+using cherry_blazer::Tile;
 using cherry_blazer::Transformation;
 using cherry_blazer::Vec3d;
 using cherry_blazer::Shear::X;
-using cherry_blazer::util::lerp;
 
 using namespace std::numbers;
 
@@ -40,27 +40,12 @@ int main() {
     // Take a ray, and a sphere, and a canvas behind the sphere. Then penetrate sphere with the ray
     // and cast its silhouette on the canvas.
 
-    // Where ray starts.
-    auto constexpr ray_origin = Point3d{0., 0., -5.};
-
-    // Where canvas is positioned.
-    auto constexpr wall_z = 10.;
-
-    // How large the wall will be. Because we are using unit spheres, the max y value will be 1. To
-    // find out the value, we take the ray origin and the highest point on the sphere and
-    // extrapolate between them. Then, we need a value twice as big as the result (for +y and -y
-    // values), plus some small margin.
-    auto constexpr wall_size =
-        lerp(wall_z, Point2d{ray_origin[2], ray_origin[1]}, Point2d{0., 1.}) * 2. + 1.;
-
-    // How large canvas is in pixels.
-    auto constexpr canvas_pixels = 100.;
-
-    // Size of single pixel (in world space units).
-    auto constexpr pixel_size = wall_size / canvas_pixels;
-
-    // Half of the wall, which describes minimum and maximum x and y coordinates of the wall.
-    auto constexpr half = wall_size / 2.;
+    // The eye looks at the sphere from the front. 30 degrees frame the unit sphere (which spans
+    // about 23 degrees from there) with a small margin.
+    auto constexpr canvas_pixels = 100U;
+    Camera const camera{canvas_pixels, canvas_pixels, pi_v<double> / 6.,
+                        view_transform(Point3d{0., 0., -5.}, Point3d{0., 0., 0.},
+                                       Vec3d{0., 1., 0.})};
 
     Canvas canvas{canvas_pixels, canvas_pixels};
     Color color{1., 0., 0}; // red
@@ -85,20 +70,14 @@ int main() {
     //    Sphere shape{{Mat4d::shearing(X::AgainstY{}) * Mat4d::scaling(Vec3d{0.5, 1., 1.}),
     //                  Transformation::Kind::Scaling}};
 
-    // For each row of pixels in the canvas
-    for (auto y{0U}; y < unsigned(canvas_pixels - 1.); ++y) {
-        // Compute the world y coordinate (top = +half, bottom = -half)
-        auto world_y = half - pixel_size * y;
-        // For each pixel in the row
-        for (auto x{0U}; x < unsigned(canvas_pixels - 1.); ++x) {
-            // Compute the world x coordinate (left = -half, right = +half)
-            auto world_x = -half + pixel_size * x;
-
-            // Describe the point on the wall that the ray will target
-            Point3d position{world_x, world_y, wall_z};
+    // Only the pixels within the sphere's screen footprint can see it; the rest stays background.
+    auto const footprint = screen_footprint(shape, camera).value_or(Tile{0, 0, 0, 0});
 
-            Ray r{ray_origin, normalize(position - ray_origin)};
-            auto intersections = intersect(shape, r);
+    // For each row of pixels in the footprint
+    for (auto y{footprint.y}; y < footprint.y + footprint.height; ++y) {
+        // For each pixel in the row
+        for (auto x{footprint.x}; x < footprint.x + footprint.width; ++x) {
+            auto intersections = intersect(shape, camera.ray_for_pixel(x, y));
             if (hit(intersections) != nullptr)
                 canvas(x, y) = color;
         }
@@ -0,0 +1,174 @@
+#include <cherry_blazer/axis.hh>
+#include <cherry_blazer/bvh.hh>
+#include <cherry_blazer/intersection.hh>
+#include <cherry_blazer/matrix_operations.hh>
+#include <cherry_blazer/point.hh>
+#include <cherry_blazer/random.hh>
+#include <cherry_blazer/ray.hh>
+#include <cherry_blazer/sphere.hh>
+#include <cherry_blazer/square_matrix.hh>
+#include <cherry_blazer/transformation.hh>
+#include <cherry_blazer/vector.hh>
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <numbers>
+#include <optional>
+#include <utility>
+#include <vector>
+
+using cherry_blazer::Axis;
+using cherry_blazer::Bvh;
+using cherry_blazer::Mat4d;
+using cherry_blazer::Point;
+using cherry_blazer::Ray;
+using cherry_blazer::SampleRandom;
+using cherry_blazer::Sphere;
+using cherry_blazer::Transformation;
+using cherry_blazer::Vector;
+
+namespace {
+
+// Spheres of random sizes and stretches, scattered in a 100-unit cube.
+std::vector<Sphere> random_spheres(unsigned count) {
+    std::vector<Sphere> spheres;
+    spheres.reserve(count);
+    for (unsigned i = 0; i < count; ++i) {
+        SampleRandom const random{i, 0, 0};
+        auto const scaling = Mat4d::scaling(
+            Vector{.1 + random.uniform(0), .1 + random.uniform(1), .1 + random.uniform(2)});
+        auto const translation = Mat4d::translation(Vector{100. * random.uniform(3) - 50.,
+                                                           100. * random.uniform(4) - 50.,
+                                                           100. * random.uniform(5) - 50.});
+        auto const rotation = Mat4d::rotation(Axis::Z, random.uniform(6));
+        spheres.emplace_back(
+            Transformation{translation * rotation * scaling, Transformation::Kind::Scaling});
+    }
+    return spheres;
+}
+
+// Nearest intersection in front of the ray origin, testing every sphere.
+std::optional<std::pair<double, std::uint32_t>> brute_force_hit(std::vector<Sphere> const& spheres,
+                                                                 Ray const& ray) {
+    std::optional<std::pair<double, std::uint32_t>> closest;
+    for (std::uint32_t i = 0; i < spheres.size(); ++i) {
+        auto const interval = intersect_interval(spheres[i], ray);
+        if (!interval)
+            continue;
+        auto const t = interval->first >= 0. ? interval->first : interval->second;
+        if (t >= 0. && (!closest || t < closest->first))
+            closest = {t, i};
+    }
+    return closest;
+}
+
+} // namespace
+
+TEST(BvhTest, BoundsOfTransformedSphere) { // NOLINT
+    Sphere const sphere{{Mat4d::translation(Vector{1., 2., 3.}) *
+                             Mat4d::scaling(Vector{2., 3., 4.}),
+                         Transformation::Kind::Scaling}};
+
+    auto const box = bounds(sphere);
+
+    EXPECT_DOUBLE_EQ(box.min[0], -1.);
+    EXPECT_DOUBLE_EQ(box.min[1], -1.);
+    EXPECT_DOUBLE_EQ(box.min[2], -1.);
+    EXPECT_DOUBLE_EQ(box.max[0], 3.);
+    EXPECT_DOUBLE_EQ(box.max[1], 5.);
+    EXPECT_DOUBLE_EQ(box.max[2], 7.);
+}
+
+TEST(BvhTest, BoundsOfTransformedBox) { // NOLINT
+    cherry_blazer::Aabb const box{{-1., -1., -1.}, {1., 1., 1.}};
+
+    auto const turned = bounds(box, Mat4d::translation(Vector{0., 0., 5.}) *
+                                        Mat4d::rotation(Axis::Z, std::numbers::pi / 4.));
+
+    EXPECT_NEAR(turned.min[0], -std::numbers::sqrt2, 1e-12);
+    EXPECT_NEAR(turned.min[1], -std::numbers::sqrt2, 1e-12);
+    EXPECT_NEAR(turned.min[2], 4., 1e-12);
+    EXPECT_NEAR(turned.max[0], std::numbers::sqrt2, 1e-12);
+    EXPECT_NEAR(turned.max[1], std::numbers::sqrt2, 1e-12);
+    EXPECT_NEAR(turned.max[2], 6., 1e-12);
+}
+
+TEST(BvhTest, EmptyBvhVisitsNothing) { // NOLINT
+    Bvh const bvh{std::vector<Sphere>{}};
+    auto visited = false;
+
+    bvh.traverse(Ray{Point{0., 0., -5.}, Vector{0., 0., 1.}},
+                 std::numeric_limits<double>::infinity(), [&](std::uint32_t, double&) {
+                     visited = true;
+                     return false;
+                 });
+
+    EXPECT_EQ(bvh.node_count(), 0);
+    EXPECT_FALSE(visited);
+}
+
+TEST(BvhTest, RootBoundsContainAllObjects) { // NOLINT
+    auto const spheres = random_spheres(1000);
+
+    Bvh const bvh{spheres};
+
+    auto const root = bvh.root_bounds();
+    for (auto const& sphere : spheres) {
+        auto const box = bounds(sphere);
+        for (std::size_t axis = 0; axis < 3; ++axis) {
+            EXPECT_LE(root.min[axis], box.min[axis]);
+            EXPECT_GE(root.max[axis], box.max[axis]);
+        }
+    }
+    EXPECT_LE(bvh.node_count(), 2 * spheres.size() - 1);
+}
+
+TEST(BvhTest, ClosestHitMatchesTestingEveryObject) { // NOLINT
+    // Enough objects for the subtrees to be built in parallel.
+    auto const spheres = random_spheres(20000);
+    Bvh const bvh{spheres};
+
+    for (unsigned i = 0; i < 200; ++i) {
+        SampleRandom const random{i, 1, 0};
+        Ray const ray{Point{0., 0., -80.},
+                      Vector{random.uniform(0) - .5, random.uniform(1) - .5, 1.}};
+
+        std::optional<std::pair<double, std::uint32_t>> closest;
+        bvh.traverse(ray, std::numeric_limits<double>::infinity(),
+                     [&](std::uint32_t object, double& max_t) {
+                         auto const interval = intersect_interval(spheres[object], ray);
+                         if (interval && interval->first >= 0. && interval->first < max_t) {
+                             max_t = interval->first;
+                             closest = {max_t, object};
+                         }
+                         return false;
+                     });
+
+        auto const expected = brute_force_hit(spheres, ray);
+        ASSERT_EQ(closest.has_value(), expected.has_value());
+        if (expected) {
+            EXPECT_EQ(closest->first, expected->first);
+            EXPECT_EQ(closest->second, expected->second);
+        }
+    }
+}
+
+TEST(BvhTest, TraversalStopsWhenAsked) { // NOLINT
+    auto const spheres = random_spheres(1000);
+    Bvh const bvh{spheres};
+    auto calls = 0;
+
+    // Straight at the first sphere's centre, so that there is something to intersect.
+    auto const& centre = spheres[0].transformation.mat;
+    bvh.traverse(Ray{Point{-60., 0., 0.},
+                     Vector{centre(0, 3) + 60., centre(1, 3), centre(2, 3)}},
+                 std::numeric_limits<double>::infinity(), [&](std::uint32_t, double&) {
+                     ++calls;
+                     return true;
+                 });
+
+    EXPECT_EQ(calls, 1);
+}
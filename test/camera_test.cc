@@ -0,0 +1,153 @@
+#include <cherry_blazer/camera.hh>
+#include <cherry_blazer/matrix_operations.hh>
+#include <cherry_blazer/point.hh>
+#include <cherry_blazer/ray.hh>
+#include <cherry_blazer/square_matrix.hh>
+#include <cherry_blazer/vector.hh>
+#include <cherry_blazer/vector_operations.hh>
+
+#include <gtest/gtest.h>
+
+#include <numbers>
+#include <stdexcept>
+#include <vector>
+
+using cherry_blazer::Axis;
+using cherry_blazer::Camera;
+using cherry_blazer::Mat4d;
+using cherry_blazer::Point;
+using cherry_blazer::Point3d;
+using cherry_blazer::Ray;
+using cherry_blazer::Tile;
+using cherry_blazer::Vec3d;
+using cherry_blazer::Vector;
+
+using namespace std::numbers;
+
+namespace {
+
+void expect_near(Point3d const& actual, Point3d const& expected) {
+    for (auto i{0U}; i < 3; ++i)
+        EXPECT_NEAR(actual[i], expected[i], 1e-5) << "coordinate " << i;
+}
+
+void expect_near(Vec3d const& actual, Vec3d const& expected) {
+    for (auto i{0U}; i < 3; ++i)
+        EXPECT_NEAR(actual[i], expected[i], 1e-5) << "coordinate " << i;
+}
+
+} // namespace
+
+TEST(CameraTest, ViewTransformDefaultOrientation) { // NOLINT
+    auto const t = view_transform(Point{0., 0., 0.}, Point{0., 0., -1.}, Vector{0., 1., 0.});
+
+    EXPECT_EQ(t, Mat4d::identity());
+}
+
+TEST(CameraTest, ViewTransformLookingInPositiveZ) { // NOLINT
+    auto const t = view_transform(Point{0., 0., 0.}, Point{0., 0., 1.}, Vector{0., 1., 0.});
+
+    EXPECT_EQ(t, Mat4d::scaling(Vector{-1., 1., -1.}));
+}
+
+TEST(CameraTest, ViewTransformMovesTheWorld) { // NOLINT
+    auto const t = view_transform(Point{0., 0., 8.}, Point{0., 0., 0.}, Vector{0., 1., 0.});
+
+    EXPECT_EQ(t, Mat4d::translation(Vector{0., 0., -8.}));
+}
+
+TEST(CameraTest, ViewTransformArbitrary) { // NOLINT
+    auto const t = view_transform(Point{1., 3., 2.}, Point{4., -2., 8.}, Vector{1., 1., 0.});
+    Mat4d const expected{{-.50709, .50709, .67612, -2.36643},
+                         {.76772, .60609, .12122, -2.82843},
+                         {-.35857, .59761, -.71714, 0.},
+                         {0., 0., 0., 1.}};
+
+    for (auto row{0U}; row < 4; ++row)
+        for (auto col{0U}; col < 4; ++col)
+            EXPECT_NEAR(t(row, col), expected(row, col), 1e-5);
+}
+
+TEST(CameraTest, PixelSizeForHorizontalImage) { // NOLINT
+    Camera const camera{200, 125, pi / 2.};
+
+    EXPECT_NEAR(camera.pixel_size(), .01, 1e-12);
+}
+
+TEST(CameraTest, PixelSizeForVerticalImage) { // NOLINT
+    Camera const camera{125, 200, pi / 2.};
+
+    EXPECT_NEAR(camera.pixel_size(), .01, 1e-12);
+}
+
+TEST(CameraTest, RayThroughCenterOfImage) { // NOLINT
+    Camera const camera{201, 101, pi / 2.};
+
+    auto const ray = camera.ray_for_pixel(100, 50);
+
+    expect_near(ray.origin, Point{0., 0., 0.});
+    expect_near(ray.direction, Vector{0., 0., -1.});
+}
+
+TEST(CameraTest, RayThroughCornerOfImage) { // NOLINT
+    Camera const camera{201, 101, pi / 2.};
+
+    auto const ray = camera.ray_for_pixel(0, 0);
+
+    expect_near(ray.origin, Point{0., 0., 0.});
+    expect_near(ray.direction, Vector{.66519, .33259, -.66851});
+}
+
+TEST(CameraTest, RayWhenCameraIsTransformed) { // NOLINT
+    Camera const camera{201, 101, pi / 2.,
+                        Mat4d::rotation(Axis::Y, pi / 4.) *
+                            Mat4d::translation(Vector{0., -2., 5.})};
+
+    auto const ray = camera.ray_for_pixel(100, 50);
+
+    expect_near(ray.origin, Point{0., 2., -5.});
+    expect_near(ray.direction, Vector{sqrt2 / 2., 0., -sqrt2 / 2.});
+}
+
+TEST(CameraTest, RaysForTileMatchRaysForPixels) { // NOLINT
+    Camera const camera{64, 48, pi / 3.,
+                        view_transform(Point{1., 2., -5.}, Point{0., 0., 0.}, Vector{0., 1., 0.})};
+    Tile const tile{10, 20, 16, 8};
+    std::vector<Ray> rays(tile.width * tile.height);
+
+    camera.rays_for_tile(tile, rays);
+
+    for (auto y{0U}; y < tile.height; ++y) {
+        for (auto x{0U}; x < tile.width; ++x) {
+            auto const expected = camera.ray_for_pixel(tile.x + x, tile.y + y);
+            auto const& actual = rays[y * tile.width + x];
+            expect_near(actual.origin, expected.origin);
+            expect_near(normalize(actual.direction), expected.direction);
+        }
+    }
+}
+
+TEST(CameraTest, RaysForTileOutsideImage) { // NOLINT
+    Camera const camera{64, 48, pi / 3.};
+    std::vector<Ray> rays(16 * 16);
+
+    EXPECT_THROW(camera.rays_for_tile(Tile{56, 0, 16, 16}, rays), std::logic_error);
+    EXPECT_THROW(camera.rays_for_tile(Tile{0, 0, 32, 16}, rays), std::logic_error);
+}
+
+TEST(CameraTest, InvalidCamera) { // NOLINT
+    EXPECT_THROW((Camera{0, 10, pi / 2.}), std::logic_error);
+    EXPECT_THROW((Camera{10, 10, 0.}), std::logic_error);
+    EXPECT_THROW((Camera{10, 10, pi}), std::logic_error);
+    EXPECT_THROW((Camera{10, 10, pi / 2., Mat4d{}}), std::logic_error);
+}
+
+TEST(CameraTest, RayThroughPixelEdge) { // NOLINT
+    Camera const camera{201, 101, pi / 2.};
+    std::vector<Ray> rays(2);
+    camera.rays_for_tile(Tile{10, 20, 2, 1}, rays);
+
+    auto const ray = camera.ray_for_pixel(10, 20, .5, 0.);
+
+    expect_near(ray.direction, normalize(rays[0].direction + rays[1].direction));
+}
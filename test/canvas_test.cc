@@ -2,6 +2,8 @@
 
 #include <gtest/gtest.h>
 
+#include <cstddef>
+#include <stdexcept>
 #include <string>
 #include <system_error>
 
@@ -125,3 +127,92 @@ TEST_F(CanvasTest, CanvasExportPpmTail) { // NOLINT
                          " 255 204 153 255 204 153 255 204 153\n"};
     EXPECT_EQ(image, expected) << image;
 }
+
+TEST(CanvasDirtyTest, NewCanvasIsClean) { // NOLINT
+    Canvas const c{10, 10};
+
+    EXPECT_TRUE(c.dirty().empty());
+}
+
+TEST(CanvasDirtyTest, AccessorWritesAreNotTracked) { // NOLINT
+    Canvas c{10, 10};
+
+    c(2, 3) = Color{1., 0., 0.};
+    EXPECT_TRUE(c.dirty().empty());
+
+    c.mark_dirty({2, 3, 1, 1});
+    ASSERT_EQ(c.dirty().size(), 1U);
+    EXPECT_EQ(c.dirty()[0].width, 1U);
+}
+
+TEST(CanvasDirtyTest, WritesGrowRegion) { // NOLINT
+    Canvas c{10, 10};
+
+    c.set(2, 3, Color{1., 0., 0.});
+    c.set(3, 3, Color{1., 0., 0.});
+    c.set(3, 4, Color{1., 0., 0.});
+
+    ASSERT_EQ(c.dirty().size(), 1U);
+    auto const region = c.dirty()[0];
+    EXPECT_EQ(region.x, 2U);
+    EXPECT_EQ(region.y, 3U);
+    EXPECT_EQ(region.width, 2U);
+    EXPECT_EQ(region.height, 2U);
+}
+
+TEST(CanvasDirtyTest, DistantWritesKeepSeparateRegions) { // NOLINT
+    Canvas c{10, 10};
+
+    c.set(0, 0, Color{1., 0., 0.});
+    c.set(9, 9, Color{1., 0., 0.});
+
+    EXPECT_EQ(c.dirty().size(), 2U);
+
+    c.clear_dirty();
+    EXPECT_TRUE(c.dirty().empty());
+}
+
+TEST(CanvasDirtyTest, ManyRegionsAreMerged) { // NOLINT
+    Canvas c{100, 10};
+
+    for (auto x{0U}; x < 100; x += 3)
+        c.set(x, 0U, Color{1., 0., 0.});
+
+    ASSERT_LE(c.dirty().size(), 16U);
+    std::size_t covered = 0;
+    for (auto const& region : c.dirty())
+        covered += region.width;
+    EXPECT_GE(covered, 98U);
+}
+
+TEST(CanvasDirtyTest, FillDirtiesEverything) { // NOLINT
+    Canvas c{10, 20};
+
+    c.fill(Color{1., 1., 1.});
+
+    ASSERT_EQ(c.dirty().size(), 1U);
+    EXPECT_EQ(c.dirty()[0].width, 10U);
+    EXPECT_EQ(c.dirty()[0].height, 20U);
+}
+
+TEST(CanvasDirtyTest, UpdatePpmMatchesFullExport) { // NOLINT
+    Canvas c{13, 7};
+    c.fill(Color{.5, .5, .5});
+    auto ppm = c.as_ppm();
+    c.clear_dirty();
+
+    c.set(0, 0, Color{1., 0., 0.});
+    c.set(12, 6, Color{0., 1., 0.});
+    c.set(5, 3, Color{0., 0., 1.});
+    c.update_ppm(ppm);
+
+    EXPECT_EQ(ppm, c.as_ppm());
+}
+
+TEST(CanvasDirtyTest, UpdatePpmOfDifferentSize) { // NOLINT
+    Canvas const small{2, 2};
+    Canvas const large{3, 3};
+    auto ppm = small.as_ppm();
+
+    EXPECT_THROW(large.update_ppm(ppm), std::logic_error);
+}
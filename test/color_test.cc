@@ -87,3 +87,42 @@ TEST(ColorTest, ColorPrintOut) { // NOLINT
     ss << c;
     EXPECT_EQ(ss.str(), std::string{"(  1  22 255)"});
 }
+
+// Chained arithmetic is evaluated lazily, in one pass, when converted to Color.
+TEST(ColorTest, ChainedExpression) { // NOLINT
+    Color c1{1, 0.2, 0.4};           // NOLINT(readability-magic-numbers)
+    Color c2{0.9, 1, 0.1};           // NOLINT(readability-magic-numbers)
+    Color c3{0.5, 0.5, 0.5};         // NOLINT(readability-magic-numbers)
+    Color c4 = c1 * c2 + c3 * 2. - Color{0.1, 0.1, 0.1} / 2.;
+    EXPECT_EQ(c4, (Color{1.85, 1.15, 0.99}));
+}
+
+// Compound assignment may refer to the assigned Color on the right-hand side.
+TEST(ColorTest, CompoundAssignmentWithSelfReference) { // NOLINT
+    Color c{1, 2, 3};
+    c += c * 2.;
+    EXPECT_EQ(c, (Color{3, 6, 9}));
+    c *= c - Color{2, 5, 8};
+    EXPECT_EQ(c, (Color{3, 6, 9}));
+}
+
+// Expressions built from temporaries own them, so they can outlive the full expression.
+TEST(ColorTest, ExpressionOwnsTemporaries) { // NOLINT
+    auto const expression = Color{1, 2, 3} + Color{3, 2, 1};
+    Color c = expression;
+    EXPECT_EQ(c, (Color{4, 4, 4}));
+}
+
+// Color occupies exactly one 4-lane register, and the padding lane stays zero.
+TEST(ColorTest, ColorIsOneRegisterWithZeroPadding) { // NOLINT
+    static_assert(sizeof(Color) == 4 * sizeof(double));
+    static_assert(alignof(Color) == 4 * sizeof(double));
+    Color c1{1, -2, 3};
+    Color c2 = c1 / 0.;
+    EXPECT_EQ(c2.pad, 0.);
+    c2 = c1 * 2.;
+    EXPECT_EQ(c2.r, 2.);
+    EXPECT_EQ(c2.g, -4.);
+    EXPECT_EQ(c2.b, 6.);
+    EXPECT_EQ(c2.pad, 0.);
+}
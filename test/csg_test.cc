@@ -0,0 +1,202 @@
+#include <cherry_blazer/camera.hh>
+#include <cherry_blazer/color.hh>
+#include <cherry_blazer/csg.hh>
+#include <cherry_blazer/point.hh>
+#include <cherry_blazer/point_light.hh>
+#include <cherry_blazer/ray.hh>
+#include <cherry_blazer/shapes.hh>
+#include <cherry_blazer/sphere.hh>
+#include <cherry_blazer/transformation.hh>
+#include <cherry_blazer/vector.hh>
+#include <cherry_blazer/vector_operations.hh>
+#include <cherry_blazer/world.hh>
+
+#include "render_helpers.hh"
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <limits>
+#include <numbers>
+#include <stdexcept>
+#include <utility>
+#include <variant>
+
+using cherry_blazer::Camera;
+using cherry_blazer::Color;
+using cherry_blazer::Cone;
+using cherry_blazer::Csg;
+using cherry_blazer::CsgOperation;
+using cherry_blazer::Cube;
+using cherry_blazer::Cylinder;
+using cherry_blazer::Mat4d;
+using cherry_blazer::Plane;
+using cherry_blazer::Point;
+using cherry_blazer::Primitive;
+using cherry_blazer::Ray;
+using cherry_blazer::Shapes;
+using cherry_blazer::Sphere;
+using cherry_blazer::Transformation;
+using cherry_blazer::Vector;
+using cherry_blazer::World;
+using cherry_blazer::test::count_pixels;
+using cherry_blazer::test::expect_renderers_agree;
+using cherry_blazer::test::translation;
+
+using namespace std::numbers;
+
+namespace {
+
+constexpr auto infinity = std::numeric_limits<double>::infinity();
+
+// Unit spheres centered at x = 0 and x = 1.
+Csg spheres(CsgOperation operation) {
+    return {operation, Sphere{}, Sphere{translation(1., 0., 0.)}};
+}
+
+} // namespace
+
+TEST(CsgTest, UnionIsHitOnEitherShape) { // NOLINT
+    auto const csg = spheres(CsgOperation::Union);
+
+    auto const from_left = csg.closest_hit(Ray{Point{-5., 0., 0.}, Vector{1., 0., 0.}}, infinity);
+    ASSERT_TRUE(from_left.has_value());
+    EXPECT_DOUBLE_EQ(from_left->t, 4.);
+    EXPECT_EQ(from_left->leaf, 0U);
+
+    auto const from_right = csg.closest_hit(Ray{Point{5., 0., 0.}, Vector{-1., 0., 0.}}, infinity);
+    ASSERT_TRUE(from_right.has_value());
+    EXPECT_DOUBLE_EQ(from_right->t, 3.);
+    EXPECT_EQ(from_right->leaf, 1U);
+
+    // from inside both, the first crossing is where the ray leaves the union, not either sphere
+    auto const inside = csg.closest_hit(Ray{Point{.5, 0., 0.}, Vector{1., 0., 0.}}, infinity);
+    ASSERT_TRUE(inside.has_value());
+    EXPECT_DOUBLE_EQ(inside->t, 1.5);
+    EXPECT_EQ(inside->leaf, 1U);
+}
+
+TEST(CsgTest, IntersectionIsHitWhereBothShapesAre) { // NOLINT
+    auto const csg = spheres(CsgOperation::Intersection);
+
+    auto const hit = csg.closest_hit(Ray{Point{-5., 0., 0.}, Vector{1., 0., 0.}}, infinity);
+    ASSERT_TRUE(hit.has_value());
+    EXPECT_DOUBLE_EQ(hit->t, 5.);
+    EXPECT_EQ(hit->leaf, 1U);
+
+    Csg const apart{CsgOperation::Intersection, Sphere{}, Sphere{translation(3., 0., 0.)}};
+    EXPECT_FALSE(apart.closest_hit(Ray{Point{-5., 0., 0.}, Vector{1., 0., 0.}}, infinity));
+}
+
+TEST(CsgTest, DifferenceFacesIntoTheCarvedShape) { // NOLINT
+    auto const csg = spheres(CsgOperation::Difference);
+
+    auto const from_left = csg.closest_hit(Ray{Point{-5., 0., 0.}, Vector{1., 0., 0.}}, infinity);
+    ASSERT_TRUE(from_left.has_value());
+    EXPECT_DOUBLE_EQ(from_left->t, 4.);
+    EXPECT_EQ(from_left->leaf, 0U);
+
+    // through the carved sphere first, then onto the left one where the right one was
+    Ray const ray{Point{5., 0., 0.}, Vector{-1., 0., 0.}};
+    auto const from_right = csg.closest_hit(ray, infinity);
+    ASSERT_TRUE(from_right.has_value());
+    EXPECT_DOUBLE_EQ(from_right->t, 5.);
+    EXPECT_EQ(from_right->leaf, 1U);
+    auto const normal = csg.normal(from_right->leaf, ray.position(from_right->t));
+    EXPECT_DOUBLE_EQ(normal[0], 1.);
+    EXPECT_EQ(&csg.material(1), &std::get<Sphere>(csg.leaf(1)).material);
+}
+
+TEST(CsgTest, PlanesAreHalfSpaces) { // NOLINT
+    // the top half of the cube
+    Csg const csg{CsgOperation::Difference, Cube{}, Plane{}};
+
+    auto const from_above = csg.closest_hit(Ray{Point{0., 5., 0.}, Vector{0., -1., 0.}}, infinity);
+    ASSERT_TRUE(from_above.has_value());
+    EXPECT_DOUBLE_EQ(from_above->t, 4.);
+
+    Ray const ray{Point{0., -5., 0.}, Vector{0., 1., 0.}};
+    auto const from_below = csg.closest_hit(ray, infinity);
+    ASSERT_TRUE(from_below.has_value());
+    EXPECT_DOUBLE_EQ(from_below->t, 5.);
+    EXPECT_EQ(from_below->leaf, 1U);
+    EXPECT_DOUBLE_EQ(csg.normal(from_below->leaf, ray.position(from_below->t))[1], -1.);
+
+    auto const box = bounds(csg);
+    EXPECT_DOUBLE_EQ(box.max[1], 1.);
+}
+
+TEST(CsgTest, NestedTreesAndAllShapes) { // NOLINT
+    // a closed tube: a cylinder with a narrower one carved out, capped by a cone and sphere
+    Cylinder outer{};
+    outer.minimum = -1.;
+    outer.maximum = 1.;
+    outer.closed = true;
+    auto inner = outer;
+    inner.transformation = {Mat4d::scaling(Vector{.5, 2., .5}), Transformation::Kind::Scaling};
+    Cone cone{translation(0., 2., 0.), {}, -1., 0., true};
+    Csg const tube{CsgOperation::Difference, outer, inner};
+    Csg const csg{CsgOperation::Union, Csg{CsgOperation::Union, tube, cone},
+                  Sphere{translation(0., -5., 0.)}};
+    EXPECT_EQ(csg.leaf_count(), 4U);
+
+    // down through the hole, past the cone's apex
+    auto const hit = csg.closest_hit(Ray{Point{0., 10., 0.}, Vector{0., -1., 0.}}, infinity);
+    ASSERT_TRUE(hit.has_value());
+    EXPECT_DOUBLE_EQ(hit->t, 8.);
+    EXPECT_EQ(hit->leaf, 2U);
+
+    // through the tube's hole, which the cone's wide end closes off from above
+    auto const up = csg.closest_hit(Ray{Point{0., -3., 0.}, Vector{0., 1., 0.}}, infinity);
+    ASSERT_TRUE(up.has_value());
+    EXPECT_DOUBLE_EQ(up->t, 4.);
+    EXPECT_EQ(up->leaf, 2U);
+
+    // into the tube's wall
+    auto const side = csg.closest_hit(Ray{Point{-5., 0., 0.}, Vector{1., 0., 0.}}, infinity);
+    ASSERT_TRUE(side.has_value());
+    EXPECT_DOUBLE_EQ(side->t, 4.);
+    EXPECT_EQ(side->leaf, 0U);
+}
+
+TEST(CsgTest, OccludedOnlyBetweenOriginAndMaxT) { // NOLINT
+    auto const csg = spheres(CsgOperation::Intersection);
+    Ray const ray{Point{-5., 0., 0.}, Vector{1., 0., 0.}};
+
+    EXPECT_TRUE(csg.occluded(ray, 5.5));
+    EXPECT_FALSE(csg.occluded(ray, 4.5)); // only the left sphere is crossed before
+    EXPECT_FALSE(csg.closest_hit(ray, 4.5));
+}
+
+TEST(CsgTest, InvalidTreesThrow) { // NOLINT
+    Cylinder open{};
+    open.maximum = 1.;
+    EXPECT_THROW((Csg{open}), std::logic_error);
+    EXPECT_NO_THROW((Csg{Cylinder{}}));
+
+    Csg csg{Sphere{}};
+    for (std::size_t i = 1; i < Csg::max_leaves; ++i)
+        csg = Csg{CsgOperation::Union, std::move(csg), Sphere{}};
+    EXPECT_THROW((Csg{CsgOperation::Union, csg, Sphere{}}), std::logic_error);
+}
+
+TEST(CsgTest, RenderersAgreeOnCsg) { // NOLINT
+    Shapes shapes;
+    shapes.csgs.push_back(spheres(CsgOperation::Difference));
+    shapes.csgs.push_back({CsgOperation::Intersection, Cube{translation(-2., 0., 2.), {}},
+                           Sphere{translation(-2.5, .5, 1.5)}});
+    World const world{{}, {{Point{-10., 10., -10.}, Color{1., 1., 1.}}}, {}, {}, shapes};
+    Camera const camera{31, 27, pi / 2.,
+                        view_transform(Point{3., 2., -6.}, Point{0., 0., 0.}, Vector{0., 1., 0.})};
+
+    expect_renderers_agree(world, camera);
+    // the carved out part of the difference faces the eye
+    auto const hits_on_carved =
+        count_pixels(world, camera, [&world](Ray const& ray, cherry_blazer::Hit const& hit) {
+            if (hit.primitive != Primitive::Csg || hit.object != 0 || hit.part != 1)
+                return false;
+            EXPECT_GT(dot(world.surface(ray, hit).normal_vector, -ray.direction), 0.);
+            return true;
+        });
+    EXPECT_GT(hits_on_carved, 0);
+}
@@ -0,0 +1,90 @@
+#include <cherry_blazer/camera.hh>
+#include <cherry_blazer/footprint.hh>
+#include <cherry_blazer/intersection.hh>
+#include <cherry_blazer/matrix_operations.hh>
+#include <cherry_blazer/point.hh>
+#include <cherry_blazer/ray.hh>
+#include <cherry_blazer/sphere.hh>
+#include <cherry_blazer/square_matrix.hh>
+#include <cherry_blazer/transformation.hh>
+#include <cherry_blazer/vector.hh>
+
+#include <gtest/gtest.h>
+
+#include <numbers>
+
+using cherry_blazer::Camera;
+using cherry_blazer::Mat4d;
+using cherry_blazer::Point;
+using cherry_blazer::Sphere;
+using cherry_blazer::Transformation;
+using cherry_blazer::Vector;
+
+using namespace std::numbers;
+
+class FootprintTest : public ::testing::Test {
+  protected:
+    Camera camera{101, 81, pi / 3.,
+                  view_transform(Point{0., 0., -5.}, Point{0., 0., 0.}, Vector{0., 1., 0.})};
+};
+
+TEST_F(FootprintTest, ProjectPointOnAxisToCenter) {
+    auto const projected = camera.project(Point{0., 0., 10.});
+
+    ASSERT_TRUE(projected.has_value());
+    EXPECT_NEAR((*projected)[0], 50., 1e-9);
+    EXPECT_NEAR((*projected)[1], 40., 1e-9);
+}
+
+TEST_F(FootprintTest, ProjectPointBehindEye) {
+    EXPECT_FALSE(camera.project(Point{0., 0., -10.}).has_value());
+}
+
+TEST_F(FootprintTest, NoHitsOutsideFootprint) {
+    Sphere const sphere{{Mat4d::translation(Vector{1., -.5, 1.}) *
+                             Mat4d::scaling(Vector{.5, 1., .5}),
+                         Transformation::Kind::Scaling}};
+
+    auto const footprint = screen_footprint(sphere, camera);
+
+    ASSERT_TRUE(footprint.has_value());
+    EXPECT_LT(footprint->width * footprint->height, camera.hsize() * camera.vsize() / 4);
+    auto hits_inside = 0;
+    for (auto y{0U}; y < camera.vsize(); ++y) {
+        for (auto x{0U}; x < camera.hsize(); ++x) {
+            auto const inside = x >= footprint->x && x < footprint->x + footprint->width &&
+                                y >= footprint->y && y < footprint->y + footprint->height;
+            auto const hit = intersect_interval(sphere, camera.ray_for_pixel(x, y)).has_value();
+            if (!inside)
+                EXPECT_FALSE(hit) << "pixel " << x << ", " << y;
+            else if (hit)
+                ++hits_inside;
+        }
+    }
+    EXPECT_GT(hits_inside, 0);
+}
+
+TEST_F(FootprintTest, SphereOutsideImage) {
+    Sphere const sphere{
+        {Mat4d::translation(Vector{100., 0., 0.}), Transformation::Kind::Translation}};
+
+    EXPECT_FALSE(screen_footprint(sphere, camera).has_value());
+}
+
+TEST_F(FootprintTest, SphereBehindEye) {
+    Sphere const sphere{
+        {Mat4d::translation(Vector{0., 0., -10.}), Transformation::Kind::Translation}};
+
+    EXPECT_FALSE(screen_footprint(sphere, camera).has_value());
+}
+
+TEST_F(FootprintTest, SphereAroundEyeCoversWholeImage) {
+    Sphere const sphere{
+        {Mat4d::translation(Vector{0., 0., -5.}), Transformation::Kind::Translation}};
+
+    auto const footprint = screen_footprint(sphere, camera);
+
+    ASSERT_TRUE(footprint.has_value());
+    EXPECT_EQ(footprint->width, camera.hsize());
+    EXPECT_EQ(footprint->height, camera.vsize());
+}
@@ -0,0 +1,89 @@
+#include <cherry_blazer/camera.hh>
+#include <cherry_blazer/color.hh>
+#include <cherry_blazer/g_buffer.hh>
+#include <cherry_blazer/point.hh>
+#include <cherry_blazer/point_light.hh>
+#include <cherry_blazer/shapes.hh>
+#include <cherry_blazer/sphere.hh>
+#include <cherry_blazer/square_matrix.hh>
+#include <cherry_blazer/transformation.hh>
+#include <cherry_blazer/vector.hh>
+#include <cherry_blazer/world.hh>
+
+#include <gtest/gtest.h>
+
+#include <numbers>
+#include <stdexcept>
+#include <utility>
+
+using cherry_blazer::Camera;
+using cherry_blazer::Canvas;
+using cherry_blazer::Color;
+using cherry_blazer::GBuffer;
+using cherry_blazer::Mat4d;
+using cherry_blazer::Point;
+using cherry_blazer::Sphere;
+using cherry_blazer::Transformation;
+using cherry_blazer::Vector;
+using cherry_blazer::World;
+
+using namespace std::numbers;
+
+class GBufferTest : public ::testing::Test {
+  protected:
+    World world{{Sphere{}, Sphere{{Mat4d::translation(Vector{1., 1., 2.}),
+                                   Transformation::Kind::Translation}}},
+                {{Point{-10., 10., -10.}, Color{1., 1., 1.}},
+                 {Point{10., 0., -10.}, Color{.2, .2, .4}}}};
+    Camera camera{31, 23, pi / 3.,
+                  view_transform(Point{0., 0., -5.}, Point{0., 0., 0.}, Vector{0., 1., 0.})};
+
+    void expect_matches_full_render(Canvas const& canvas) {
+        for (auto y{0U}; y < camera.vsize(); ++y)
+            for (auto x{0U}; x < camera.hsize(); ++x)
+                EXPECT_EQ(canvas(x, y), world.color_at(camera.ray_for_pixel(x, y)));
+    }
+};
+
+TEST_F(GBufferTest, ShadeMatchesFullRender) {
+    GBuffer const buffer{world, camera};
+
+    expect_matches_full_render(buffer.shade(world));
+}
+
+TEST_F(GBufferTest, BackgroundPixels) {
+    GBuffer const buffer{world, camera};
+
+    EXPECT_EQ(buffer.surface(0, 0).object, GBuffer::background);
+    EXPECT_EQ(buffer.surface(15, 11).object, 0U);
+}
+
+TEST_F(GBufferTest, ReshadeAfterMaterialAndLightChanges) {
+    GBuffer const buffer{world, camera};
+
+    world.objects()[0].material.color = Color{.3, .9, .1};
+    world.objects()[1].material.shininess = 20.;
+    world.lights()[1].intensity = Color{1., 0., 0.};
+
+    expect_matches_full_render(buffer.shade(world));
+}
+
+TEST_F(GBufferTest, ShadeNeedsMatchingWorld) {
+    GBuffer const buffer{world, camera};
+    World const other{{Sphere{}}, {{Point{-10., 10., -10.}, Color{1., 1., 1.}}}};
+
+    EXPECT_THROW((void)buffer.shade(other), std::logic_error);
+}
+
+TEST_F(GBufferTest, ShadeNeedsMatchingShapes) {
+    GBuffer const buffer{world, camera};
+    cherry_blazer::Shapes shapes;
+    shapes.planes.push_back({{}, {}});
+    World const other{{world.objects().begin(), world.objects().end()},
+                      {world.lights().begin(), world.lights().end()},
+                      {},
+                      {},
+                      std::move(shapes)};
+
+    EXPECT_THROW((void)buffer.shade(other), std::logic_error);
+}
@@ -0,0 +1,201 @@
+#include <cherry_blazer/axis.hh>
+#include <cherry_blazer/bvh.hh>
+#include <cherry_blazer/camera.hh>
+#include <cherry_blazer/canvas.hh>
+#include <cherry_blazer/color.hh>
+#include <cherry_blazer/group.hh>
+#include <cherry_blazer/matrix_operations.hh>
+#include <cherry_blazer/point.hh>
+#include <cherry_blazer/point_light.hh>
+#include <cherry_blazer/random.hh>
+#include <cherry_blazer/ray.hh>
+#include <cherry_blazer/render.hh>
+#include <cherry_blazer/sphere.hh>
+#include <cherry_blazer/square_matrix.hh>
+#include <cherry_blazer/transformation.hh>
+#include <cherry_blazer/vector.hh>
+#include <cherry_blazer/world.hh>
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <numbers>
+#include <stdexcept>
+#include <vector>
+
+using cherry_blazer::Axis;
+using cherry_blazer::Camera;
+using cherry_blazer::Canvas;
+using cherry_blazer::Color;
+using cherry_blazer::Group;
+using cherry_blazer::Instance;
+using cherry_blazer::Mat4d;
+using cherry_blazer::no_instance;
+using cherry_blazer::Point;
+using cherry_blazer::Ray;
+using cherry_blazer::SampleRandom;
+using cherry_blazer::Sphere;
+using cherry_blazer::Transformation;
+using cherry_blazer::Vector;
+using cherry_blazer::World;
+
+using namespace std::numbers;
+
+namespace {
+
+// A small cluster of colored spheres.
+std::shared_ptr<Group const> cluster() {
+    std::vector<Sphere> objects;
+    for (int i = 0; i < 3; ++i) {
+        auto const x = static_cast<double>(i);
+        Sphere sphere{{Mat4d::translation(Vector{x - 1., .5 * x, 0.}) *
+                           Mat4d::scaling(Vector{.4, .6, .4}),
+                       Transformation::Kind::Scaling}};
+        sphere.material.color = Color{x / 3., .5, 1. - x / 3.};
+        objects.push_back(sphere);
+    }
+    return std::make_shared<Group const>(std::move(objects));
+}
+
+// Clusters placed in a row, rotated and scaled differently.
+std::vector<Instance> placements(std::shared_ptr<Group const> const& group) {
+    std::vector<Instance> instances;
+    for (int i = 0; i < 4; ++i) {
+        auto const x = static_cast<double>(i);
+        auto const placement = Mat4d::translation(Vector{3. * x - 4.5, 0., 0.}) *
+                               Mat4d::rotation(Axis::Z, .3 * x) *
+                               Mat4d::scaling(Vector{1., 1. + .2 * x, 1.});
+        instances.push_back({group, Transformation{placement, Transformation::Kind::Scaling}});
+    }
+    return instances;
+}
+
+// The sphere of a group, transformed into the world on its own.
+Sphere placed(Instance const& instance, Sphere sphere) {
+    sphere.transformation = Transformation{
+        instance.transformation.mat * sphere.transformation.mat, Transformation::Kind::Scaling};
+    return sphere;
+}
+
+// The same spheres as the instances, without instancing.
+std::vector<Sphere> flattened(std::vector<Instance> const& instances) {
+    std::vector<Sphere> objects;
+    for (auto const& instance : instances) {
+        for (auto const& sphere : instance.group->objects())
+            objects.push_back(placed(instance, sphere));
+    }
+    return objects;
+}
+
+void expect_near(Canvas const& canvas, Canvas const& expected) {
+    ASSERT_EQ(canvas.width(), expected.width());
+    ASSERT_EQ(canvas.height(), expected.height());
+    for (auto y{0U}; y < canvas.height(); ++y) {
+        for (auto x{0U}; x < canvas.width(); ++x) {
+            EXPECT_NEAR(canvas(x, y).r, expected(x, y).r, 1e-9);
+            EXPECT_NEAR(canvas(x, y).g, expected(x, y).g, 1e-9);
+            EXPECT_NEAR(canvas(x, y).b, expected(x, y).b, 1e-9);
+        }
+    }
+}
+
+class GroupTest : public ::testing::Test {
+  protected:
+    std::shared_ptr<Group const> group{cluster()};
+    std::vector<Instance> instances{placements(group)};
+    World instanced{{Sphere{{Mat4d::translation(Vector{0., -101., 0.}) *
+                                 Mat4d::scaling(Vector{100., 100., 100.}),
+                             Transformation::Kind::Scaling}}},
+                    {{Point{-10., 10., -10.}, Color{1., 1., 1.}}},
+                    instances};
+    World flat{[this] {
+                   auto objects = flattened(instances);
+                   objects.insert(objects.begin(), instanced.objects()[0]);
+                   return objects;
+               }(),
+               {{Point{-10., 10., -10.}, Color{1., 1., 1.}}}};
+    Camera camera{41, 23, pi / 3.,
+                  view_transform(Point{0., 1., -9.}, Point{0., 0., 0.}, Vector{0., 1., 0.})};
+};
+
+} // namespace
+
+TEST_F(GroupTest, InstanceBoundsContainPlacedObjects) { // NOLINT
+    for (auto const& instance : instances) {
+        auto const box = bounds(instance);
+        for (auto const& sphere : group->objects()) {
+            auto const object_box = bounds(placed(instance, sphere));
+            for (std::size_t axis = 0; axis < 3; ++axis) {
+                EXPECT_LE(box.min[axis], object_box.min[axis] + 1e-12);
+                EXPECT_GE(box.max[axis], object_box.max[axis] - 1e-12);
+            }
+        }
+    }
+}
+
+TEST_F(GroupTest, InstancesShareTheGroup) { // NOLINT
+    ASSERT_EQ(instanced.instances().size(), 4U);
+    for (auto const& instance : instanced.instances())
+        EXPECT_EQ(instance.group.get(), group.get());
+    EXPECT_EQ(&instanced.object(1, 2), &group->objects()[1]);
+}
+
+TEST_F(GroupTest, ClosestHitMatchesFlattenedWorld) { // NOLINT
+    for (unsigned i = 0; i < 500; ++i) {
+        SampleRandom const random{i, 0, 0};
+        Ray const ray{Point{0., 1., -9.},
+                      Vector{random.uniform(0) - .5, .5 * (random.uniform(1) - .5), 1.}};
+
+        auto const hit = instanced.closest_hit(ray);
+        auto const expected = flat.closest_hit(ray);
+
+        ASSERT_EQ(hit.has_value(), expected.has_value());
+        if (!hit)
+            continue;
+        EXPECT_NEAR(hit->t, expected->t, 1e-9);
+        if (hit->instance == no_instance) {
+            EXPECT_EQ(hit->object, expected->object);
+        } else {
+            // the flattened world has the floor, then each instance's objects in turn
+            auto const objects_per_instance = std::uint32_t(group->objects().size());
+            EXPECT_EQ(1 + hit->instance * objects_per_instance + hit->object, expected->object);
+        }
+
+        auto const surface = instanced.surface(ray, *hit);
+        auto const expected_surface = flat.surface(ray, *expected);
+        for (std::size_t axis = 0; axis < 3; ++axis) {
+            EXPECT_NEAR(surface.normal_vector[axis], expected_surface.normal_vector[axis], 1e-9);
+            EXPECT_NEAR(surface.point[axis], expected_surface.point[axis], 1e-9);
+        }
+    }
+}
+
+TEST_F(GroupTest, OccludedMatchesFlattenedWorld) { // NOLINT
+    for (unsigned i = 0; i < 500; ++i) {
+        SampleRandom const random{i, 1, 0};
+        Point const point{12. * random.uniform(0) - 6., 2. * random.uniform(1) - .5, -1.};
+        Ray const to_light{point, Point{-10., 10., -10.} - point};
+
+        EXPECT_EQ(instanced.occluded(to_light, 1.), flat.occluded(to_light, 1.));
+    }
+}
+
+TEST_F(GroupTest, RenderMatchesFlattenedWorld) { // NOLINT
+    expect_near(render(instanced, camera), render(flat, camera));
+    expect_near(render_rasterized(instanced, camera), render(flat, camera));
+}
+
+TEST_F(GroupTest, AntialiasingTellsInstancesApart) { // NOLINT
+    // Instances share their objects' ids, yet the edges between them get supersampled.
+    auto const [canvas, supersampled_pixels] = render_antialiased(instanced, camera, {2, 10.});
+    auto const [expected, expected_pixels] = render_antialiased(flat, camera, {2, 10.});
+
+    EXPECT_EQ(supersampled_pixels, expected_pixels);
+    expect_near(canvas, expected);
+}
+
+TEST_F(GroupTest, InstanceWithoutGroupThrows) { // NOLINT
+    EXPECT_THROW((World{{}, {}, {Instance{nullptr, Transformation{}}}}), std::logic_error);
+}
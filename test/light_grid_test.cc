@@ -0,0 +1,77 @@
+#include <cherry_blazer/light_grid.hh>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <exception>
+#include <span>
+#include <vector>
+
+using cherry_blazer::Color;
+using cherry_blazer::LightGrid;
+using cherry_blazer::Point;
+using cherry_blazer::PointLight;
+
+namespace {
+
+bool contains(std::span<std::uint32_t const> indices, std::uint32_t index) {
+    return std::find(indices.begin(), indices.end(), index) != indices.end();
+}
+
+} // namespace
+
+TEST(LightGridTest, LightsWithoutRadiusAreUnbounded) {
+    LightGrid grid{{PointLight{Point{0., 0., 0.}, Color{1., 1., 1.}},
+                    PointLight{Point{5., 0., 0.}, Color{1., 1., 1.}, 1.}}};
+
+    ASSERT_EQ(grid.unbounded().size(), 1);
+    EXPECT_EQ(grid.unbounded()[0], 0);
+    EXPECT_FALSE(contains(grid.nearby(Point{0., 0., 0.}), 0));
+}
+
+TEST(LightGridTest, NearbyFindsOnlyLightsInReach) {
+    std::vector<PointLight> lights;
+    for (auto i{0}; i < 10; ++i)
+        lights.push_back({Point{double(i) * 10., 0., 0.}, Color{1., 1., 1.}, 2.});
+    LightGrid grid{lights, 1.};
+
+    auto const near_third = grid.nearby(Point{30.5, 0., 0.});
+
+    EXPECT_TRUE(contains(near_third, 3));
+    EXPECT_FALSE(contains(near_third, 2));
+    EXPECT_FALSE(contains(near_third, 4));
+    EXPECT_LE(near_third.size(), 1);
+}
+
+TEST(LightGridTest, NearbyOutsideOfGridIsEmpty) {
+    LightGrid grid{{PointLight{Point{0., 0., 0.}, Color{1., 1., 1.}, 1.}}};
+
+    EXPECT_TRUE(grid.nearby(Point{100., 0., 0.}).empty());
+    EXPECT_TRUE(grid.nearby(Point{0., -100., 0.}).empty());
+}
+
+TEST(LightGridTest, EveryPointInReachOfLightFindsIt) {
+    std::vector<PointLight> lights{{Point{0., 0., 0.}, Color{1., 1., 1.}, 3.},
+                                   {Point{4., 1., -2.}, Color{1., 1., 1.}, .5},
+                                   {Point{-3., 2., 1.}, Color{1., 1., 1.}, 1.5}};
+    LightGrid grid{lights};
+
+    for (std::uint32_t i{}; i < lights.size(); ++i) {
+        auto const& light = lights[i];
+        for (auto const dx : {-.99, 0., .99})
+            for (auto const dy : {-.99, 0., .99}) {
+                Point point{light.position[0] + dx * light.radius / 2.,
+                            light.position[1] + dy * light.radius / 2., light.position[2]};
+                EXPECT_TRUE(contains(grid.nearby(point), i));
+            }
+    }
+}
+
+TEST(LightGridTest, InvalidParametersThrow) {
+    std::vector<PointLight> lights{{Point{0., 0., 0.}, Color{1., 1., 1.}, 1.}};
+
+    EXPECT_THROW((LightGrid{lights, 0.}), std::logic_error);
+    EXPECT_THROW((LightGrid{{PointLight{Point{0., 0., 0.}, Color{1., 1., 1.}, -1.}}}),
+                 std::logic_error);
+}
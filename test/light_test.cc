@@ -2,6 +2,8 @@
 
 #include <gtest/gtest.h>
 
+#include <cmath>
+
 using cherry_blazer::Color;
 using cherry_blazer::Point;
 using cherry_blazer::PointLight;
@@ -14,3 +16,9 @@ TEST(PointLightTest, PointLightCtor) {
     EXPECT_EQ(point_light.position, position);
     EXPECT_EQ(point_light.intensity, intensity);
 }
+
+TEST(PointLightTest, PointLightReachesEverywhereByDefault) {
+    PointLight point_light{Point{0., 0., 0.}, Color{1., 1., 1.}};
+
+    EXPECT_TRUE(std::isinf(point_light.radius));
+}
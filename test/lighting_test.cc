@@ -3,12 +3,16 @@
 #include <gtest/gtest.h>
 
 #include <numbers>
+#include <span>
+#include <vector>
 
 using cherry_blazer::Color;
+using cherry_blazer::LightGrid;
 using cherry_blazer::Material;
 using cherry_blazer::Point;
 using cherry_blazer::Point3d;
 using cherry_blazer::PointLight;
+using cherry_blazer::SpecularQuality;
 using cherry_blazer::Vector;
 
 using namespace std::numbers;
@@ -77,3 +81,114 @@ TEST_F(LightingTest, LightingWithLightBehindSurface) {
 
     EXPECT_EQ(expected, result);
 }
+
+TEST_F(LightingTest, LightingWithFastSpecularMatchesExact) {
+    Vector eye_vector{0., -sqrt2_v<double> / 2., -sqrt2_v<double> / 2.};
+    Vector normal_vector{0., 0., -1.};
+    PointLight light{Point{0., 10., -10.}, Color{1., 1., 1.}};
+
+    for (auto shininess : {200., 10., 10.5}) {
+        material.shininess = shininess;
+        auto expected = lighting(material, light, position, eye_vector, normal_vector);
+
+        auto result = lighting(material, light, position, eye_vector, normal_vector,
+                               SpecularQuality::Fast);
+
+        EXPECT_EQ(expected, result);
+    }
+}
+
+TEST_F(LightingTest, LightingWithApproximateSpecularIsCloseToExact) {
+    Vector eye_vector{0., -.6, -.8};
+    Vector normal_vector{0., 0., -1.};
+    PointLight light{Point{0., 10., -10.}, Color{1., 1., 1.}};
+
+    for (auto shininess : {200., 10., 10.5, 1.}) {
+        material.shininess = shininess;
+        auto expected = lighting(material, light, position, eye_vector, normal_vector);
+
+        auto result = lighting(material, light, position, eye_vector, normal_vector,
+                               SpecularQuality::Approximate);
+
+        EXPECT_NEAR(result.r, expected.r, 1e-5);
+        EXPECT_NEAR(result.g, expected.g, 1e-5);
+        EXPECT_NEAR(result.b, expected.b, 1e-5);
+    }
+}
+
+TEST_F(LightingTest, LightingWithLightOutOfReach) {
+    Vector eye_vector{0., 0., -1.};
+    Vector normal_vector{0., 0., -1.};
+    PointLight light{Point{0., 0., -10.}, Color{1., 1., 1.}, 5.};
+    Color expected{0., 0., 0.};
+
+    auto result = lighting(material, light, position, eye_vector, normal_vector);
+
+    EXPECT_EQ(expected, result);
+}
+
+TEST_F(LightingTest, LightingWithSurfaceInShadow) {
+    Vector eye_vector{0., 0., -1.};
+    Vector normal_vector{0., 0., -1.};
+    PointLight light{Point{0., 0., -10.}, Color{1., 1., 1.}};
+    Color expected{.1, .1, .1};
+
+    auto result = lighting(material, light, position, eye_vector, normal_vector, true);
+
+    EXPECT_EQ(expected, result);
+}
+
+TEST_F(LightingTest, LightingWithManyLightsSkipsShadowedOnes) {
+    Vector eye_vector{0., 0., -1.};
+    Vector normal_vector{0., 0., -1.};
+    std::vector<PointLight> lights{{Point{0., 0., -10.}, Color{1., 1., 1.}},
+                                   {Point{0., 0., -10.}, Color{1., 1., 1.}}};
+    bool const in_shadow[] = {true, false};
+    Color expected{2., 2., 2.}; // ambient of the first light, everything of the second one
+
+    auto result = lighting(material, std::span<PointLight const>{lights}, position, eye_vector,
+                           normal_vector, std::span<bool const>{in_shadow}, SpecularQuality::Exact);
+
+    EXPECT_EQ(expected, result);
+}
+
+TEST_F(LightingTest, LightingFadesOutTowardsLightRadius) {
+    Vector eye_vector{0., 0., -1.};
+    Vector normal_vector{0., 0., -1.};
+    PointLight near_light{Point{0., 0., -1.}, Color{1., 1., 1.}, 10.};
+    PointLight far_light{Point{0., 0., -9.}, Color{1., 1., 1.}, 10.};
+
+    auto near = lighting(material, near_light, position, eye_vector, normal_vector);
+    auto far = lighting(material, far_light, position, eye_vector, normal_vector);
+
+    EXPECT_GT(near.r, far.r);
+    EXPECT_GT(far.r, 0.);
+}
+
+TEST_F(LightingTest, LightingWithManyLightsSumsContributions) {
+    Vector eye_vector{0., 0., -1.};
+    Vector normal_vector{0., 0., -1.};
+    std::vector<PointLight> lights{{Point{0., 0., -10.}, Color{1., 1., 1.}},
+                                   {Point{0., 0., 10.}, Color{1., 1., 1.}},
+                                   {Point{0., 0., -10.}, Color{1., 1., 1.}, 5.}};
+    Color expected{1.9 + .1, 1.9 + .1, 1.9 + .1};
+
+    auto result = lighting(material, std::span{lights}, position, eye_vector, normal_vector);
+
+    EXPECT_EQ(expected, result);
+}
+
+TEST_F(LightingTest, LightingWithLightGridMatchesAllLights) {
+    Vector eye_vector{0., -sqrt2_v<double> / 2., -sqrt2_v<double> / 2.};
+    Vector normal_vector{0., 0., -1.};
+    std::vector<PointLight> lights{{Point{0., 10., -10.}, Color{1., 1., 1.}}};
+    for (auto i{0}; i < 100; ++i)
+        lights.push_back({Point{double(i % 10) - 5., double(i / 10) - 5., -1.}, Color{.1, .2, .3},
+                          1.5});
+    LightGrid grid{lights};
+
+    auto expected = lighting(material, std::span{lights}, position, eye_vector, normal_vector);
+    auto result = lighting(material, grid, position, eye_vector, normal_vector);
+
+    EXPECT_EQ(expected, result);
+}
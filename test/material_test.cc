@@ -13,4 +13,7 @@ TEST(MaterialTest, DefaultMaterial) {
     EXPECT_DOUBLE_EQ(material.diffuse, .9);
     EXPECT_DOUBLE_EQ(material.specular, .9);
     EXPECT_DOUBLE_EQ(material.shininess, 200.);
+    EXPECT_DOUBLE_EQ(material.reflective, 0.);
+    EXPECT_DOUBLE_EQ(material.transparency, 0.);
+    EXPECT_DOUBLE_EQ(material.refractive_index, 1.);
 }
@@ -0,0 +1,195 @@
+#include <cherry_blazer/bvh.hh>
+#include <cherry_blazer/camera.hh>
+#include <cherry_blazer/color.hh>
+#include <cherry_blazer/mesh.hh>
+#include <cherry_blazer/point.hh>
+#include <cherry_blazer/point_light.hh>
+#include <cherry_blazer/random.hh>
+#include <cherry_blazer/ray.hh>
+#include <cherry_blazer/sphere.hh>
+#include <cherry_blazer/vector.hh>
+#include <cherry_blazer/world.hh>
+
+#include "render_helpers.hh"
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <numbers>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+using cherry_blazer::Camera;
+using cherry_blazer::Color;
+using cherry_blazer::intersect_triangle;
+using cherry_blazer::Mesh;
+using cherry_blazer::no_mesh;
+using cherry_blazer::Point;
+using cherry_blazer::Ray;
+using cherry_blazer::SampleRandom;
+using cherry_blazer::Sphere;
+using cherry_blazer::Vector;
+using cherry_blazer::World;
+using cherry_blazer::test::count_pixels;
+using cherry_blazer::test::expect_renderers_agree;
+
+using namespace std::numbers;
+
+namespace {
+
+constexpr auto infinity = std::numeric_limits<double>::infinity();
+
+// A grid of size x size squares in the plane z = 0, two triangles each, facing -z.
+Mesh grid(unsigned size) {
+    std::vector<double> x;
+    std::vector<double> y;
+    std::vector<double> z;
+    for (unsigned row = 0; row <= size; ++row) {
+        for (unsigned col = 0; col <= size; ++col) {
+            SampleRandom const random{row, col, 0};
+            x.push_back(double(col) - double(size) / 2.);
+            y.push_back(double(row) - double(size) / 2.);
+            z.push_back(random.uniform(0) - .5);
+        }
+    }
+    std::vector<std::uint32_t> indices;
+    auto const vertex = [size](unsigned row, unsigned col) { return row * (size + 1) + col; };
+    for (unsigned row = 0; row < size; ++row) {
+        for (unsigned col = 0; col < size; ++col) {
+            indices.insert(indices.end(), {vertex(row, col), vertex(row + 1, col),
+                                           vertex(row + 1, col + 1)});
+            indices.insert(indices.end(), {vertex(row, col), vertex(row + 1, col + 1),
+                                           vertex(row, col + 1)});
+        }
+    }
+    return {std::move(x), std::move(y), std::move(z), std::move(indices)};
+}
+
+} // namespace
+
+TEST(MeshTest, RayThroughTriangle) { // NOLINT
+    std::array<double, 3> const a{0., 1., 0.};
+    std::array<double, 3> const b{-1., 0., 0.};
+    std::array<double, 3> const c{1., 0., 0.};
+
+    auto const hit = intersect_triangle(a, b, c, Ray{Point{0., .5, -2.}, Vector{0., 0., 1.}}, 0.,
+                                        infinity);
+
+    ASSERT_TRUE(hit.has_value());
+    EXPECT_DOUBLE_EQ(hit->t, 2.);
+    EXPECT_DOUBLE_EQ(hit->u, .25);
+    EXPECT_DOUBLE_EQ(hit->v, .25);
+}
+
+TEST(MeshTest, RayMissesTriangle) { // NOLINT
+    std::array<double, 3> const a{0., 1., 0.};
+    std::array<double, 3> const b{-1., 0., 0.};
+    std::array<double, 3> const c{1., 0., 0.};
+
+    // parallel, and past each of the three edges
+    EXPECT_FALSE(intersect_triangle(a, b, c, Ray{Point{0., -1., -2.}, Vector{0., 1., 0.}}, 0.,
+                                    infinity));
+    EXPECT_FALSE(intersect_triangle(a, b, c, Ray{Point{1., 1., -2.}, Vector{0., 0., 1.}}, 0.,
+                                    infinity));
+    EXPECT_FALSE(intersect_triangle(a, b, c, Ray{Point{-1., 1., -2.}, Vector{0., 0., 1.}}, 0.,
+                                    infinity));
+    EXPECT_FALSE(intersect_triangle(a, b, c, Ray{Point{0., -1., -2.}, Vector{0., 0., 1.}}, 0.,
+                                    infinity));
+    // beyond max_t
+    EXPECT_FALSE(intersect_triangle(a, b, c, Ray{Point{0., .5, -2.}, Vector{0., 0., 1.}}, 0., 1.));
+}
+
+TEST(MeshTest, NormalFollowsWinding) { // NOLINT
+    // counterclockwise seen from +z
+    Mesh const mesh{{0., -1., 1.}, {1., 0., 0.}, {0., 0., 0.}, {0, 1, 2}};
+
+    auto const normal = mesh.normal(0);
+
+    EXPECT_DOUBLE_EQ(normal[0], 0.);
+    EXPECT_DOUBLE_EQ(normal[1], 0.);
+    EXPECT_DOUBLE_EQ(normal[2], 1.);
+}
+
+TEST(MeshTest, InvalidMeshesThrow) { // NOLINT
+    EXPECT_THROW((Mesh{{0., 1.}, {0., 1.}, {0.}, {}}), std::logic_error);
+    EXPECT_THROW((Mesh{{0., 1., 2.}, {0., 1., 2.}, {0., 1., 2.}, {0, 1}}), std::logic_error);
+    EXPECT_THROW((Mesh{{0., 1., 2.}, {0., 1., 2.}, {0., 1., 2.}, {0, 1, 3}}), std::logic_error);
+}
+
+TEST(MeshTest, ClosestHitMatchesTestingEveryTriangle) { // NOLINT
+    auto const mesh = grid(64);
+    auto const indices = mesh.indices();
+
+    for (unsigned i = 0; i < 300; ++i) {
+        SampleRandom const random{i, 1, 0};
+        Ray const ray{Point{0., 0., -20.},
+                      Vector{random.uniform(0) - .5, random.uniform(1) - .5, .3}};
+
+        std::optional<double> expected;
+        for (std::size_t triangle = 0; triangle < mesh.triangle_count(); ++triangle) {
+            auto const corner = [&](std::size_t k) {
+                auto const index = indices[3 * triangle + k];
+                return std::array<double, 3>{mesh.x()[index], mesh.y()[index], mesh.z()[index]};
+            };
+            auto const hit = intersect_triangle(corner(0), corner(1), corner(2), ray, 0., infinity);
+            if (hit && (!expected || hit->t < *expected))
+                expected = hit->t;
+        }
+
+        auto const hit = mesh.closest_hit(ray, infinity);
+        ASSERT_EQ(hit.has_value(), expected.has_value());
+        if (expected) {
+            EXPECT_EQ(hit->first.t, *expected);
+        }
+    }
+}
+
+TEST(MeshTest, OccludedOnlyBetweenOriginAndMaxT) { // NOLINT
+    auto const mesh = grid(8);
+    Ray const ray{Point{.25, .25, -5.}, Vector{0., 0., 1.}};
+
+    EXPECT_TRUE(mesh.occluded(ray, 10.));
+    EXPECT_FALSE(mesh.occluded(ray, 4.));
+}
+
+TEST(MeshTest, WorldHitsAndShadesMeshes) { // NOLINT
+    auto mesh = grid(8);
+    mesh.material.color = Color{.2, .4, .8};
+    World const world{{}, {{Point{0., 0., -10.}, Color{1., 1., 1.}}}, {}, {std::move(mesh)}};
+    Ray const ray{Point{.25, .25, -5.}, Vector{0., 0., 1.}};
+
+    auto const hit = world.closest_hit(ray);
+    ASSERT_TRUE(hit.has_value());
+    EXPECT_EQ(hit->mesh, 0U);
+    auto const surface = world.surface(ray, *hit);
+    EXPECT_EQ(surface.mesh, 0U);
+    EXPECT_LT(surface.normal_vector[2], 0.); // towards the eye
+    EXPECT_EQ(&world.material(surface), &world.meshes()[0].material);
+    EXPECT_GT(world.shade(ray, *hit).b, .4);
+
+    // the light is on the same side, so points just behind the mesh are in its shadow
+    EXPECT_TRUE(world.occluded(Ray{Point{.25, .25, 2.}, Point{0., 0., -10.} - Point{.25, .25, 2.}},
+                               1.));
+    EXPECT_FALSE(world.closest_hit(Ray{Point{20., 0., -5.}, Vector{0., 0., 1.}}).has_value());
+}
+
+TEST(MeshTest, RenderersAgreeOnMeshes) { // NOLINT
+    World const world{{Sphere{}},
+                      {{Point{-10., 10., -10.}, Color{1., 1., 1.}}},
+                      {},
+                      {grid(16)}};
+    Camera const camera{31, 27, pi / 2.,
+                        view_transform(Point{0., 0., -9.}, Point{0., 0., 0.}, Vector{0., 1., 0.})};
+
+    expect_renderers_agree(world, camera);
+    EXPECT_GT(count_pixels(world, camera,
+                           [](Ray const& /*ray*/, cherry_blazer::Hit const& hit) {
+                               return hit.mesh != no_mesh;
+                           }),
+              0);
+}
@@ -10,7 +10,10 @@
 
 #include <gtest/gtest.h>
 
+#include <cstddef>
 #include <numbers>
+#include <stdexcept>
+#include <vector>
 
 namespace {
 inline constexpr double abs_error = 1e-5;
@@ -124,3 +127,31 @@ TEST(NormalTest, NormalOnTransformedSphere) {
 
     EXPECT_DOUBLE_EQ(normal_vector[Coord::W], expected[Coord::W]);
 }
+
+TEST(NormalTest, NormalsOfManyPoints) {
+    using namespace std::numbers;
+
+    Sphere sphere{Transformation{Mat4d::translation(Vector{1., 2., 3.}) *
+                                     Mat4d::scaling(Vector{2., 1., .5}),
+                                 Transformation::Kind::Scaling}};
+    std::vector<cherry_blazer::Point3d> const points{
+        Point{3., 2., 3.}, Point{1., 3., 3.}, Point{1., 2., 2.5}, Point{-1., 2., 3.}};
+    std::vector<cherry_blazer::Vec3d> normal_vectors(points.size());
+
+    normals(sphere, points, normal_vectors);
+
+    for (std::size_t i = 0; i < points.size(); ++i) {
+        EXPECT_EQ(normal_vectors[i], normal(sphere, points[i]));
+        EXPECT_DOUBLE_EQ(normal_vectors[i][Coord::W], 0.);
+    }
+    EXPECT_EQ(normal_vectors[0], (Vector{1., 0., 0.}));
+    EXPECT_EQ(normal_vectors[2], (Vector{0., 0., -1.}));
+}
+
+TEST(NormalTest, NormalsNeedOneOutputPerPoint) {
+    Sphere sphere;
+    std::vector<cherry_blazer::Point3d> const points(3);
+    std::vector<cherry_blazer::Vec3d> normal_vectors(2);
+
+    EXPECT_THROW(normals(sphere, points, normal_vectors), std::logic_error);
+}
@@ -0,0 +1,133 @@
+#include <cherry_blazer/mesh.hh>
+#include <cherry_blazer/obj.hh>
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <vector>
+
+using cherry_blazer::load_obj;
+using cherry_blazer::parse_obj;
+
+TEST(ObjTest, ReadsVerticesAndTriangles) { // NOLINT
+    auto const mesh = parse_obj("# a triangle\n"
+                                "v 0 1 0\n"
+                                "v -1 0 0.5\n"
+                                "v 1 0 -2.5e1\n"
+                                "vn 0 0 -1\n"
+                                "f 1 2 3\n");
+
+    ASSERT_EQ(mesh.vertex_count(), 3U);
+    ASSERT_EQ(mesh.triangle_count(), 1U);
+    EXPECT_EQ(mesh.x()[1], -1.);
+    EXPECT_EQ(mesh.z()[1], .5);
+    EXPECT_EQ(mesh.z()[2], -25.);
+    EXPECT_EQ(mesh.indices()[0], 0U);
+    EXPECT_EQ(mesh.indices()[1], 1U);
+    EXPECT_EQ(mesh.indices()[2], 2U);
+}
+
+TEST(ObjTest, SplitsPolygonsAroundFirstVertex) { // NOLINT
+    auto const mesh = parse_obj("v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\nv -1 .5 0\n"
+                                "f 1/1/1 2/2/2 3/3/3 4//4 5/5\n");
+
+    std::vector<std::uint32_t> const expected{0, 1, 2, 0, 2, 3, 0, 3, 4};
+    ASSERT_EQ(mesh.triangle_count(), 3U);
+    for (std::size_t i = 0; i < expected.size(); ++i)
+        EXPECT_EQ(mesh.indices()[i], expected[i]);
+}
+
+TEST(ObjTest, NegativeIndicesCountBack) { // NOLINT
+    auto const mesh = parse_obj("v 0 0 0\nv 1 0 0\nv 1 1 0\nf -3 -2 -1\n"
+                                "v 0 1 0\nf -4 -2 -1\n");
+
+    std::vector<std::uint32_t> const expected{0, 1, 2, 0, 2, 3};
+    ASSERT_EQ(mesh.triangle_count(), 2U);
+    for (std::size_t i = 0; i < expected.size(); ++i)
+        EXPECT_EQ(mesh.indices()[i], expected[i]);
+}
+
+TEST(ObjTest, SkipsOtherStatementsAndBlankLines) { // NOLINT
+    auto const mesh = parse_obj("mtllib scene.mtl\r\n\r\no thing\r\ng part\r\nusemtl red\r\n"
+                                "v 0 0 0\r\nvt 0 0\r\nv 1 0 0\r\nv 0 1 0\r\ns off\r\n"
+                                "f 1 2 3 # done\r\n");
+
+    EXPECT_EQ(mesh.vertex_count(), 3U);
+    EXPECT_EQ(mesh.triangle_count(), 1U);
+}
+
+TEST(ObjTest, LargeTextIsReadInChunks) { // NOLINT
+    // Several chunks' worth of lines, with faces referring back across chunk boundaries.
+    std::string text;
+    constexpr unsigned strips = 80000;
+    for (unsigned i = 0; i < strips; ++i) {
+        auto const x = std::to_string(i);
+        text += "v " + x + " 0 0\nv " + x + " 1 0\n";
+        if (i > 0)
+            text += "f -4 -2 -1 -3\n";
+    }
+
+    auto const mesh = parse_obj(text);
+
+    ASSERT_EQ(mesh.vertex_count(), 2 * strips);
+    ASSERT_EQ(mesh.triangle_count(), 2 * (strips - 1));
+    for (std::uint32_t strip = 0; strip + 1 < strips; ++strip) {
+        auto const* const indices = &mesh.indices()[6 * strip];
+        EXPECT_EQ(indices[0], 2 * strip);
+        EXPECT_EQ(indices[2], 2 * strip + 3);
+        EXPECT_EQ(indices[5], 2 * strip + 1);
+    }
+    EXPECT_EQ(mesh.x()[2 * strips - 1], double(strips - 1));
+}
+
+TEST(ObjTest, ErrorsNameTheLine) { // NOLINT
+    auto const message = [](char const* text) {
+        try {
+            (void)parse_obj(text);
+        } catch (std::logic_error const& e) {
+            return std::string{e.what()};
+        }
+        return std::string{};
+    };
+
+    EXPECT_EQ(message("v 0 0 0\nv 1 0 x\n"), "line 2: expected a number, got 'x'");
+    EXPECT_EQ(message("v 0 0 0\nv 1 0 0\n\nf 1 2\n"), "line 4: face of fewer than three vertices");
+    EXPECT_EQ(message("v 0 0 0\nv 1 0 0\nf 1 2 4\n"), "line 3: no vertex 4");
+    EXPECT_EQ(message("v 0 0 0\nf -2 1 1\n"), "line 2: no vertex -2");
+    EXPECT_EQ(message("v 0 0 0\nf 0 1 1\n"), "line 2: no vertex 0");
+}
+
+TEST(ObjTest, LoadsFiles) { // NOLINT
+    auto const path = std::filesystem::temp_directory_path() / "obj_test.obj";
+    {
+        std::ofstream file{path};
+        file << "v 0 0 0\nv 1 0 0\nv 0 1 0\nv 1 1 0\nf 1 2 3\nf 2 4 3\n";
+    }
+
+    auto const mesh = load_obj(path);
+    std::filesystem::remove(path);
+
+    EXPECT_EQ(mesh.vertex_count(), 4U);
+    EXPECT_EQ(mesh.triangle_count(), 2U);
+}
+
+TEST(ObjTest, LoadsEmptyFiles) { // NOLINT
+    auto const path = std::filesystem::temp_directory_path() / "obj_test_empty.obj";
+    std::ofstream{path}.close();
+
+    auto const mesh = load_obj(path);
+    std::filesystem::remove(path);
+
+    EXPECT_EQ(mesh.vertex_count(), 0U);
+    EXPECT_EQ(mesh.triangle_count(), 0U);
+}
+
+TEST(ObjTest, MissingFileThrows) { // NOLINT
+    EXPECT_THROW((void)load_obj("/nonexistent/mesh.obj"), std::system_error);
+}
@@ -0,0 +1,60 @@
+#include <cherry_blazer/parallel.hh>
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+using cherry_blazer::parallel_for;
+using cherry_blazer::parallel_invoke;
+
+TEST(ParallelTest, ParallelForCoversEveryIndexOnce) { // NOLINT
+    constexpr std::size_t count = 10007;
+    std::vector<std::atomic<int>> visits(count);
+
+    parallel_for(count, 64, [&](std::size_t begin, std::size_t end) {
+        EXPECT_LE(end - begin, 64);
+        for (auto i = begin; i < end; ++i)
+            ++visits[i];
+    });
+
+    for (auto const& visit : visits)
+        EXPECT_EQ(visit, 1);
+}
+
+TEST(ParallelTest, ParallelForOfNothingDoesNothing) { // NOLINT
+    auto called = false;
+
+    parallel_for(0, 16, [&](std::size_t, std::size_t) { called = true; });
+
+    EXPECT_FALSE(called);
+}
+
+TEST(ParallelTest, ParallelForRethrows) { // NOLINT
+    EXPECT_THROW(parallel_for(1000, 1,
+                              [](std::size_t begin, std::size_t) {
+                                  if (begin == 500)
+                                      throw std::logic_error{"chunk 500"};
+                              }),
+                 std::logic_error);
+}
+
+TEST(ParallelTest, ParallelInvokeRunsBoth) { // NOLINT
+    auto first = false;
+    auto second = false;
+
+    parallel_invoke([&] { first = true; }, [&] { second = true; });
+
+    EXPECT_TRUE(first);
+    EXPECT_TRUE(second);
+}
+
+TEST(ParallelTest, ParallelInvokeRethrows) { // NOLINT
+    auto second = false;
+
+    EXPECT_THROW(parallel_invoke([] { throw std::logic_error{"first"}; }, [&] { second = true; }),
+                 std::logic_error);
+    EXPECT_TRUE(second);
+}
@@ -0,0 +1,172 @@
+#include <cherry_blazer/camera.hh>
+#include <cherry_blazer/color.hh>
+#include <cherry_blazer/path_tracer.hh>
+#include <cherry_blazer/point.hh>
+#include <cherry_blazer/point_light.hh>
+#include <cherry_blazer/random.hh>
+#include <cherry_blazer/ray.hh>
+#include <cherry_blazer/shapes.hh>
+#include <cherry_blazer/sphere.hh>
+#include <cherry_blazer/square_matrix.hh>
+#include <cherry_blazer/transformation.hh>
+#include <cherry_blazer/vector.hh>
+#include <cherry_blazer/world.hh>
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <numbers>
+#include <stdexcept>
+
+using cherry_blazer::Camera;
+using cherry_blazer::Color;
+using cherry_blazer::Mat4d;
+using cherry_blazer::PathTracing;
+using cherry_blazer::Point;
+using cherry_blazer::Ray;
+using cherry_blazer::SampleRandom;
+using cherry_blazer::Shapes;
+using cherry_blazer::Sphere;
+using cherry_blazer::Transformation;
+using cherry_blazer::Vector;
+using cherry_blazer::World;
+
+using namespace std::numbers;
+
+namespace {
+
+constexpr auto albedo = .5;
+
+// Inside a sphere with a light at its center, every point of the sphere gets the same direct
+// light, albedo, whichever way a path bounces, so a path of n bounces brings albedo^(n+1).
+World furnace() {
+    Sphere sphere{{Mat4d::scaling(Vector{2., 2., 2.}), Transformation::Kind::Scaling}};
+    sphere.material.diffuse = albedo;
+    sphere.material.specular = 0.;
+    return World{{sphere}, {{Point{0., 0., 0.}, Color{1., 1., 1.}}}};
+}
+
+Ray const from_center{Point{0., 0., 0.}, Vector{0., 0., 1.}};
+
+// Sum of albedo^n over n in [1;terms].
+double geometric_sum(unsigned terms) {
+    return albedo * (1. - std::pow(albedo, terms)) / (1. - albedo);
+}
+
+} // namespace
+
+TEST(PathTracerTest, PathsGatherTheLightOfEveryBounce) { // NOLINT
+    auto const world = furnace();
+    PathTracing settings;
+    settings.max_depth = 7;
+    settings.min_depth = settings.max_depth; // no Russian roulette
+
+    for (auto sample{0U}; sample < 4; ++sample) {
+        auto const color = trace_path(world, from_center, SampleRandom{0, 0, sample}, settings);
+        EXPECT_NEAR(color.r, geometric_sum(8), 1e-12);
+        EXPECT_NEAR(color.g, geometric_sum(8), 1e-12);
+        EXPECT_NEAR(color.b, geometric_sum(8), 1e-12);
+    }
+}
+
+TEST(PathTracerTest, RussianRouletteStaysUnbiased) { // NOLINT
+    auto const world = furnace();
+    PathTracing settings;
+    settings.min_depth = 0;
+    settings.max_depth = 32;
+
+    // Every bounce survives with the probability of the throughput, albedo, and is weighted up
+    // by its inverse, so each one brings albedo.
+    auto constexpr samples = 40000U;
+    auto sum = 0.;
+    auto ended_at_once = 0U;
+    for (auto sample{0U}; sample < samples; ++sample) {
+        auto const color = trace_path(world, from_center, SampleRandom{0, 0, sample}, settings);
+        sum += color.r;
+        if (std::abs(color.r - albedo) < 1e-9)
+            ++ended_at_once;
+    }
+    EXPECT_NEAR(sum / samples, geometric_sum(settings.max_depth + 1), .015);
+    EXPECT_NEAR(double(ended_at_once) / samples, 1. - albedo, .02);
+}
+
+TEST(PathTracerTest, DirectLightHasNoAmbientAndRespectsShadows) { // NOLINT
+    // A floor, lit from straight above, with a ball hanging over the middle. Light bouncing off the
+    // floor escapes upward, and the ball's underside is black.
+    Shapes shapes;
+    shapes.planes.push_back({});
+    shapes.planes.back().material.specular = 0.;
+    shapes.planes.back().material.ambient = 1.;
+    Sphere ball{{Mat4d::translation(Vector{0., 5., 0.}), Transformation::Kind::Translation}};
+    ball.material.diffuse = 0.;
+    ball.material.specular = 0.;
+    World const world{{ball}, {{Point{0., 10., 0.}, Color{1., 1., 1.}}}, {}, {}, shapes};
+
+    auto const lit = trace_path(world, Ray{Point{3., 1., 0.}, Vector{0., -1., 0.}},
+                                SampleRandom{0, 0, 0});
+    // cos = 10 / sqrt(109) to the light, diffuse .9
+    EXPECT_NEAR(lit.r, .9 * 10. / std::sqrt(109.), 1e-5);
+
+    auto const shadowed = trace_path(world, Ray{Point{0., 1., 0.}, Vector{0., -1., 0.}},
+                                     SampleRandom{0, 0, 0});
+    EXPECT_EQ(shadowed, (Color{0., 0., 0.}));
+
+    World const dark{{ball}, {}, {}, {}, shapes};
+    EXPECT_EQ(trace_path(dark, Ray{Point{3., 1., 0.}, Vector{0., -1., 0.}}, SampleRandom{0, 0, 0}),
+              (Color{0., 0., 0.}));
+}
+
+TEST(PathTracerTest, ScatteringIsPickedInProportionToItsWeight) { // NOLINT
+    // The sphere both reflects and scatters diffusely. Whichever way is picked, the bounce is
+    // weighted by the weight of both, over the probability of the pick, and ends up on a point of
+    // the sphere with the same direct light.
+    auto world = furnace();
+    world.objects()[0].material.reflective = 1.;
+    PathTracing settings;
+    settings.min_depth = 1;
+    settings.max_depth = 1;
+    for (auto sample{0U}; sample < 8; ++sample) {
+        auto const color = trace_path(world, from_center, SampleRandom{0, 0, sample}, settings);
+        EXPECT_NEAR(color.r, albedo + (albedo + 1.) * albedo, 1e-12);
+    }
+
+    // Light passing through goes out into the dark, so on average the diffuse bounce alone is
+    // left.
+    world.objects()[0].material.reflective = 0.;
+    world.objects()[0].material.transparency = 1.;
+    auto constexpr samples = 4000U;
+    auto sum = 0.;
+    for (auto sample{0U}; sample < samples; ++sample)
+        sum += trace_path(world, from_center, SampleRandom{0, 0, sample}, settings).r;
+    EXPECT_NEAR(sum / samples, albedo + albedo * albedo, .03);
+}
+
+TEST(PathTracerTest, RenderDoesNotDependOnTiles) { // NOLINT
+    auto const world = furnace();
+    Camera const camera{23, 17, pi / 2.};
+    PathTracing settings;
+    settings.samples_per_pixel = 2;
+
+    auto const canvas = render_path_traced(world, camera, settings);
+    settings.tile_size = 5;
+    EXPECT_EQ(render_path_traced(world, camera, settings).as_ppm(), canvas.as_ppm());
+    for (auto y{0U}; y < camera.vsize(); ++y) {
+        for (auto x{0U}; x < camera.hsize(); ++x) {
+            EXPECT_GT(canvas(x, y).r, geometric_sum(settings.min_depth + 1) - 1e-9);
+        }
+    }
+
+    settings.seed = 1;
+    EXPECT_NE(render_path_traced(world, camera, settings).as_ppm(), canvas.as_ppm());
+}
+
+TEST(PathTracerTest, InvalidSettingsThrow) { // NOLINT
+    World const world;
+    Camera const camera{4, 4, pi / 2.};
+    PathTracing settings;
+    settings.samples_per_pixel = 0;
+    EXPECT_THROW((void)render_path_traced(world, camera, settings), std::logic_error);
+    settings.samples_per_pixel = 1;
+    settings.tile_size = 0;
+    EXPECT_THROW((void)render_path_traced(world, camera, settings), std::logic_error);
+}
@@ -0,0 +1,69 @@
+#include <cherry_blazer/random.hh>
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <set>
+
+using cherry_blazer::SampleRandom;
+using cherry_blazer::detail::philox4x32;
+using cherry_blazer::detail::philox_counter;
+
+// Known answers from the reference implementation (Random123).
+TEST(RandomTest, PhiloxKnownAnswers) { // NOLINT
+    EXPECT_EQ(philox4x32({0, 0, 0, 0}, {0, 0}),
+              (philox_counter{0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8}));
+    EXPECT_EQ(philox4x32({0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff},
+                         {0xffffffff, 0xffffffff}),
+              (philox_counter{0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd}));
+    EXPECT_EQ(philox4x32({0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344},
+                         {0xa4093822, 0x299f31d0}),
+              (philox_counter{0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1}));
+}
+
+TEST(RandomTest, PhiloxIsConstexpr) { // NOLINT
+    static_assert(philox4x32({0, 0, 0, 0}, {0, 0})[0] == 0x6627e8d5);
+}
+
+TEST(RandomTest, SameIndicesGiveSameNumbers) { // NOLINT
+    SampleRandom const a{3, 4, 5, 6, 7};
+    SampleRandom const b{3, 4, 5, 6, 7};
+
+    for (auto i{0U}; i < 16; ++i)
+        EXPECT_EQ(a.uniform(i), b.uniform(i));
+}
+
+TEST(RandomTest, UniformMatchesUniform4) { // NOLINT
+    SampleRandom const random{1, 2, 3};
+
+    auto const block = random.uniform4(2);
+
+    for (auto i{0U}; i < 4; ++i)
+        EXPECT_EQ(random.uniform(8 + i), block[i]);
+}
+
+TEST(RandomTest, NeighbouringIndicesGiveDifferentNumbers) { // NOLINT
+    std::set<double> numbers;
+
+    for (auto x{0U}; x < 4; ++x)
+        for (auto sample{0U}; sample < 4; ++sample)
+            for (auto frame{0U}; frame < 4; ++frame)
+                for (std::uint32_t seed{0}; seed < 4; ++seed)
+                    numbers.insert(SampleRandom{x, 0, sample, frame, seed}.uniform(0));
+
+    EXPECT_EQ(numbers.size(), 4U * 4U * 4U * 4U);
+}
+
+TEST(RandomTest, UniformIsInUnitInterval) { // NOLINT
+    SampleRandom const random{0, 0, 0};
+    auto sum = 0.;
+
+    for (auto i{0U}; i < 4096; ++i) {
+        auto const u = random.uniform(i);
+        ASSERT_GE(u, 0.);
+        ASSERT_LT(u, 1.);
+        sum += u;
+    }
+
+    EXPECT_NEAR(sum / 4096., .5, .02);
+}
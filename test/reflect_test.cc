@@ -4,9 +4,11 @@
 
 #include <gtest/gtest.h>
 
+#include <cmath>
 #include <numbers>
 
 using cherry_blazer::Coord;
+using cherry_blazer::refract;
 using cherry_blazer::Vector;
 
 using namespace std::numbers;
@@ -36,3 +38,42 @@ TEST(ReflectTest, ReflectVectorOffSurfaceSlantedAt45Deg) {
     EXPECT_DOUBLE_EQ(result[Coord::Z], expected[Coord::Z]);
     EXPECT_DOUBLE_EQ(result[Coord::W], expected[Coord::W]);
 }
+
+TEST(ReflectTest, RefractStraightThroughAtPerpendicularIncidence) {
+    Vector eye{0., 1., 0.};
+    Vector normal{0., 1., 0.};
+
+    // from vacuum into glass
+    auto result = refract(eye, normal, 1. / 1.5);
+
+    ASSERT_TRUE(result.direction.has_value());
+    EXPECT_DOUBLE_EQ((*result.direction)[Coord::X], 0.);
+    EXPECT_DOUBLE_EQ((*result.direction)[Coord::Y], -1.);
+    EXPECT_DOUBLE_EQ((*result.direction)[Coord::Z], 0.);
+    EXPECT_NEAR(result.reflectance, .04, 1e-12);
+}
+
+TEST(ReflectTest, RefractBendsByTheRatioOfIndices) {
+    Vector eye{-sqrt2_v<double> / 2., sqrt2_v<double> / 2., 0.};
+    Vector normal{0., 1., 0.};
+
+    auto result = refract(eye, normal, 1. / 1.5);
+
+    // sin(out) = sin(in) / 1.5
+    ASSERT_TRUE(result.direction.has_value());
+    EXPECT_NEAR((*result.direction)[Coord::X], sqrt2_v<double> / 3., 1e-15);
+    EXPECT_NEAR((*result.direction)[Coord::Y], -std::sqrt(7.) / 3., 1e-15);
+    EXPECT_GT(result.reflectance, .04);
+    EXPECT_LT(result.reflectance, 1.);
+}
+
+TEST(ReflectTest, RefractUnderTotalInternalReflection) {
+    Vector eye{-sqrt2_v<double> / 2., sqrt2_v<double> / 2., 0.};
+    Vector normal{0., 1., 0.};
+
+    // from glass into vacuum, past the critical angle
+    auto result = refract(eye, normal, 1.5);
+
+    EXPECT_FALSE(result.direction.has_value());
+    EXPECT_DOUBLE_EQ(result.reflectance, 1.);
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cherry_blazer/camera.hh>
+#include <cherry_blazer/ray.hh>
+#include <cherry_blazer/render.hh>
+#include <cherry_blazer/square_matrix.hh>
+#include <cherry_blazer/transformation.hh>
+#include <cherry_blazer/vector.hh>
+#include <cherry_blazer/world.hh>
+
+#include <gtest/gtest.h>
+
+// Helpers shared by the tests of the primitives.
+namespace cherry_blazer::test {
+
+inline Transformation translation(double x, double y, double z) {
+    return {Mat4d::translation(Vector{x, y, z}), Transformation::Kind::Translation};
+}
+
+// Expects render() and render_rasterized() to give every pixel the color of its camera ray.
+inline void expect_renderers_agree(World const& world, Camera const& camera) {
+    auto const canvas = render(world, camera);
+    auto const rasterized = render_rasterized(world, camera);
+
+    for (auto y{0U}; y < camera.vsize(); ++y) {
+        for (auto x{0U}; x < camera.hsize(); ++x) {
+            auto const expected = world.color_at(camera.ray_for_pixel(x, y));
+            EXPECT_EQ(canvas(x, y), expected);
+            EXPECT_EQ(rasterized(x, y), expected);
+        }
+    }
+}
+
+// Number of pixels whose camera ray hits something for which seen(ray, hit) is true.
+template <typename Seen> int count_pixels(World const& world, Camera const& camera, Seen seen) {
+    auto count = 0;
+    for (auto y{0U}; y < camera.vsize(); ++y) {
+        for (auto x{0U}; x < camera.hsize(); ++x) {
+            auto const ray = camera.ray_for_pixel(x, y);
+            if (auto const hit = world.closest_hit(ray); hit && seen(ray, *hit))
+                ++count;
+        }
+    }
+    return count;
+}
+
+} // namespace cherry_blazer::test
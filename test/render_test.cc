@@ -0,0 +1,205 @@
+#include <cherry_blazer/camera.hh>
+#include <cherry_blazer/color.hh>
+#include <cherry_blazer/point.hh>
+#include <cherry_blazer/point_light.hh>
+#include <cherry_blazer/render.hh>
+#include <cherry_blazer/sphere.hh>
+#include <cherry_blazer/square_matrix.hh>
+#include <cherry_blazer/transformation.hh>
+#include <cherry_blazer/vector.hh>
+#include <cherry_blazer/world.hh>
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <numbers>
+#include <stdexcept>
+
+using cherry_blazer::Camera;
+using cherry_blazer::Color;
+using cherry_blazer::Mat4d;
+using cherry_blazer::Point;
+using cherry_blazer::ProgressiveRender;
+using cherry_blazer::Sphere;
+using cherry_blazer::Transformation;
+using cherry_blazer::Vector;
+using cherry_blazer::World;
+
+using namespace std::numbers;
+
+class RenderTest : public ::testing::Test {
+  protected:
+    World world{{Sphere{}, Sphere{{Mat4d::translation(Vector{1.5, .5, 1.}),
+                                   Transformation::Kind::Translation}}},
+                {{Point{-10., 10., -10.}, Color{1., 1., 1.}}}};
+    // Odd size, so that the blocks do not tile the image.
+    Camera camera{37, 29, pi / 3.,
+                  view_transform(Point{0., 0., -5.}, Point{0., 0., 0.}, Vector{0., 1., 0.})};
+};
+
+TEST_F(RenderTest, AllPassesShadeEveryPixel) {
+    ProgressiveRender render{world, camera};
+    ASSERT_EQ(render.passes(), 4U);
+
+    while (render.render_pass()) {
+    }
+
+    ASSERT_TRUE(render.done());
+    EXPECT_EQ(render.passes_done(), 4U);
+    for (auto y{0U}; y < camera.vsize(); ++y)
+        for (auto x{0U}; x < camera.hsize(); ++x)
+            EXPECT_EQ(render.canvas()(x, y), world.color_at(camera.ray_for_pixel(x, y)));
+}
+
+TEST_F(RenderTest, FirstPassFillsBlocks) {
+    ProgressiveRender render{world, camera, cherry_blazer::SpecularQuality::Exact, 4};
+
+    EXPECT_TRUE(render.render_pass());
+
+    auto const& canvas = render.canvas();
+    for (auto y{0U}; y < camera.vsize(); ++y)
+        for (auto x{0U}; x < camera.hsize(); ++x)
+            EXPECT_EQ(canvas(x, y), canvas(x / 4 * 4, y / 4 * 4));
+}
+
+TEST_F(RenderTest, CancelledPassResumes) {
+    ProgressiveRender reference{world, camera};
+    while (reference.render_pass()) {
+    }
+
+    ProgressiveRender render{world, camera};
+    std::atomic<bool> cancel{true};
+    EXPECT_FALSE(render.render_pass(cancel));
+    EXPECT_EQ(render.passes_done(), 0U);
+
+    cancel = false;
+    while (render.render_pass(cancel)) {
+    }
+
+    EXPECT_TRUE(render.done());
+    EXPECT_EQ(render.canvas(), reference.canvas());
+}
+
+TEST_F(RenderTest, BlockSizeMustBePowerOfTwo) {
+    EXPECT_THROW((ProgressiveRender{world, camera, cherry_blazer::SpecularQuality::Exact, 6}),
+                 std::logic_error);
+    EXPECT_THROW((ProgressiveRender{world, camera, cherry_blazer::SpecularQuality::Exact, 0}),
+                 std::logic_error);
+}
+
+TEST_F(RenderTest, BlockSizeOneIsSinglePass) {
+    ProgressiveRender render{world, camera, cherry_blazer::SpecularQuality::Exact, 1};
+
+    EXPECT_EQ(render.passes(), 1U);
+    EXPECT_TRUE(render.render_pass());
+    EXPECT_TRUE(render.done());
+    EXPECT_FALSE(render.render_pass());
+}
+
+TEST_F(RenderTest, PassPixelsAddUpToImage) {
+    ProgressiveRender render{world, camera};
+
+    auto total = std::size_t{};
+    for (auto pass{0U}; pass < render.passes(); ++pass)
+        total += render.pass_pixels(pass);
+
+    EXPECT_EQ(total, std::size_t{camera.hsize()} * camera.vsize());
+    EXPECT_EQ(render.pass_pixels(0), 5U * 4U);
+}
+
+TEST_F(RenderTest, RenderWithinAmpleBudgetIsComplete) {
+    auto const [canvas, report] = render(world, camera, std::chrono::hours{1});
+
+    EXPECT_TRUE(report.complete);
+    EXPECT_TRUE(report.deadline_met);
+    EXPECT_EQ(report.block_size, 1U);
+    EXPECT_EQ(report.quality, cherry_blazer::SpecularQuality::Exact);
+    for (auto y{0U}; y < camera.vsize(); ++y)
+        for (auto x{0U}; x < camera.hsize(); ++x)
+            EXPECT_EQ(canvas(x, y), world.color_at(camera.ray_for_pixel(x, y)));
+}
+
+TEST_F(RenderTest, RenderPastDeadlineStillHasFirstPass) {
+    auto const [canvas, report] =
+        render(world, camera, std::chrono::steady_clock::now() - std::chrono::seconds{1});
+
+    EXPECT_FALSE(report.complete);
+    EXPECT_FALSE(report.deadline_met);
+    EXPECT_EQ(report.block_size, 8U);
+    EXPECT_EQ(canvas(20, 12), world.color_at(camera.ray_for_pixel(16, 8)));
+}
+
+TEST_F(RenderTest, AntialiasingOnlyRefinesEdges) {
+    auto const [canvas, supersampled_pixels] = render_antialiased(world, camera);
+
+    EXPECT_GT(supersampled_pixels, 0U);
+    EXPECT_LT(supersampled_pixels, std::size_t{camera.hsize()} * camera.vsize() / 2);
+    // far from the spheres: untouched background
+    EXPECT_EQ(canvas(0, 0), (Color{0., 0., 0.}));
+    // inside the first sphere: a single sample
+    EXPECT_EQ(canvas(14, 14), world.color_at(camera.ray_for_pixel(14, 14)));
+}
+
+TEST_F(RenderTest, AntialiasingWithSingleSampleMatchesPlainRender) {
+    auto const [canvas, supersampled_pixels] = render_antialiased(world, camera, {1, .1});
+
+    EXPECT_GT(supersampled_pixels, 0U);
+    for (auto y{0U}; y < camera.vsize(); ++y)
+        for (auto x{0U}; x < camera.hsize(); ++x)
+            EXPECT_EQ(canvas(x, y), world.color_at(camera.ray_for_pixel(x, y)));
+}
+
+TEST_F(RenderTest, AntialiasingOfEmptyWorldTakesNoExtraSamples) {
+    World const empty;
+
+    auto const [canvas, supersampled_pixels] = render_antialiased(empty, camera);
+
+    EXPECT_EQ(supersampled_pixels, 0U);
+}
+
+TEST_F(RenderTest, AntialiasingNeedsSamples) {
+    EXPECT_THROW((void)render_antialiased(world, camera, {0, .1}), std::logic_error);
+}
+
+TEST_F(RenderTest, JitteredAntialiasingIsReproducible) {
+    cherry_blazer::Supersampling const jittered{4, .1, true, 42};
+
+    auto const first = render_antialiased(world, camera, jittered);
+    auto const second = render_antialiased(world, camera, jittered);
+    auto const regular = render_antialiased(world, camera);
+
+    EXPECT_EQ(first.canvas, second.canvas);
+    EXPECT_EQ(first.supersampled_pixels, regular.supersampled_pixels);
+    EXPECT_NE(first.canvas, regular.canvas);
+}
+
+TEST_F(RenderTest, RenderTileOnlyTouchesTile) {
+    cherry_blazer::Canvas canvas{camera.hsize(), camera.vsize()};
+    cherry_blazer::Tile const tile{10, 5, 12, 9};
+
+    render_tile(world, camera, tile, canvas);
+
+    ASSERT_EQ(canvas.dirty().size(), 1U);
+    EXPECT_EQ(canvas.dirty()[0].x, tile.x);
+    EXPECT_EQ(canvas.dirty()[0].width, tile.width);
+    EXPECT_EQ(canvas.dirty()[0].height, tile.height);
+    // The tile's rays are built incrementally, so they differ from single pixel rays by rounding.
+    for (auto y{tile.y}; y < tile.y + tile.height; ++y) {
+        for (auto x{tile.x}; x < tile.x + tile.width; ++x) {
+            auto const expected = world.color_at(camera.ray_for_pixel(x, y));
+            EXPECT_NEAR(canvas(x, y).r, expected.r, 1e-9);
+            EXPECT_NEAR(canvas(x, y).g, expected.g, 1e-9);
+            EXPECT_NEAR(canvas(x, y).b, expected.b, 1e-9);
+        }
+    }
+}
+
+TEST_F(RenderTest, RenderWithFootprintsMatchesFullTrace) {
+    auto const canvas = render(world, camera);
+
+    for (auto y{0U}; y < camera.vsize(); ++y)
+        for (auto x{0U}; x < camera.hsize(); ++x)
+            EXPECT_EQ(canvas(x, y), world.color_at(camera.ray_for_pixel(x, y)));
+}
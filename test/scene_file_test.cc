@@ -0,0 +1,263 @@
+#include <cherry_blazer/bvh.hh>
+#include <cherry_blazer/color.hh>
+#include <cherry_blazer/group.hh>
+#include <cherry_blazer/matrix_operations.hh>
+#include <cherry_blazer/point.hh>
+#include <cherry_blazer/point_light.hh>
+#include <cherry_blazer/ray.hh>
+#include <cherry_blazer/scene_file.hh>
+#include <cherry_blazer/sphere.hh>
+#include <cherry_blazer/square_matrix.hh>
+#include <cherry_blazer/transformation.hh>
+#include <cherry_blazer/vector.hh>
+#include <cherry_blazer/world.hh>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <vector>
+
+using cherry_blazer::Color;
+using cherry_blazer::detail::BvhNode;
+using cherry_blazer::Group;
+using cherry_blazer::Instance;
+using cherry_blazer::Mat4d;
+using cherry_blazer::Point;
+using cherry_blazer::PointLight;
+using cherry_blazer::Ray;
+using cherry_blazer::save_scene;
+using cherry_blazer::SceneFile;
+using cherry_blazer::Sphere;
+using cherry_blazer::Transformation;
+using cherry_blazer::Vector;
+using cherry_blazer::World;
+
+namespace {
+
+// A row of spheres of different materials, lit by two lights.
+World sample_world() {
+    std::vector<Sphere> objects;
+    for (int i = 0; i < 50; ++i) {
+        auto const x = static_cast<double>(i);
+        Sphere sphere{{Mat4d::translation(Vector{2. * x, 0., 0.}) *
+                           Mat4d::scaling(Vector{.5, 1., .5}),
+                       Transformation::Kind::Scaling}};
+        sphere.material.color = Color{x / 50., .5, 1.};
+        sphere.material.shininess = 10. + x;
+        objects.push_back(sphere);
+    }
+    return World{std::move(objects),
+                 {{Point{-10., 10., -10.}, Color{1., 1., 1.}},
+                  {Point{50., 10., -10.}, Color{.5, .5, .5}, 100.}}};
+}
+
+class SceneFileTest : public testing::Test {
+  protected:
+    // One file per test, since ctest may run the tests in parallel processes.
+    std::filesystem::path path{
+        std::filesystem::temp_directory_path() /
+        (std::string{"scene_file_test_"} +
+         testing::UnitTest::GetInstance()->current_test_info()->name() + ".cbscene")};
+
+    void TearDown() override { std::filesystem::remove(path); }
+
+    // Overwrites the value at offset of the file.
+    void patch(std::uint64_t offset, std::uint32_t value) const {
+        std::fstream file{path, std::ios::binary | std::ios::in | std::ios::out};
+        file.seekp(static_cast<std::streamoff>(offset));
+        file.write(reinterpret_cast<char const*>(&value), sizeof(value)); // NOLINT
+    }
+
+    // Offset of the first or count field of the node at index.
+    [[nodiscard]] std::uint64_t node_offset(std::size_t index, std::size_t field) const {
+        return SceneFile{path}.header().nodes_offset + index * sizeof(BvhNode) + field;
+    }
+    // Saves a world whose Bvh is then rewritten into a chain of inner nodes, levels deep, each
+    // with a leaf as its left child. Valid otherwise.
+    void save_chain(std::size_t levels) const {
+        std::vector<Sphere> objects;
+        for (int i = 0; i < 1000; ++i) {
+            objects.push_back(Sphere{{Mat4d::translation(Vector{3. * i, 0., 0.}),
+                                      Transformation::Kind::Translation}});
+        }
+        World const world{std::move(objects), {}};
+        ASSERT_GT(world.bvh().node_count(), 2 * levels);
+        save_scene(world, path);
+
+        auto const nodes_offset = SceneFile{path}.header().nodes_offset;
+        auto const set = [&](std::size_t node, std::uint32_t first, std::uint32_t count) {
+            auto const offset = nodes_offset + node * sizeof(BvhNode);
+            patch(offset + offsetof(BvhNode, first), first);
+            patch(offset + offsetof(BvhNode, count), count);
+        };
+        for (std::size_t level = 0; level < levels; ++level) {
+            set(2 * level, static_cast<std::uint32_t>(2 * level + 1), 0);
+            set(2 * level + 1, 0, 1);
+        }
+        set(2 * levels, 0, 1);
+    }
+};
+
+} // namespace
+
+TEST_F(SceneFileTest, LoadedWorldEqualsSavedWorld) { // NOLINT
+    auto const saved = sample_world();
+    save_scene(saved, path);
+
+    SceneFile file{path};
+    auto const loaded = file.world();
+
+    ASSERT_EQ(loaded.objects().size(), saved.objects().size());
+    for (std::size_t i = 0; i < saved.objects().size(); ++i) {
+        EXPECT_EQ(loaded.objects()[i], saved.objects()[i]); // same id
+        EXPECT_EQ(loaded.objects()[i].transformation.mat, saved.objects()[i].transformation.mat);
+        EXPECT_EQ(loaded.objects()[i].transformation.inv, saved.objects()[i].transformation.inv);
+        EXPECT_EQ(loaded.objects()[i].material, saved.objects()[i].material);
+    }
+    ASSERT_EQ(loaded.lights().size(), 2);
+    EXPECT_EQ(loaded.lights()[1].intensity, saved.lights()[1].intensity);
+    EXPECT_EQ(loaded.lights()[1].radius, 100.);
+    EXPECT_EQ(loaded.bvh().node_count(), saved.bvh().node_count());
+
+    for (int i = 0; i < 100; ++i) {
+        Ray const ray{Point{static_cast<double>(i), .3, -5.}, Vector{0., 0., 1.}};
+        EXPECT_EQ(loaded.color_at(ray), saved.color_at(ray));
+    }
+}
+
+TEST_F(SceneFileTest, LoadedWorldRefersToTheFile) { // NOLINT
+    save_scene(sample_world(), path);
+
+    SceneFile file{path};
+    auto const world = file.world();
+
+    EXPECT_EQ(world.objects().data(), file.objects().data());
+    EXPECT_EQ(world.lights().data(), file.lights().data());
+}
+
+TEST_F(SceneFileTest, ChangesDontReachTheFile) { // NOLINT
+    save_scene(sample_world(), path);
+    {
+        SceneFile file{path};
+        auto world = file.world();
+        world.objects()[0].material.color = Color{0., 0., 0.};
+    }
+
+    SceneFile file{path};
+
+    EXPECT_EQ(file.objects()[0].material.color, (Color{0., .5, 1.}));
+}
+
+TEST_F(SceneFileTest, EmptyWorld) { // NOLINT
+    save_scene(World{}, path);
+
+    SceneFile file{path};
+
+    EXPECT_TRUE(file.objects().empty());
+    EXPECT_TRUE(file.lights().empty());
+    EXPECT_FALSE(file.world().closest_hit(Ray{Point{0., 0., -5.}, Vector{0., 0., 1.}}));
+}
+
+TEST_F(SceneFileTest, MissingFileThrows) { // NOLINT
+    EXPECT_THROW(SceneFile{path}, std::system_error);
+}
+
+TEST_F(SceneFileTest, OtherFilesThrow) { // NOLINT
+    std::ofstream{path} << "P3\n1 1\n255\n0 0 0\n";
+
+    EXPECT_THROW(SceneFile{path}, std::logic_error);
+}
+
+TEST_F(SceneFileTest, TruncatedFileThrows) { // NOLINT
+    save_scene(sample_world(), path);
+    std::filesystem::resize_file(path, std::filesystem::file_size(path) - 1);
+
+    EXPECT_THROW(SceneFile{path}, std::logic_error);
+}
+
+TEST_F(SceneFileTest, ChildOutOfRangeThrows) { // NOLINT
+    auto const world = sample_world();
+    save_scene(world, path);
+    ASSERT_EQ(world.bvh().nodes()[0].count, 0U);
+
+    patch(node_offset(0, offsetof(BvhNode, first)),
+          static_cast<std::uint32_t>(world.bvh().node_count()) - 1);
+
+    EXPECT_THROW(SceneFile{path}, std::logic_error);
+}
+
+TEST_F(SceneFileTest, ChildBeforeParentThrows) { // NOLINT
+    save_scene(sample_world(), path);
+
+    patch(node_offset(0, offsetof(BvhNode, first)), 0);
+
+    EXPECT_THROW(SceneFile{path}, std::logic_error);
+}
+
+TEST_F(SceneFileTest, LeafOutOfRangeThrows) { // NOLINT
+    auto const world = sample_world();
+    save_scene(world, path);
+    auto const nodes = world.bvh().nodes();
+    auto const leaf = static_cast<std::size_t>(
+        std::find_if(nodes.begin(), nodes.end(), [](BvhNode const& node) { return node.count; }) -
+        nodes.begin());
+    ASSERT_LT(leaf, nodes.size());
+
+    patch(node_offset(leaf, offsetof(BvhNode, count)),
+          static_cast<std::uint32_t>(world.objects().size() - nodes[leaf].first + 1));
+
+    EXPECT_THROW(SceneFile{path}, std::logic_error);
+}
+
+TEST_F(SceneFileTest, ObjectOrderOutOfRangeThrows) { // NOLINT
+    auto const world = sample_world();
+    save_scene(world, path);
+
+    patch(SceneFile{path}.header().object_order_offset,
+          static_cast<std::uint32_t>(world.objects().size()));
+
+    EXPECT_THROW(SceneFile{path}, std::logic_error);
+}
+
+TEST_F(SceneFileTest, BvhAsDeepAsTraversalAllows) { // NOLINT
+    save_chain(cherry_blazer::Bvh::max_depth);
+
+    SceneFile file{path};
+
+    auto const hit = file.world().closest_hit(Ray{Point{0., 0., -5.}, Vector{0., 0., 1.}});
+    EXPECT_TRUE(hit.has_value());
+}
+
+TEST_F(SceneFileTest, BvhTooDeepForTraversalThrows) { // NOLINT
+    save_chain(cherry_blazer::Bvh::max_depth + 1);
+
+    EXPECT_THROW(SceneFile{path}, std::logic_error);
+}
+
+TEST_F(SceneFileTest, SharedSubtreesThrow) { // NOLINT
+    save_chain(30);
+    // Node i refers to node i + 1 as its left child, which is then also the right child of i - 1.
+    auto const nodes_offset = SceneFile{path}.header().nodes_offset;
+    for (std::uint32_t node = 0; node < 30; ++node) {
+        auto const offset = nodes_offset + node * sizeof(BvhNode);
+        patch(offset + offsetof(BvhNode, first), node + 1);
+        patch(offset + offsetof(BvhNode, count), 0);
+    }
+
+    EXPECT_THROW(SceneFile{path}, std::logic_error);
+}
+
+TEST_F(SceneFileTest, WorldWithInstancesThrows) { // NOLINT
+    auto const group = std::make_shared<Group const>(std::vector<Sphere>{Sphere{}});
+    World const world{{}, {}, {Instance{group, Transformation{}}}};
+
+    EXPECT_THROW(save_scene(world, path), std::logic_error);
+}
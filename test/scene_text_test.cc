@@ -0,0 +1,146 @@
+#include <cherry_blazer/axis.hh>
+#include <cherry_blazer/camera.hh>
+#include <cherry_blazer/color.hh>
+#include <cherry_blazer/matrix_operations.hh>
+#include <cherry_blazer/point.hh>
+#include <cherry_blazer/scene_text.hh>
+#include <cherry_blazer/shearing.hh>
+#include <cherry_blazer/square_matrix.hh>
+#include <cherry_blazer/transformation.hh>
+#include <cherry_blazer/vector.hh>
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <filesystem>
+#include <numbers>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+
+using cherry_blazer::Axis;
+using cherry_blazer::Color;
+using cherry_blazer::load_scene_text;
+using cherry_blazer::Mat4d;
+using cherry_blazer::Point;
+using cherry_blazer::ShearDirection;
+using cherry_blazer::Transformation;
+using cherry_blazer::Vector;
+using cherry_blazer::view_transform;
+
+namespace Shear = cherry_blazer::Shear;
+
+namespace {
+
+cherry_blazer::Scene load(std::string const& description) {
+    std::istringstream input{description};
+    return load_scene_text(input);
+}
+
+} // namespace
+
+TEST(SceneTextTest, EmptyDescription) { // NOLINT
+    auto const scene = load("# nothing here\n\n");
+
+    EXPECT_TRUE(scene.world.objects().empty());
+    EXPECT_TRUE(scene.world.lights().empty());
+    EXPECT_FALSE(scene.camera);
+}
+
+TEST(SceneTextTest, Spheres) { // NOLINT
+    auto const scene = load("sphere\n"
+                            "sphere translate 1 2 3 # moved\n"
+                            "    color .5 1 .1 ambient .2 diffuse .7 specular .3 shininess 50\n"
+                            "    reflective .4 transparency .6 refractive_index 1.5\n");
+
+    auto const objects = scene.world.objects();
+    ASSERT_EQ(objects.size(), 2);
+    EXPECT_EQ(objects[0].transformation.mat, Mat4d::identity());
+    EXPECT_EQ(objects[0].transformation.kind, Transformation::Kind::Identity);
+    EXPECT_EQ(objects[0].material, cherry_blazer::Material{});
+    EXPECT_EQ(objects[1].transformation.mat, Mat4d::translation(Vector{1., 2., 3.}));
+    EXPECT_EQ(objects[1].transformation.inv, Mat4d::translation(Vector{-1., -2., -3.}));
+    EXPECT_EQ(objects[1].transformation.kind, Transformation::Kind::Translation);
+    EXPECT_EQ(objects[1].material,
+              (cherry_blazer::Material{Color{.5, 1., .1}, .2, .7, .3, 50., .4, .6, 1.5}));
+}
+
+TEST(SceneTextTest, TransformationsApplyInWrittenOrder) { // NOLINT
+    auto const scene = load("sphere translate 0 0 5 scale 2 2 2 rotate y 1.5 shear xz");
+
+    auto const expected = Mat4d::shearing(ShearDirection{Shear::X::AgainstZ{}}) *
+                          Mat4d::rotation(Axis::Y, 1.5) * Mat4d::scaling(Vector{2., 2., 2.}) *
+                          Mat4d::translation(Vector{0., 0., 5.});
+    auto const& transformation = scene.world.objects()[0].transformation;
+    EXPECT_EQ(transformation.mat, expected);
+    EXPECT_EQ(transformation.inv, inverse(expected));
+    EXPECT_EQ(transformation.kind, Transformation::Kind::Shearing);
+}
+
+TEST(SceneTextTest, TranslationAfterScalingIsNoTranslation) { // NOLINT
+    auto const scene = load("sphere scale 2 2 2 translate 1 0 0");
+
+    EXPECT_EQ(scene.world.objects()[0].transformation.kind, Transformation::Kind::Scaling);
+}
+
+TEST(SceneTextTest, Lights) { // NOLINT
+    auto const scene = load("light -10 10 -10 1 1 1\nlight 0 5 0 .5 .5 .5 radius 20");
+
+    auto const lights = scene.world.lights();
+    ASSERT_EQ(lights.size(), 2);
+    EXPECT_EQ(lights[0].position, (Point{-10., 10., -10.}));
+    EXPECT_EQ(lights[0].intensity, (Color{1., 1., 1.}));
+    EXPECT_TRUE(std::isinf(lights[0].radius));
+    EXPECT_EQ(lights[1].radius, 20.);
+}
+
+TEST(SceneTextTest, Camera) { // NOLINT
+    auto const scene = load("camera 400 200 1.047\n  from 0 1.5 -5 to 0 1 0 up 0 1 0");
+
+    ASSERT_TRUE(scene.camera);
+    EXPECT_EQ(scene.camera->hsize(), 400);
+    EXPECT_EQ(scene.camera->vsize(), 200);
+    EXPECT_DOUBLE_EQ(scene.camera->field_of_view(), 1.047);
+    EXPECT_EQ(scene.camera->transform(), view_transform(Point{0., 1.5, -5.}, Point{0., 1., 0.},
+                                                        Vector{0., 1., 0.}));
+}
+
+TEST(SceneTextTest, LoadedWorldIsTraceable) { // NOLINT
+    auto const scene = load("light -10 10 -10 1 1 1\n"
+                            "sphere color .8 1 .6 diffuse .7 specular .2\n"
+                            "sphere scale .5 .5 .5\n");
+
+    auto const color = scene.world.color_at({Point{0., 0., -5.}, Vector{0., 0., 1.}});
+
+    // Same world and ray as WorldTest.ColorWhenRayHits.
+    EXPECT_NEAR(color.r, .38066, 1e-5);
+    EXPECT_NEAR(color.g, .47583, 1e-5);
+    EXPECT_NEAR(color.b, .2855, 1e-5);
+}
+
+TEST(SceneTextTest, MalformedDescriptionsThrow) { // NOLINT
+    EXPECT_THROW(load("cube"), std::logic_error);
+    EXPECT_THROW(load("color 1 1 1"), std::logic_error);
+    EXPECT_THROW(load("sphere translate 1 2"), std::logic_error);
+    EXPECT_THROW(load("sphere translate 1 two 3"), std::logic_error);
+    EXPECT_THROW(load("sphere rotate w 1"), std::logic_error);
+    EXPECT_THROW(load("sphere shear xx"), std::logic_error);
+    EXPECT_THROW(load("sphere scale 1 0 1"), std::logic_error);
+    EXPECT_THROW(load("camera 100 -100 1 from 0 0 0 to 0 0 1 up 0 1 0"), std::logic_error);
+    EXPECT_THROW(load("camera 100 100 1 0 0 0 to 0 0 1 up 0 1 0"), std::logic_error);
+}
+
+TEST(SceneTextTest, ErrorsNameTheLine) { // NOLINT
+    try {
+        static_cast<void>(load("sphere\n\nsphere scale 1 1\n"));
+        FAIL();
+    } catch (std::logic_error const& e) {
+        EXPECT_EQ(std::string{e.what()}, "line 3: unexpected end of the description");
+    }
+}
+
+TEST(SceneTextTest, MissingFileThrows) { // NOLINT
+    EXPECT_THROW(static_cast<void>(load_scene_text(std::filesystem::path{"/nonexistent/scene"})),
+                 std::system_error);
+}
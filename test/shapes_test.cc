@@ -0,0 +1,236 @@
+#include <cherry_blazer/bvh.hh>
+#include <cherry_blazer/camera.hh>
+#include <cherry_blazer/color.hh>
+#include <cherry_blazer/matrix.hh>
+#include <cherry_blazer/point.hh>
+#include <cherry_blazer/point_light.hh>
+#include <cherry_blazer/random.hh>
+#include <cherry_blazer/ray.hh>
+#include <cherry_blazer/shapes.hh>
+#include <cherry_blazer/sphere.hh>
+#include <cherry_blazer/transformation.hh>
+#include <cherry_blazer/vector.hh>
+#include <cherry_blazer/world.hh>
+
+#include "render_helpers.hh"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <numbers>
+#include <optional>
+#include <vector>
+
+using cherry_blazer::Camera;
+using cherry_blazer::Color;
+using cherry_blazer::Cone;
+using cherry_blazer::Cube;
+using cherry_blazer::Cylinder;
+using cherry_blazer::Plane;
+using cherry_blazer::Point;
+using cherry_blazer::Primitive;
+using cherry_blazer::Ray;
+using cherry_blazer::SampleRandom;
+using cherry_blazer::Shapes;
+using cherry_blazer::Sphere;
+using cherry_blazer::Vector;
+using cherry_blazer::World;
+using cherry_blazer::test::count_pixels;
+using cherry_blazer::test::expect_renderers_agree;
+using cherry_blazer::test::translation;
+
+using namespace std::numbers;
+
+namespace {
+
+void expect_crossings(cherry_blazer::Crossings const& actual, std::vector<double> const& expected) {
+    ASSERT_EQ(actual.size(), expected.size());
+    for (std::size_t i = 0; i < expected.size(); ++i)
+        EXPECT_NEAR(actual[i], expected[i], 1e-9);
+}
+
+} // namespace
+
+TEST(ShapesTest, RayCrossesPlaneOnce) { // NOLINT
+    Plane const plane{};
+
+    expect_crossings(crossings(plane, Ray{Point{0., 1., 0.}, Vector{0., -1., 0.}}), {1.});
+    expect_crossings(crossings(plane, Ray{Point{0., -1., 0.}, Vector{0., 1., 0.}}), {1.});
+    // parallel, and within the plane
+    expect_crossings(crossings(plane, Ray{Point{0., 10., 0.}, Vector{0., 0., 1.}}), {});
+    expect_crossings(crossings(plane, Ray{Point{0., 0., 0.}, Vector{0., 0., 1.}}), {});
+
+    auto const normal = cherry_blazer::normal(plane, Point{10., 0., -10.});
+    EXPECT_EQ(normal[1], 1.);
+}
+
+TEST(ShapesTest, RayCrossesCubeFaces) { // NOLINT
+    Cube const cube{};
+
+    expect_crossings(crossings(cube, Ray{Point{5., .5, 0.}, Vector{-1., 0., 0.}}), {4., 6.});
+    expect_crossings(crossings(cube, Ray{Point{.5, 0., -5.}, Vector{0., 0., 1.}}), {4., 6.});
+    expect_crossings(crossings(cube, Ray{Point{0., .5, 0.}, Vector{0., 0., 1.}}), {-1., 1.});
+    expect_crossings(crossings(cube, Ray{Point{-2., 0., 0.}, Vector{.2673, .5345, .8018}}), {});
+    expect_crossings(crossings(cube, Ray{Point{2., 2., 0.}, Vector{-1., 0., 0.}}), {});
+
+    auto const normal = cherry_blazer::normal(cube, Point{.4, -1., -.1});
+    EXPECT_EQ(normal[0], 0.);
+    EXPECT_EQ(normal[1], -1.);
+    EXPECT_EQ(normal[2], 0.);
+}
+
+TEST(ShapesTest, RayCrossesCutCylinder) { // NOLINT
+    Cylinder cylinder{};
+
+    expect_crossings(crossings(cylinder, Ray{Point{1., 0., -5.}, Vector{0., 0., 1.}}), {5., 5.});
+    expect_crossings(crossings(cylinder, Ray{Point{0., 0., -5.}, Vector{0., 0., 1.}}), {4., 6.});
+    expect_crossings(crossings(cylinder, Ray{Point{0., 0., -5.}, Vector{1., 1., 1.}}), {});
+
+    cylinder.minimum = 1.;
+    cylinder.maximum = 2.;
+    expect_crossings(crossings(cylinder, Ray{Point{0., 1.5, -2.}, Vector{0., 0., 1.}}), {1., 3.});
+    expect_crossings(crossings(cylinder, Ray{Point{0., 3., -2.}, Vector{0., 0., 1.}}), {});
+    expect_crossings(crossings(cylinder, Ray{Point{0., 3., 0.}, Vector{0., -1., 0.}}), {});
+
+    // closed: a ray along the axis goes through both caps
+    cylinder.closed = true;
+    expect_crossings(crossings(cylinder, Ray{Point{0., 3., 0.}, Vector{0., -1., 0.}}), {1., 2.});
+    EXPECT_EQ(cherry_blazer::normal(cylinder, Point{.5, 2., 0.})[1], 1.);
+    EXPECT_EQ(cherry_blazer::normal(cylinder, Point{0., 1., .5})[1], -1.);
+    EXPECT_EQ(cherry_blazer::normal(cylinder, Point{-1., 1.5, 0.})[0], -1.);
+}
+
+TEST(ShapesTest, RayCrossesCone) { // NOLINT
+    Cone cone{};
+
+    expect_crossings(crossings(cone, Ray{Point{0., 0., -5.}, Vector{0., 0., 1.}}), {5., 5.});
+    expect_crossings(crossings(cone, Ray{Point{1., 1., -5.}, Vector{-.5, -1., 1.}}),
+                     {2. * (9. - std::sqrt(56.)), 2. * (9. + std::sqrt(56.))});
+    // parallel to one nappe, so crossing the other once
+    expect_crossings(crossings(cone, Ray{Point{0., 0., -1.}, Vector{0., 1., 1.}}), {.5});
+
+    cone.minimum = -.5;
+    cone.maximum = .5;
+    cone.closed = true;
+    expect_crossings(crossings(cone, Ray{Point{0., 0., -5.}, Vector{0., 1., 0.}}), {});
+    expect_crossings(crossings(cone, Ray{Point{0., 0., -.25}, Vector{0., 1., 1.}}), {.125, .5});
+    expect_crossings(crossings(cone, Ray{Point{0., 0., -.25}, Vector{0., 1., 0.}}),
+                     {-.5, -.25, .25, .5});
+
+    auto const side = cherry_blazer::normal(Cone{}, Point{1., 1., 1.});
+    EXPECT_NEAR(side[0], .5, 1e-12);
+    EXPECT_NEAR(side[1], -std::sqrt(2.) / 2., 1e-12);
+    EXPECT_NEAR(side[2], .5, 1e-12);
+}
+
+TEST(ShapesTest, TransformationPlacesShapes) { // NOLINT
+    Cube const cube{translation(5., 0., 0.), {}};
+
+    expect_crossings(crossings(cube, Ray{Point{0., 0., 0.}, Vector{1., 0., 0.}}), {4., 6.});
+    EXPECT_EQ(cherry_blazer::normal(cube, Point{4., 0., 0.})[0], -1.);
+}
+
+TEST(ShapesTest, BoundsAreInfiniteOnlyForUnboundedShapes) { // NOLINT
+    auto const plane = bounds(Plane{});
+    EXPECT_TRUE(std::isinf(plane.min[0]));
+    EXPECT_TRUE(std::isinf(bounds(Cylinder{}).max[1]));
+    EXPECT_TRUE(std::isinf(bounds(Cone{}).max[1]));
+
+    auto const cube = bounds(Cube{translation(5., 0., 0.), {}});
+    EXPECT_DOUBLE_EQ(cube.min[0], 4.);
+    EXPECT_DOUBLE_EQ(cube.max[0], 6.);
+
+    Cone cone{};
+    cone.minimum = -1.;
+    cone.maximum = 2.;
+    auto const box = bounds(cone);
+    EXPECT_DOUBLE_EQ(box.min[0], -2.);
+    EXPECT_DOUBLE_EQ(box.max[2], 2.);
+    EXPECT_DOUBLE_EQ(box.min[1], -1.);
+}
+
+TEST(ShapesTest, ClosestShapeHitMatchesTestingEveryShape) { // NOLINT
+    Shapes shapes;
+    shapes.planes.push_back({translation(0., -3., 0.), {}});
+    for (unsigned i = 0; i < 40; ++i) {
+        SampleRandom const random{i, 0, 0};
+        auto const place = translation(random.uniform(0) * 20. - 10., random.uniform(1) * 4. - 2.,
+                                       random.uniform(2) * 20. + 5.);
+        shapes.cubes.push_back({place, {}});
+        shapes.cylinders.push_back({place, {}, -.5, .5, i % 2 == 0});
+        shapes.cones.push_back({translation(place.mat(0, 3), place.mat(1, 3) + 1., 30.), {}, -1.,
+                                0., true});
+    }
+    World const world{{}, {}, {}, {}, shapes};
+
+    for (unsigned i = 0; i < 300; ++i) {
+        SampleRandom const random{i, 1, 0};
+        Ray const ray{Point{0., 0., -5.},
+                      Vector{random.uniform(0) - .5, random.uniform(1) - .5, 1.}};
+
+        std::optional<double> expected;
+        auto const test_all = [&](auto const& all) {
+            for (auto const& shape : all) {
+                for (auto const t : crossings(shape, ray)) {
+                    if (t >= 0.) {
+                        if (!expected || t < *expected)
+                            expected = t;
+                        break;
+                    }
+                }
+            }
+        };
+        test_all(shapes.planes);
+        test_all(shapes.cubes);
+        test_all(shapes.cylinders);
+        test_all(shapes.cones);
+
+        auto const hit = world.closest_hit(ray);
+        ASSERT_EQ(hit.has_value(), expected.has_value());
+        if (expected) {
+            EXPECT_EQ(hit->t, *expected);
+        }
+    }
+}
+
+TEST(ShapesTest, WorldShadesAndShadowsShapes) { // NOLINT
+    Shapes shapes;
+    shapes.planes.push_back({{}, {}});
+    shapes.planes[0].material.color = Color{.2, .4, .8};
+    shapes.cubes.push_back({translation(0., 3., 0.), {}});
+    World const world{{}, {{Point{0., 10., 0.}, Color{1., 1., 1.}}}, {}, {}, shapes};
+
+    Ray const ray{Point{5., 1., 0.}, Vector{0., -1., 0.}};
+    auto const hit = world.closest_hit(ray);
+    ASSERT_TRUE(hit.has_value());
+    EXPECT_EQ(hit->primitive, Primitive::Plane);
+    auto const surface = world.surface(ray, *hit);
+    EXPECT_EQ(surface.primitive, Primitive::Plane);
+    EXPECT_EQ(surface.normal_vector[1], 1.);
+    EXPECT_EQ(&world.material(surface), &world.planes()[0].material);
+
+    // under the cube, the plane is in its shadow
+    EXPECT_TRUE(world.occluded(Ray{Point{0., 0., 0.}, Vector{0., 10., 0.}}, 1.));
+    EXPECT_FALSE(world.occluded(Ray{Point{5., 0., 0.}, Point{0., 10., 0.} - Point{5., 0., 0.}},
+                                1.));
+}
+
+TEST(ShapesTest, RenderersAgreeOnShapes) { // NOLINT
+    Shapes shapes;
+    shapes.planes.push_back({translation(0., -1., 0.), {}});
+    shapes.cubes.push_back({translation(-3., 0., 2.), {}});
+    shapes.cylinders.push_back({translation(3., 0., 0.), {}, -1., 1., true});
+    shapes.cones.push_back({translation(0., 1., 4.), {}, -2., 0., false});
+    World const world{{Sphere{}}, {{Point{-10., 10., -10.}, Color{1., 1., 1.}}}, {}, {}, shapes};
+    Camera const camera{31, 27, pi / 2.,
+                        view_transform(Point{0., 2., -8.}, Point{0., 0., 0.}, Vector{0., 1., 0.})};
+
+    expect_renderers_agree(world, camera);
+    EXPECT_GT(count_pixels(world, camera,
+                           [](Ray const& /*ray*/, cherry_blazer::Hit const& hit) {
+                               return hit.primitive != Primitive::Sphere;
+                           }),
+              0);
+}
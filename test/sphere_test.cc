@@ -8,7 +8,11 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <cstddef>
 #include <memory>
+#include <thread>
+#include <vector>
 
 using cherry_blazer::Mat4d;
 using cherry_blazer::Material;
@@ -40,6 +44,31 @@ TEST(SphereTest, SphereIdEqualsNotEquals) { // NOLINT
     EXPECT_NE(s2, s3);
 }
 
+TEST(SphereTest, SphereIdsAreUniqueAcrossThreads) { // NOLINT
+    constexpr std::size_t thread_count = 4;
+    constexpr std::size_t spheres_per_thread = 3 * Sphere::id_block_size;
+
+    std::vector<std::vector<unsigned>> ids(thread_count);
+    std::vector<std::thread> threads;
+    for (auto& thread_ids : ids) {
+        threads.emplace_back([&thread_ids] {
+            for (std::size_t i = 0; i < spheres_per_thread; ++i)
+                thread_ids.push_back(Sphere{}.id());
+        });
+    }
+    for (auto& thread : threads)
+        thread.join();
+
+    std::vector<unsigned> all_ids;
+    for (auto const& thread_ids : ids)
+        all_ids.insert(all_ids.end(), thread_ids.begin(), thread_ids.end());
+    std::sort(all_ids.begin(), all_ids.end());
+
+    EXPECT_EQ(all_ids.size(), thread_count * spheres_per_thread);
+    EXPECT_NE(all_ids.front(), 0U);
+    EXPECT_EQ(std::adjacent_find(all_ids.begin(), all_ids.end()), all_ids.end());
+}
+
 TEST(SphereTest, RayIntersectsSphereAtTwoPoints) { // NOLINT
     Ray ray{Point{0., 0., -5.}, Vector{0., 0., 1.}};
 
@@ -0,0 +1,44 @@
+#include <cherry_blazer/matrix_operations.hh>
+#include <cherry_blazer/square_matrix.hh>
+#include <cherry_blazer/transformation.hh>
+#include <cherry_blazer/vector.hh>
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+using cherry_blazer::Mat4d;
+using cherry_blazer::Transformation;
+using cherry_blazer::Vector;
+
+TEST(TransformationTest, MakeTransformationsComputesEveryInverse) { // NOLINT
+    std::vector<Mat4d> mats;
+    for (std::size_t i = 0; i < 5000; ++i) {
+        auto const x = static_cast<double>(i);
+        mats.push_back(Mat4d::translation(Vector{x, -x, 1.}) *
+                       Mat4d::scaling(Vector{1. + x, 2., .5}));
+    }
+    std::vector<Transformation> transformations(mats.size());
+
+    make_transformations(mats, Transformation::Kind::Scaling, transformations);
+
+    for (std::size_t i = 0; i < mats.size(); ++i) {
+        EXPECT_EQ(transformations[i].mat, mats[i]);
+        EXPECT_EQ(transformations[i].inv, inverse(mats[i]));
+        EXPECT_EQ(transformations[i].inv_transpose, transpose(inverse(mats[i])));
+        EXPECT_EQ(transformations[i].kind, Transformation::Kind::Scaling);
+    }
+}
+
+TEST(TransformationTest, MakeTransformationsThrows) { // NOLINT
+    std::vector<Mat4d> mats{Mat4d::identity(), Mat4d::scaling(Vector{1., 0., 1.})};
+    std::vector<Transformation> transformations(mats.size());
+    std::vector<Transformation> too_few(1);
+
+    EXPECT_THROW(make_transformations(mats, Transformation::Kind::Scaling, transformations),
+                 std::logic_error);
+    EXPECT_THROW(make_transformations(mats, Transformation::Kind::Scaling, too_few),
+                 std::logic_error);
+}
@@ -0,0 +1,71 @@
+#include <cherry_blazer/camera.hh>
+#include <cherry_blazer/color.hh>
+#include <cherry_blazer/matrix_operations.hh>
+#include <cherry_blazer/point.hh>
+#include <cherry_blazer/render.hh>
+#include <cherry_blazer/sphere.hh>
+#include <cherry_blazer/square_matrix.hh>
+#include <cherry_blazer/transformation.hh>
+#include <cherry_blazer/vector.hh>
+#include <cherry_blazer/visibility_buffer.hh>
+#include <cherry_blazer/world.hh>
+
+#include <gtest/gtest.h>
+
+#include <numbers>
+#include <vector>
+
+using cherry_blazer::Camera;
+using cherry_blazer::Color;
+using cherry_blazer::Mat4d;
+using cherry_blazer::Point;
+using cherry_blazer::Sphere;
+using cherry_blazer::Transformation;
+using cherry_blazer::Vector;
+using cherry_blazer::VisibilityBuffer;
+using cherry_blazer::World;
+
+using namespace std::numbers;
+
+class VisibilityBufferTest : public ::testing::Test {
+  protected:
+    // Overlapping spheres, one behind the other, one squashed, one behind the eye.
+    World world{{Sphere{},
+                 Sphere{{Mat4d::translation(Vector{.8, .3, 2.}),
+                         Transformation::Kind::Translation}},
+                 Sphere{{Mat4d::translation(Vector{-1.5, -1., -.5}) *
+                             Mat4d::scaling(Vector{.3, .8, .3}),
+                         Transformation::Kind::Scaling}},
+                 Sphere{{Mat4d::translation(Vector{0., 0., -20.}),
+                         Transformation::Kind::Translation}}},
+                {{Point{-10., 10., -10.}, Color{1., 1., 1.}}}};
+    Camera camera{61, 47, pi / 3.,
+                  view_transform(Point{0., 0., -5.}, Point{0., 0., 0.}, Vector{0., 1., 0.})};
+};
+
+TEST_F(VisibilityBufferTest, MatchesClosestHit) {
+    VisibilityBuffer const buffer{world, camera};
+
+    auto background = 0;
+    for (auto y{0U}; y < camera.vsize(); ++y) {
+        for (auto x{0U}; x < camera.hsize(); ++x) {
+            auto const expected = world.closest_hit(camera.ray_for_pixel(x, y));
+            auto const actual = buffer.hit(x, y);
+            ASSERT_EQ(actual.has_value(), expected.has_value()) << "pixel " << x << ", " << y;
+            if (!expected) {
+                ++background;
+                continue;
+            }
+            EXPECT_EQ(actual->object, expected->object);
+            EXPECT_DOUBLE_EQ(actual->t, expected->t);
+        }
+    }
+    EXPECT_GT(background, 0);
+}
+
+TEST_F(VisibilityBufferTest, RasterizedRenderMatchesTracedRender) {
+    auto const rasterized = render_rasterized(world, camera);
+    auto const traced = render(world, camera);
+
+    EXPECT_EQ(rasterized, traced);
+}
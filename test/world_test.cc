@@ -0,0 +1,268 @@
+#include <cherry_blazer/color.hh>
+#include <cherry_blazer/point.hh>
+#include <cherry_blazer/point_light.hh>
+#include <cherry_blazer/ray.hh>
+#include <cherry_blazer/shapes.hh>
+#include <cherry_blazer/sphere.hh>
+#include <cherry_blazer/square_matrix.hh>
+#include <cherry_blazer/transformation.hh>
+#include <cherry_blazer/vector.hh>
+#include <cherry_blazer/world.hh>
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+using cherry_blazer::Color;
+using cherry_blazer::Mat4d;
+using cherry_blazer::Plane;
+using cherry_blazer::Point;
+using cherry_blazer::PointLight;
+using cherry_blazer::Ray;
+using cherry_blazer::Shapes;
+using cherry_blazer::Sphere;
+using cherry_blazer::TraceLimits;
+using cherry_blazer::Transformation;
+using cherry_blazer::Vector;
+using cherry_blazer::World;
+
+namespace {
+
+// Two concentric spheres, lit from the upper left front.
+std::vector<Sphere> default_objects() {
+    Sphere outer;
+    outer.material.color = Color{.8, 1., .6};
+    outer.material.diffuse = .7;
+    outer.material.specular = .2;
+    Sphere inner{{Mat4d::scaling(Vector{.5, .5, .5}), Transformation::Kind::Scaling}};
+    return {outer, inner};
+}
+
+World default_world() {
+    return World{default_objects(), {{Point{-10., 10., -10.}, Color{1., 1., 1.}}}};
+}
+
+// The default world with more objects and a floor at y = -1.
+World default_world_with_floor(cherry_blazer::Material const& floor_material,
+                               std::vector<Sphere> more_objects = {}) {
+    auto objects = default_objects();
+    objects.insert(objects.end(), more_objects.begin(), more_objects.end());
+    Shapes shapes;
+    shapes.planes.push_back({{Mat4d::translation(Vector{0., -1., 0.}),
+                              Transformation::Kind::Translation},
+                             floor_material});
+    return World{std::move(objects), {{Point{-10., 10., -10.}, Color{1., 1., 1.}}}, {}, {},
+                 std::move(shapes)};
+}
+
+// Looking down at the floor from above, at 45 degrees.
+Ray const ray_at_floor{Point{0., 0., -3.}, Vector{0., -std::sqrt(2.) / 2., std::sqrt(2.) / 2.}};
+
+// A red ball under the floor.
+Sphere ball_under_floor() {
+    Sphere ball{{Mat4d::translation(Vector{0., -3.5, -.5}), Transformation::Kind::Translation}};
+    ball.material.color = Color{1., 0., 0.};
+    ball.material.ambient = .5;
+    return ball;
+}
+
+} // namespace
+
+TEST(WorldTest, ClosestHitIsNearestObjectInFront) { // NOLINT
+    auto const world = default_world();
+    Ray const ray{Point{0., 0., -5.}, Vector{0., 0., 1.}};
+
+    auto const hit = world.closest_hit(ray);
+
+    ASSERT_TRUE(hit.has_value());
+    EXPECT_DOUBLE_EQ(hit->t, 4.);
+    EXPECT_EQ(hit->object, 0U);
+}
+
+TEST(WorldTest, ClosestHitFromInsideAnObject) { // NOLINT
+    auto const world = default_world();
+    Ray const ray{Point{0., 0., 0.}, Vector{0., 0., 1.}};
+
+    auto const hit = world.closest_hit(ray);
+
+    ASSERT_TRUE(hit.has_value());
+    EXPECT_DOUBLE_EQ(hit->t, .5);
+    EXPECT_EQ(hit->object, 1U);
+}
+
+TEST(WorldTest, ClosestHitWhenRayMisses) { // NOLINT
+    auto const world = default_world();
+    Ray const ray{Point{0., 0., -5.}, Vector{0., 1., 0.}};
+
+    EXPECT_FALSE(world.closest_hit(ray).has_value());
+}
+
+TEST(WorldTest, NotOccludedWhenNothingIsBetweenPointAndLight) { // NOLINT
+    auto const world = default_world();
+    auto const& light = world.lights()[0];
+    Point const point{0., 10., 0.};
+
+    EXPECT_FALSE(world.occluded(Ray{point, light.position - point}, 1.));
+}
+
+TEST(WorldTest, OccludedWhenObjectIsBetweenPointAndLight) { // NOLINT
+    auto const world = default_world();
+    auto const& light = world.lights()[0];
+    Point const point{10., -10., 10.};
+
+    EXPECT_TRUE(world.occluded(Ray{point, light.position - point}, 1.));
+}
+
+TEST(WorldTest, NotOccludedWhenObjectIsBehindLight) { // NOLINT
+    auto const world = default_world();
+    auto const& light = world.lights()[0];
+    Point const point{-20., 20., -20.};
+
+    EXPECT_FALSE(world.occluded(Ray{point, light.position - point}, 1.));
+}
+
+TEST(WorldTest, NotOccludedWhenObjectIsBehindPoint) { // NOLINT
+    auto const world = default_world();
+    auto const& light = world.lights()[0];
+    Point const point{-2., 2., -2.};
+
+    EXPECT_FALSE(world.occluded(Ray{point, light.position - point}, 1.));
+}
+
+TEST(WorldTest, ShadowsOfAllLights) { // NOLINT
+    World const world{{Sphere{}},
+                      {{Point{0., 0., -10.}, Color{1., 1., 1.}},
+                       {Point{0., 0., 10.}, Color{1., 1., 1.}},
+                       {Point{0., 10., 0.}, Color{1., 1., 1.}, 5.}}};
+    Point const point{0., 0., -2.};
+    Vector const normal{0., 1., 0.};
+    bool in_shadow[3] = {};
+
+    world.shadows(point, normal, in_shadow);
+
+    EXPECT_FALSE(in_shadow[0]); // clear line of sight
+    EXPECT_TRUE(in_shadow[1]);  // behind the sphere
+    EXPECT_TRUE(in_shadow[2]);  // out of reach
+}
+
+TEST(WorldTest, ShadowsNeedsOneFlagPerLight) { // NOLINT
+    auto const world = default_world();
+    bool in_shadow[2] = {};
+
+    EXPECT_THROW(world.shadows(Point{0., 0., 0.}, Vector{0., 1., 0.}, in_shadow),
+                 std::logic_error);
+}
+
+TEST(WorldTest, ColorWhenRayMisses) { // NOLINT
+    auto const world = default_world();
+    Ray const ray{Point{0., 0., -5.}, Vector{0., 1., 0.}};
+
+    EXPECT_EQ(world.color_at(ray), (Color{0., 0., 0.}));
+}
+
+TEST(WorldTest, ColorWhenRayHits) { // NOLINT
+    auto const world = default_world();
+    Ray const ray{Point{0., 0., -5.}, Vector{0., 0., 1.}};
+
+    auto const color = world.color_at(ray);
+
+    EXPECT_NEAR(color.r, .38066, 1e-5);
+    EXPECT_NEAR(color.g, .47583, 1e-5);
+    EXPECT_NEAR(color.b, .2855, 1e-5);
+}
+
+TEST(WorldTest, ColorOfPointInShadowIsAmbient) { // NOLINT
+    Sphere const front;
+    Sphere const back{{Mat4d::translation(Vector{0., 0., 10.}), Transformation::Kind::Translation}};
+    World const world{{front, back}, {{Point{0., 0., -10.}, Color{1., 1., 1.}}}};
+    Ray const ray{Point{0., 0., 5.}, Vector{0., 0., 1.}};
+
+    EXPECT_EQ(world.color_at(ray), (Color{.1, .1, .1}));
+}
+
+TEST(WorldTest, ColorOfReflectiveSurface) { // NOLINT
+    cherry_blazer::Material floor;
+    floor.reflective = .5;
+    auto const world = default_world_with_floor(floor);
+
+    auto const color = world.color_at(ray_at_floor);
+
+    EXPECT_NEAR(color.r, .87677, 1e-4);
+    EXPECT_NEAR(color.g, .92436, 1e-4);
+    EXPECT_NEAR(color.b, .82918, 1e-4);
+}
+
+TEST(WorldTest, NoReflectionsBeyondMaxDepth) { // NOLINT
+    cherry_blazer::Material floor;
+    floor.reflective = .5;
+    auto world = default_world_with_floor(floor);
+    world.set_trace_limits({0, 0.});
+
+    EXPECT_EQ(world.color_at(ray_at_floor),
+              default_world_with_floor(cherry_blazer::Material{}).color_at(ray_at_floor));
+}
+
+TEST(WorldTest, MirrorsFacingEachOther) { // NOLINT
+    // Mirrors above and below, with the light between them: bounces never run out of surfaces.
+    auto const mirrors = [](double reflective, TraceLimits const& limits) {
+        Shapes shapes;
+        for (auto const y : {-1., 1.}) {
+            Plane mirror{{Mat4d::translation(Vector{0., y, 0.}), Transformation::Kind::Translation},
+                         {}};
+            mirror.material.reflective = reflective;
+            shapes.planes.push_back(mirror);
+        }
+        World world{{}, {{Point{0., 0., 0.}, Color{1., 1., 1.}}}, {}, {}, std::move(shapes)};
+        world.set_trace_limits(limits);
+        return world.color_at(Ray{Point{0., 0., 0.}, Vector{0., 1., 0.}});
+    };
+
+    // perfect mirrors: only the depth stops it, which takes no call stack
+    auto const deep = mirrors(1., {100000, 0.});
+    EXPECT_TRUE(std::isfinite(deep.r));
+    EXPECT_GT(deep.r, mirrors(1., {10, 0.}).r);
+
+    // half mirrors: .5^10 < 1e-3, so the tenth bounce and later are not traced
+    EXPECT_EQ(mirrors(.5, {100000, 1e-3}), mirrors(.5, {9, 0.}));
+}
+
+TEST(WorldTest, ColorOfTransparentSurface) { // NOLINT
+    cherry_blazer::Material floor;
+    floor.transparency = .5;
+    floor.refractive_index = 1.5;
+    auto const world = default_world_with_floor(floor, {ball_under_floor()});
+
+    auto const color = world.color_at(ray_at_floor);
+
+    EXPECT_NEAR(color.r, .93642, 1e-4);
+    EXPECT_NEAR(color.g, .68642, 1e-4);
+    EXPECT_NEAR(color.b, .68642, 1e-4);
+}
+
+TEST(WorldTest, ColorOfReflectiveTransparentSurfaceUsesSchlick) { // NOLINT
+    cherry_blazer::Material floor;
+    floor.reflective = .5;
+    floor.transparency = .5;
+    floor.refractive_index = 1.5;
+    auto const world = default_world_with_floor(floor, {ball_under_floor()});
+
+    auto const color = world.color_at(ray_at_floor);
+
+    EXPECT_NEAR(color.r, .93391, 1e-4);
+    EXPECT_NEAR(color.g, .69643, 1e-4);
+    EXPECT_NEAR(color.b, .69243, 1e-4);
+}
+
+TEST(WorldTest, NoRefractionUnderTotalInternalReflection) { // NOLINT
+    auto glass = default_objects();
+    glass[0].material.transparency = 1.;
+    glass[0].material.refractive_index = 1.5;
+    World const world{glass, {{Point{-10., 10., -10.}, Color{1., 1., 1.}}}};
+    // from inside the outer sphere, at the critical angle's far side
+    Ray const ray{Point{0., 0., std::sqrt(2.) / 2.}, Vector{0., 1., 0.}};
+
+    EXPECT_EQ(world.color_at(ray), default_world().color_at(ray));
+}